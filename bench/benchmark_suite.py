@@ -0,0 +1,272 @@
+"""
+@Function :
+            starlink-sim 端到端规模基准
+            - 为每个规模生成合成 Walker +Grid 拓扑和流量需求
+            - 运行 starlink-sim (load / route / build / simulate / save)，读取 perf_summary.json
+            - 汇总耗时、峰值内存、事件速率，并与 bench/baseline.json 比较
+            - 存在回归、用例失败或缺少基线时返回非零退出码，供 CI 使用
+
+用法:
+    python3 bench/benchmark_suite.py                      # 运行默认用例并与基线比较
+    python3 bench/benchmark_suite.py --cases walker_66    # 只运行指定用例
+    python3 bench/benchmark_suite.py --update-baseline    # 用本次结果覆盖基线
+    python3 bench/benchmark_suite.py --cases walker_4408 walker_12k --ab-args="--setupArena"
+                                                          # 同一用例分别不带/带附加参数运行并对比
+"""
+
+import os
+import sys
+import json
+import time
+import argparse
+import subprocess
+from dataclasses import dataclass, asdict
+from datetime import datetime
+
+BENCH_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.dirname(BENCH_DIR))
+sys.path.insert(0, BENCH_DIR)
+
+from config import NS3Config
+from synthetic_constellation import STANDARD_SHELLS, export_case
+
+
+@dataclass
+class BenchCase:
+    """基准用例"""
+    name: str
+    shell: str
+    num_demands: int
+    pattern: str = "uniform"
+    sim_time_sec: float = 2.0
+
+
+DEFAULT_CASES = [
+    BenchCase("walker_66", "walker_66", 20),
+    BenchCase("walker_720", "walker_720", 100),
+    BenchCase("walker_1584", "walker_1584", 200),
+    BenchCase("walker_4408", "walker_4408", 500),
+    BenchCase("walker_12k", "walker_12k", 1000, sim_time_sec=1.0),
+]
+
+# 参与回归比较的指标: (路径, 方向)；方向 +1 表示越小越好，-1 表示越大越好
+TRACKED_METRICS = [
+    (("total", "wall_s"), +1),
+    (("total", "peak_rss_kb"), +1),
+    (("run", "events_per_sec"), -1),
+]
+
+
+def run_case(case: BenchCase, ns3_root: str, work_dir: str, extra_args: list) -> dict:
+    """生成输入并运行一次 starlink-sim, 返回 perf_summary"""
+    shell = STANDARD_SHELLS[case.shell]
+    case_dir = os.path.join(work_dir, case.name)
+    out_dir = os.path.join(case_dir, "output")
+    os.makedirs(out_dir, exist_ok=True)
+
+    link_file, demand_file = export_case(shell, case_dir, case.num_demands, pattern=case.pattern)
+    perf_file = os.path.join(out_dir, "perf_summary.json")
+    if os.path.exists(perf_file):
+        os.remove(perf_file)
+
+    args = [
+        f"--linkParams={link_file}",
+        f"--demands={demand_file}",
+        f"--output={os.path.join(out_dir, 'flow_results.csv')}",
+        f"--outputDir={out_dir}",
+        f"--perfSummary={perf_file}",
+        f"--simTime={case.sim_time_sec}",
+    ] + extra_args
+
+    log_file = os.path.join(case_dir, "run.log")
+    start = time.time()
+    with open(log_file, 'w') as log:
+        ret = subprocess.call(["./ns3", "run", "--no-build", "scratch/starlink/starlink-sim " + " ".join(args)],
+                              cwd=ns3_root, stdout=log, stderr=subprocess.STDOUT)
+    elapsed = time.time() - start
+
+    if ret != 0 or not os.path.exists(perf_file):
+        print(f"   ❌ {case.name} 运行失败 (查看 {log_file})")
+        return {}
+
+    with open(perf_file, 'r') as f:
+        summary = json.load(f)
+    summary["case"] = asdict(case)
+    summary["num_sats"] = shell.total_sats
+    summary["process_wall_s"] = elapsed
+    return summary
+
+
+def get_metric(summary: dict, path: tuple):
+    value = summary
+    for key in path:
+        if not isinstance(value, dict) or key not in value:
+            return None
+        value = value[key]
+    return value
+
+
+def compare_with_baseline(results: dict, baseline: dict, tolerance: float) -> list:
+    """返回回归列表 [(用例, 指标, 基线值, 当前值)]"""
+    regressions = []
+    for name, summary in results.items():
+        base = baseline.get("cases", {}).get(name)
+        if not base:
+            continue
+        for path, direction in TRACKED_METRICS:
+            cur, ref = get_metric(summary, path), get_metric(base, path)
+            if cur is None or not ref:
+                continue
+            change = (cur - ref) / ref * direction
+            if change > tolerance:
+                regressions.append((name, ".".join(path), ref, cur))
+    return regressions
+
+
+def print_table(results: dict, baseline: dict):
+    print("\n" + "=" * 96)
+    print(f"{'用例':<14}{'卫星':>7}{'需求':>7}{'总耗时(s)':>12}{'基线(s)':>10}{'峰值内存(MB)':>14}"
+          f"{'事件数':>12}{'events/s':>14}")
+    print("-" * 96)
+    for name, s in results.items():
+        base = baseline.get("cases", {}).get(name, {})
+        ref = get_metric(base, ("total", "wall_s"))
+        print(f"{name:<14}{s['num_sats']:>7}{s['case']['num_demands']:>7}"
+              f"{s['total']['wall_s']:>12.3f}{(f'{ref:.3f}' if ref else '-'):>10}"
+              f"{s['total']['peak_rss_kb'] / 1024:>14.1f}{s['run']['events']:>12}"
+              f"{s['run']['events_per_sec']:>14.0f}")
+        for p in s["phases"]:
+            print(f"    {p['name']:<16}{p['wall_s']:>10.3f}s  rss={p['peak_rss_kb'] / 1024:.1f}MB  allocs={p['allocs']}")
+    print("=" * 96)
+
+
+SETUP_PHASES = ["load_links", "load_demands", "build_links", "routing", "install_flows"]
+
+
+def print_ab_table(results: dict, variants: dict, ab_args: str):
+    """对比不带 / 带 --ab-args 的两次运行：安装阶段耗时、分配次数与峰值内存"""
+    print("\n" + "=" * 96)
+    print(f"A/B 对比: A = 默认, B = {ab_args}")
+    print(f"{'用例':<14}{'阶段':<16}{'A 耗时(s)':>12}{'B 耗时(s)':>12}{'变化':>9}"
+          f"{'A 分配':>12}{'B 分配':>12}{'A 峰值MB':>10}{'B 峰值MB':>10}")
+    print("-" * 96)
+    for name, a in results.items():
+        b = variants.get(name)
+        if not b:
+            continue
+        pa = {p["name"]: p for p in a["phases"]}
+        pb = {p["name"]: p for p in b["phases"]}
+        rows = [n for n in SETUP_PHASES if n in pa and n in pb]
+        setup_a = sum(pa[n]["wall_s"] for n in rows)
+        setup_b = sum(pb[n]["wall_s"] for n in rows)
+        for n in rows:
+            wa, wb = pa[n]["wall_s"], pb[n]["wall_s"]
+            change = f"{(wb - wa) / wa:+.0%}" if wa > 0 else "-"
+            print(f"{name:<14}{n:<16}{wa:>12.3f}{wb:>12.3f}{change:>9}"
+                  f"{pa[n]['allocs']:>12}{pb[n]['allocs']:>12}"
+                  f"{pa[n]['peak_rss_kb'] / 1024:>10.1f}{pb[n]['peak_rss_kb'] / 1024:>10.1f}")
+        change = f"{(setup_b - setup_a) / setup_a:+.0%}" if setup_a > 0 else "-"
+        print(f"{name:<14}{'setup 合计':<16}{setup_a:>12.3f}{setup_b:>12.3f}{change:>9}"
+              f"{'':>24}{a['total']['peak_rss_kb'] / 1024:>10.1f}{b['total']['peak_rss_kb'] / 1024:>10.1f}")
+    print("=" * 96)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="starlink-sim 规模基准")
+    parser.add_argument("--cases", nargs="*", help="只运行指定用例")
+    parser.add_argument("--ns3-root", default=NS3Config().ns3_root)
+    parser.add_argument("--work-dir", default=os.path.join(BENCH_DIR, "work"))
+    parser.add_argument("--baseline", default=os.path.join(BENCH_DIR, "baseline.json"))
+    parser.add_argument("--output", help="结果 JSON 路径 (默认 bench/work/bench_<时间>.json)")
+    parser.add_argument("--tolerance", type=float, default=0.15, help="允许的相对退化比例")
+    parser.add_argument("--update-baseline", action="store_true")
+    parser.add_argument("--sim-args", default="", help="附加给 starlink-sim 的参数")
+    parser.add_argument("--ab-args", default="", help="再以这些附加参数运行一次并对比安装阶段")
+    args = parser.parse_args()
+
+    cases = [c for c in DEFAULT_CASES if not args.cases or c.name in args.cases]
+    extra_args = args.sim_args.split() if args.sim_args else []
+
+    # 没有基线时无从比较，门禁不能空过；先于运行用例检查
+    if not args.update_baseline and not os.path.exists(args.baseline):
+        print(f"❌ 没有基线文件: {args.baseline}, 使用 --update-baseline 生成")
+        return 1
+
+    print("=" * 60)
+    print(f"🚀 starlink-sim 规模基准 ({len(cases)} 个用例)")
+    print("=" * 60)
+
+    results = {}
+    failed = []
+    for case in cases:
+        print(f"   ⏳ {case.name} ({STANDARD_SHELLS[case.shell].total_sats} 颗卫星, {case.num_demands} 条需求) ...")
+        summary = run_case(case, args.ns3_root, args.work_dir, extra_args)
+        if summary:
+            results[case.name] = summary
+        else:
+            failed.append(case.name)
+
+    if not results:
+        print("❌ 没有成功的用例")
+        return 1
+
+    baseline = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline, 'r') as f:
+            baseline = json.load(f)
+
+    print_table(results, baseline)
+
+    if args.ab_args:
+        variants = {}
+        ab_extra = extra_args + args.ab_args.split()
+        for case in cases:
+            if case.name not in results:
+                continue
+            print(f"   ⏳ {case.name} (B: {args.ab_args}) ...")
+            summary = run_case(case, args.ns3_root, args.work_dir, ab_extra)
+            if summary:
+                variants[case.name] = summary
+            else:
+                failed.append(f"{case.name} (B)")
+        print_ab_table(results, variants, args.ab_args)
+
+    report = {"date": datetime.now().isoformat(timespec="seconds"), "cases": results, "failed": failed}
+    out_file = args.output or os.path.join(args.work_dir, f"bench_{datetime.now().strftime('%Y%m%d_%H%M%S')}.json")
+    os.makedirs(os.path.dirname(out_file), exist_ok=True)
+    with open(out_file, 'w') as f:
+        json.dump(report, f, indent=2)
+    print(f"💾 已保存: {out_file}")
+
+    # 任一用例失败都使门禁失败，失败的用例不参与基线比较
+    status = 0
+    if failed:
+        print(f"\n❌ {len(failed)} 个用例运行失败: {', '.join(failed)}")
+        status = 1
+
+    if args.update_baseline:
+        merged = baseline.get("cases", {})
+        merged.update(results)
+        with open(args.baseline, 'w') as f:
+            json.dump({"date": report["date"], "cases": merged}, f, indent=2)
+        print(f"💾 已更新基线: {args.baseline}")
+        return status
+
+    uncovered = [name for name in results if name not in baseline.get("cases", {})]
+    if uncovered:
+        print(f"\n❌ 基线中没有这些用例: {', '.join(uncovered)}, 使用 --update-baseline 补充")
+        status = 1
+
+    regressions = compare_with_baseline(results, baseline, args.tolerance)
+    if regressions:
+        print(f"\n❌ 发现 {len(regressions)} 项性能回归 (容差 {args.tolerance:.0%}):")
+        for name, metric, ref, cur in regressions:
+            print(f"   {name:<14} {metric:<22} 基线={ref:.4g}  当前={cur:.4g}")
+        return 1
+
+    print(f"\n✅ 无性能回归 (容差 {args.tolerance:.0%})")
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
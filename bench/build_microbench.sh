@@ -0,0 +1,23 @@
+#!/bin/bash
+# build_microbench.sh - 构建内核微基准和统计工具检查 (不依赖 ns-3)
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+SRC_DIR="$(cd "$SCRIPT_DIR/.." && pwd)"
+CXX="${CXX:-g++}"
+CXXFLAGS="${CXXFLAGS:--O2 -g}"
+
+$CXX -std=c++17 $CXXFLAGS -Wall \
+    "$SCRIPT_DIR/microbench.cc" \
+    "$SRC_DIR/starlink-topology.cc" \
+    "$SRC_DIR/starlink-perf.cc" \
+    "$SRC_DIR/starlink-pool.cc" \
+    -o "$SCRIPT_DIR/microbench"
+
+$CXX -std=c++17 $CXXFLAGS -Wall \
+    "$SCRIPT_DIR/check_stats.cc" \
+    "$SRC_DIR/starlink-convergence.cc" \
+    -o "$SCRIPT_DIR/check_stats"
+
+echo "✅ 已生成: $SCRIPT_DIR/microbench, $SCRIPT_DIR/check_stats"
@@ -0,0 +1,116 @@
+"""
+@Function :
+            需求合并 (--aggregateDemands) 端到端检查
+            - 在 walker_66 上生成成对相同 (源、目的、时间窗) 的需求，使每组至少合并两条
+            - 运行 starlink-sim --aggregateDemands (默认开启 earlyStop)，读取 demand_results.csv 和 flow_results.csv
+            - 链路无误码、负载远低于链路速率，合并组中每条原始需求都应非零发送且全部收到 (Lost = 0)；
+              提前停止过早截断时尾部分组会被算作丢失
+            - 每组各需求的 Tx / Rx 之和必须等于 flow_results 中该组的 TxPackets / RxPackets
+            - 任何一项不满足返回非零退出码
+
+用法:
+    python3 bench/check_aggregation.py [--ns3-root PATH]
+"""
+
+import os
+import sys
+import csv
+import argparse
+import subprocess
+
+BENCH_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.dirname(BENCH_DIR))
+sys.path.insert(0, BENCH_DIR)
+
+from config import NS3Config
+from synthetic_constellation import STANDARD_SHELLS, build_grid_links, generate_demands, write_csv
+
+
+def make_case(work_dir: str, num_pairs: int) -> tuple:
+    """每条基础需求复制一份 (新 demand_id、不同速率)，两者端点与时间窗相同"""
+    shell = STANDARD_SHELLS["walker_66"]
+    link_file = os.path.join(work_dir, "link_params.csv")
+    demand_file = os.path.join(work_dir, "traffic_demands.csv")
+    write_csv(link_file, build_grid_links(shell))
+    demands = []
+    for d in generate_demands(shell, num_pairs, rate_min_mbps=0.5, rate_max_mbps=2.0, seed=7):
+        twin = dict(d)
+        d["demand_id"] = len(demands)
+        demands.append(d)
+        twin["demand_id"] = len(demands)
+        twin["data_rate_mbps"] = round(d["data_rate_mbps"] / 2, 3)
+        demands.append(twin)
+    write_csv(demand_file, demands)
+    return link_file, demand_file
+
+
+def main():
+    parser = argparse.ArgumentParser(description="需求合并端到端检查")
+    parser.add_argument("--ns3-root", default=NS3Config().ns3_root)
+    parser.add_argument("--work-dir", default=os.path.join(BENCH_DIR, "work", "check_aggregation"))
+    parser.add_argument("--pairs", type=int, default=10)
+    args = parser.parse_args()
+
+    out_dir = os.path.join(args.work_dir, "output")
+    os.makedirs(out_dir, exist_ok=True)
+    link_file, demand_file = make_case(args.work_dir, args.pairs)
+    result_file = os.path.join(out_dir, "demand_results.csv")
+    if os.path.exists(result_file):
+        os.remove(result_file)
+
+    sim_args = [
+        f"--linkParams={link_file}",
+        f"--demands={demand_file}",
+        f"--output={os.path.join(out_dir, 'flow_results.csv')}",
+        f"--outputDir={out_dir}",
+        "--simTime=2.0",
+        "--aggregateDemands",
+    ]
+    log_file = os.path.join(args.work_dir, "run.log")
+    with open(log_file, 'w') as log:
+        ret = subprocess.call(["./ns3", "run", "--no-build", "scratch/starlink/starlink-sim " + " ".join(sim_args)],
+                              cwd=args.ns3_root, stdout=log, stderr=subprocess.STDOUT)
+    if ret != 0 or not os.path.exists(result_file):
+        print(f"❌ starlink-sim 运行失败 (查看 {log_file})")
+        return 1
+
+    with open(result_file, newline='') as f:
+        rows = [r for r in csv.DictReader(f) if int(r["GroupSize"]) > 1]
+    if not rows:
+        print("❌ demand_results.csv 中没有合并组")
+        return 1
+
+    failed = [r for r in rows
+              if int(r["TxPackets"]) == 0 or int(r["RxPackets"]) != int(r["TxPackets"]) or int(r["LostPackets"]) != 0]
+    for r in failed:
+        print(f"   ❌ 需求 {r['DemandId']} ({r['SrcNode']} -> {r['DstNode']}): "
+              f"tx={r['TxPackets']} rx={r['RxPackets']} lost={r['LostPackets']}")
+
+    # 子流计数之和与整组的 FlowMonitor 计数一致
+    members = {r["DemandId"]: r for r in rows}
+    with open(os.path.join(out_dir, "flow_results.csv"), newline='') as f:
+        groups = [r for r in csv.DictReader(f) if ";" in r["DemandId"]]
+    mismatched = 0
+    for g in groups:
+        ids = g["DemandId"].split(";")
+        if not all(i in members for i in ids):
+            continue
+        tx = sum(int(members[i]["TxPackets"]) for i in ids)
+        rx = sum(int(members[i]["RxPackets"]) for i in ids)
+        if tx != int(g["TxPackets"]) or rx != int(g["RxPackets"]):
+            mismatched += 1
+            print(f"   ❌ 组 {g['DemandId']}: 子流 tx={tx} rx={rx}，"
+                  f"flow_results tx={g['TxPackets']} rx={g['RxPackets']}")
+    if not groups:
+        print("❌ flow_results.csv 中没有合并组")
+        return 1
+
+    if failed or mismatched:
+        print(f"❌ {len(failed)}/{len(rows)} 条合并需求收发不一致，{mismatched}/{len(groups)} 组与 flow_results 不符")
+        return 1
+    print(f"✅ {len(rows)} 条合并需求全部收到，{len(groups)} 组子流计数与 flow_results 一致")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,59 @@
+// bench/check_stats.cc - 统计工具对照检查
+// StudentTQuantile 与标准 t 分布表 (双侧 80% ~ 99.9%，表值保留三位小数) 逐项比较，
+// 误差超过表的舍入精度即失败；另检查 p < 0.5 时的对称性。
+//
+// 构建: bash bench/build_microbench.sh
+// 运行: ./bench/check_stats     (全部通过返回 0)
+
+#include "../starlink-convergence.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+struct TRow {
+    double df;
+    double t[5];    // p = 0.90, 0.95, 0.975, 0.995, 0.9995
+};
+
+static const double kProbs[5] = {0.90, 0.95, 0.975, 0.995, 0.9995};
+
+static const TRow kTable[] = {
+    {1, {3.078, 6.314, 12.706, 63.657, 636.619}},
+    {2, {1.886, 2.920, 4.303, 9.925, 31.599}},
+    {3, {1.638, 2.353, 3.182, 5.841, 12.924}},
+    {4, {1.533, 2.132, 2.776, 4.604, 8.610}},
+    {5, {1.476, 2.015, 2.571, 4.032, 6.869}},
+    {6, {1.440, 1.943, 2.447, 3.707, 5.959}},
+    {7, {1.415, 1.895, 2.365, 3.499, 5.408}},
+    {8, {1.397, 1.860, 2.306, 3.355, 5.041}},
+    {9, {1.383, 1.833, 2.262, 3.250, 4.781}},
+    {10, {1.372, 1.812, 2.228, 3.169, 4.587}},
+    {15, {1.341, 1.753, 2.131, 2.947, 4.073}},
+    {20, {1.325, 1.725, 2.086, 2.845, 3.850}},
+    {30, {1.310, 1.697, 2.042, 2.750, 3.646}},
+    {60, {1.296, 1.671, 2.000, 2.660, 3.460}},
+    {120, {1.289, 1.658, 1.980, 2.617, 3.373}},
+};
+
+int main() {
+    int failures = 0;
+    std::cout << std::fixed << std::setprecision(4);
+    for (const TRow& row : kTable) {
+        for (int i = 0; i < 5; ++i) {
+            double got = StudentTQuantile(kProbs[i], row.df);
+            double mirror = StudentTQuantile(1 - kProbs[i], row.df);
+            if (std::fabs(got - row.t[i]) > 5e-4 + 1e-9 || std::fabs(got + mirror) > 1e-9 * got) {
+                std::cout << "❌ t(" << kProbs[i] << ", " << row.df << ") = " << got << " (" << mirror
+                          << ")，表值 " << row.t[i] << "\n";
+                failures++;
+            }
+        }
+    }
+    if (failures) {
+        std::cout << "❌ " << failures << " 项与 t 分布表不符\n";
+        return 1;
+    }
+    std::cout << "✅ StudentTQuantile 与 t 分布表一致 (" << sizeof(kTable) / sizeof(kTable[0]) * 5 << " 项)\n";
+    return 0;
+}
@@ -0,0 +1,330 @@
+// bench/microbench.cc - starlink-sim 内核微基准
+// 覆盖 Trim + 字段解析、内存缓冲区上的 LoadLinks、各拓扑规模下的 Dijkstra / GetPath
+// (各自含 setup arena / 临时缓冲版本)，
+// g_linkInterface 形式的 map 查找，以及模拟流量路径的分组分配/释放 (malloc 与分配池对比)。
+// 每个用例先预热并标定迭代次数，再重复测量若干轮，
+// 输出 ns/op 的中位数、均值、标准差，以及 allocs/op 和实际进入 malloc 的 mallocs/op。
+//
+// 构建: bash bench/build_microbench.sh
+// 运行: ./bench/microbench [--filter=dijkstra] [--reps=10] [--minTime=0.2]
+
+#include "../starlink-perf.h"
+#include "../starlink-pool.h"
+#include "../starlink-topology.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ==================== 测量框架 ====================
+
+struct Benchmark {
+    std::string name;
+    std::function<void()> setup;          // 不计时的准备工作，可为空
+    std::function<void(uint64_t)> body;   // 执行 n 次操作
+    std::function<void()> teardown;       // 测量结束后的清理，可为空
+};
+
+struct BenchResult {
+    std::string name;
+    uint64_t itersPerRep = 0;
+    double nsMedian = 0, nsMean = 0, nsStddev = 0, nsMin = 0;
+    double allocsPerOp = 0;
+    double mallocsPerOp = 0;
+};
+
+// 防止编译器把结果优化掉
+static volatile uint64_t g_sink = 0;
+
+static BenchResult RunBenchmark(const Benchmark& b, int reps, double minTimeSec) {
+    BenchResult r;
+    r.name = b.name;
+    if (b.setup) b.setup();
+
+    // 预热并标定：迭代次数翻倍直到单轮耗时超过 minTimeSec
+    uint64_t iters = 1;
+    while (true) {
+        ResourceSnapshot t0 = TakeSnapshot();
+        b.body(iters);
+        double dt = TakeSnapshot().wallSec - t0.wallSec;
+        if (dt >= minTimeSec || iters >= (1ull << 40)) break;
+        iters = (dt > 0) ? std::max<uint64_t>(iters * 2, static_cast<uint64_t>(iters * minTimeSec / dt * 1.2)) : iters * 2;
+    }
+    r.itersPerRep = iters;
+
+    std::vector<double> ns;
+    uint64_t allocs = 0, mallocs = 0;
+    for (int i = 0; i < reps; ++i) {
+        ResourceSnapshot t0 = TakeSnapshot();
+        b.body(iters);
+        ResourceSnapshot t1 = TakeSnapshot();
+        ns.push_back((t1.wallSec - t0.wallSec) * 1e9 / iters);
+        allocs += t1.allocs - t0.allocs;
+        mallocs += t1.mallocs - t0.mallocs;
+    }
+    if (b.teardown) b.teardown();
+
+    std::sort(ns.begin(), ns.end());
+    r.nsMin = ns.front();
+    r.nsMedian = (ns.size() % 2) ? ns[ns.size() / 2] : (ns[ns.size() / 2 - 1] + ns[ns.size() / 2]) / 2;
+    double sum = 0;
+    for (double v : ns) sum += v;
+    r.nsMean = sum / ns.size();
+    double var = 0;
+    for (double v : ns) var += (v - r.nsMean) * (v - r.nsMean);
+    r.nsStddev = ns.size() > 1 ? std::sqrt(var / (ns.size() - 1)) : 0;
+    r.allocsPerOp = (double)allocs / ((double)iters * reps);
+    r.mallocsPerOp = (double)mallocs / ((double)iters * reps);
+    return r;
+}
+
+// ==================== 合成拓扑 ====================
+
+struct GridSize {
+    const char* label;
+    uint32_t planes;
+    uint32_t satsPerPlane;
+};
+
+static const GridSize kSizes[] = {
+    {"66", 6, 11},
+    {"1584", 72, 22},
+    {"4408", 76, 58},
+    {"12k", 120, 100},
+};
+
+// 生成与 link_params_slice_*.csv 同格式的 +Grid 拓扑 CSV 文本
+static std::string MakeGridCsv(const GridSize& g) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> delay(1.0, 14.0);
+    std::ostringstream os;
+    os << "src_id,dst_id,src_name,dst_name,delay_ms,data_rate_bps,packet_loss_rate,ber,distance_km,timestamp\n";
+    auto emit = [&](uint32_t p1, uint32_t s1, uint32_t p2, uint32_t s2) {
+        double d = delay(rng);
+        os << p1 * g.satsPerPlane + s1 << "," << p2 * g.satsPerPlane + s2 << ","
+           << "Sat_" << p1 << "_" << s1 << "," << "Sat_" << p2 << "_" << s2 << ","
+           << std::fixed << std::setprecision(4) << d << ",50000000,0.0001,1e-07,"
+           << std::setprecision(2) << d * 299.792 << ",2025-11-22 04:00:00\n";
+    };
+    for (uint32_t p = 0; p < g.planes; ++p) {
+        for (uint32_t s = 0; s < g.satsPerPlane; ++s) {
+            emit(p, s, p, (s + 1) % g.satsPerPlane);
+            if (p + 1 < g.planes) emit(p, s, p + 1, s);
+        }
+    }
+    return os.str();
+}
+
+static void LoadGrid(const GridSize& g) {
+    ResetTopology();
+    std::istringstream in(MakeGridCsv(g));
+    LoadLinks(in);
+}
+
+// ==================== 分组分配模拟 ====================
+
+// 与流量路径上一个分组的分配模式相近：Packet 对象、Buffer 数据区、
+// 标签存储和一个调度事件，在队列中停留 depth 个分组后释放
+struct FakePacket {
+    uint8_t* data;
+    uint64_t* tag;
+    std::function<void()>* event;
+    uint64_t meta[12];
+};
+
+static void PacketChurn(uint64_t n, std::vector<FakePacket*>& ring, uint64_t& head) {
+    for (uint64_t i = 0; i < n; ++i) {
+        FakePacket*& slot = ring[head++ % ring.size()];
+        if (slot) {
+            g_sink += slot->data[0] + *slot->tag;
+            delete[] slot->data;
+            delete slot->tag;
+            delete slot->event;
+            delete slot;
+        }
+        slot = new FakePacket();
+        slot->data = new uint8_t[1100];
+        slot->data[0] = static_cast<uint8_t>(i);
+        slot->tag = new uint64_t(i);
+        slot->event = new std::function<void()>([i] { g_sink += i; });
+    }
+}
+
+static void ReleaseRing(std::vector<FakePacket*>& ring) {
+    for (FakePacket*& p : ring) {
+        if (!p) continue;
+        delete[] p->data;
+        delete p->tag;
+        delete p->event;
+        delete p;
+        p = nullptr;
+    }
+}
+
+// ==================== 用例 ====================
+
+static std::vector<Benchmark> BuildBenchmarks() {
+    std::vector<Benchmark> benches;
+
+    // Trim + 字段解析：LoadLinks 中每一行的处理
+    benches.push_back({"trim_parse_line", nullptr, [](uint64_t n) {
+        const std::string line = " 1283, 1284 ,Sat_58_11,Sat_58_12, 3.4521 ,50000000,0.0001,1e-07,1034.92,2025-11-22 04:00:00\r";
+        for (uint64_t i = 0; i < n; ++i) {
+            std::stringstream ss(line); std::string tok;
+            std::getline(ss, tok, ','); uint64_t a = std::stoul(Trim(tok));
+            std::getline(ss, tok, ','); uint64_t b = std::stoul(Trim(tok));
+            std::getline(ss, tok, ','); std::string sn = Trim(tok);
+            std::getline(ss, tok, ','); std::string dn = Trim(tok);
+            std::getline(ss, tok, ','); double d = std::stod(Trim(tok));
+            std::getline(ss, tok, ','); uint64_t r = std::stoull(Trim(tok));
+            g_sink += a + b + sn.size() + dn.size() + static_cast<uint64_t>(d) + r;
+        }
+    }});
+
+    for (const GridSize& g : kSizes) {
+        std::string label = g.label;
+        auto csv = std::make_shared<std::string>(MakeGridCsv(g));
+
+        benches.push_back({"load_links/" + label, nullptr, [csv](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                ResetTopology();
+                std::istringstream in(*csv);
+                LoadLinks(in);
+                g_sink += g_links.size();
+            }
+        }});
+
+        // 同样的加载在 setup arena 中进行，每轮整片释放
+        benches.push_back({"load_links_arena/" + label, [] {
+            ResetTopology();
+            EnableSetupArena();
+        }, [csv](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                ResetTopology();
+                ReleaseSetupArena();
+                std::istringstream in(*csv);
+                LoadLinks(in);
+                g_sink += g_links.size();
+            }
+        }, [] {
+            ResetTopology();
+            DisableSetupArena();
+        }});
+
+        benches.push_back({"dijkstra/" + label, [g] { LoadGrid(g); }, [](uint64_t n) {
+            std::mt19937 rng(7);
+            for (uint64_t i = 0; i < n; ++i) {
+                DijkstraResult r = Dijkstra(rng() % g_numNodes, g_numNodes);
+                g_sink += r.prev.size();
+            }
+        }});
+
+        // 与 starlink-sim 路由阶段相同：每条需求计算完路径后复用同一块临时缓冲
+        benches.push_back({"dijkstra_scratch/" + label, [g] { LoadGrid(g); }, [](uint64_t n) {
+            std::mt19937 rng(7);
+            ScratchArena scratch(g_numNodes * 128);
+            for (uint64_t i = 0; i < n; ++i) {
+                DijkstraResult r = Dijkstra(rng() % g_numNodes, g_numNodes, scratch.Resource());
+                auto path = GetPath(0, rng() % g_numNodes, r, scratch.Resource());
+                g_sink += r.prev.size() + path.size();
+                scratch.Reset();
+            }
+        }});
+
+        auto tree = std::make_shared<DijkstraResult>();
+        benches.push_back({"get_path/" + label, [g, tree] {
+            LoadGrid(g);
+            *tree = Dijkstra(0, g_numNodes);
+        }, [tree](uint64_t n) {
+            std::mt19937 rng(7);
+            for (uint64_t i = 0; i < n; ++i) {
+                auto path = GetPath(0, rng() % g_numNodes, *tree);
+                g_sink += path.size();
+            }
+        }});
+
+        // 与 g_linkInterface 相同的键值布局，Ipv4Address 用 uint32_t 代替
+        using LinkInterfaceMap = std::map<std::pair<uint32_t, uint32_t>, std::pair<uint32_t, uint32_t>>;
+        auto linkInterface = std::make_shared<LinkInterfaceMap>();
+        benches.push_back({"link_interface_lookup/" + label, [g, linkInterface] {
+            LoadGrid(g);
+            linkInterface->clear();
+            for (size_t i = 0; i < g_links.size(); ++i) {
+                (*linkInterface)[{g_links[i].srcId, g_links[i].dstId}] = {1, static_cast<uint32_t>(i * 4 + 2)};
+                (*linkInterface)[{g_links[i].dstId, g_links[i].srcId}] = {1, static_cast<uint32_t>(i * 4 + 1)};
+            }
+        }, [linkInterface](uint64_t n) {
+            std::mt19937 rng(7);
+            for (uint64_t i = 0; i < n; ++i) {
+                const LinkParam& l = g_links[rng() % g_links.size()];
+                auto it = linkInterface->find({l.dstId, l.srcId});
+                g_sink += it->second.second;
+            }
+        }});
+    }
+
+    // 分组分配：相同负载分别走 malloc 和分配池
+    for (uint32_t depth : {64u, 4096u}) {
+        for (bool pool : {false, true}) {
+            auto ring = std::make_shared<std::vector<FakePacket*>>(depth, nullptr);
+            auto head = std::make_shared<uint64_t>(0);
+            std::string name = "packet_churn/" + std::to_string(depth) + (pool ? "/pool" : "/malloc");
+            benches.push_back({name, [pool] {
+                if (pool && !EnableAllocPool()) std::cerr << "allocation pool unavailable\n";
+            }, [ring, head](uint64_t n) {
+                PacketChurn(n, *ring, *head);
+            }, [ring, pool] {
+                ReleaseRing(*ring);
+                if (pool) DisableAllocPool();
+            }});
+        }
+    }
+    return benches;
+}
+
+// ==================== 主函数 ====================
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    int reps = 10;
+    double minTime = 0.2;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--filter=", 0) == 0) filter = arg.substr(9);
+        else if (arg.rfind("--reps=", 0) == 0) reps = std::max(1, std::atoi(arg.c_str() + 7));
+        else if (arg.rfind("--minTime=", 0) == 0) minTime = std::atof(arg.c_str() + 10);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter=substr] [--reps=N] [--minTime=sec]\n";
+            return 1;
+        }
+    }
+
+    std::cout << std::left << std::setw(30) << "benchmark" << std::right
+              << std::setw(12) << "iters" << std::setw(14) << "median ns/op"
+              << std::setw(14) << "mean ns/op" << std::setw(12) << "stddev"
+              << std::setw(14) << "min ns/op" << std::setw(12) << "allocs/op"
+              << std::setw(12) << "mallocs/op" << "\n";
+
+    for (const Benchmark& b : BuildBenchmarks()) {
+        if (!filter.empty() && b.name.find(filter) == std::string::npos) continue;
+        BenchResult r = RunBenchmark(b, reps, minTime);
+        std::cout << std::left << std::setw(30) << r.name << std::right
+                  << std::setw(12) << r.itersPerRep
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(14) << r.nsMedian << std::setw(14) << r.nsMean
+                  << std::setw(12) << r.nsStddev << std::setw(14) << r.nsMin
+                  << std::setprecision(2) << std::setw(12) << r.allocsPerOp
+                  << std::setw(12) << r.mallocsPerOp << "\n";
+    }
+    if (IsAllocPoolEnabled() || GetPoolStats().allocs) PrintPoolStats(std::cout, GetPoolStats());
+    return 0;
+}
@@ -0,0 +1,144 @@
+"""
+@Function :
+            事件调度器对比基准
+            - 对每个规模用例，先用 ns3::TracingScheduler 运行一次 starlink-sim，记录调度器操作轨迹
+            - 用 --schedulerBench 把同一轨迹回放到 Map / Heap / Calendar / Ladder 调度器，得到每次操作的平均耗时
+            - 再分别以 --scheduler=<类型> 完整运行仿真，比较 run 阶段的 events/s
+            - 回放只计调度器本身的开销，完整运行反映缓存与事件执行的综合影响
+
+用法:
+    python3 bench/scheduler_benchmark.py                          # 默认用例
+    python3 bench/scheduler_benchmark.py --cases walker_1584 walker_4408
+    python3 bench/scheduler_benchmark.py --schedulers ns3::MapScheduler ns3::LadderScheduler
+"""
+
+import os
+import sys
+import json
+import argparse
+import subprocess
+from datetime import datetime
+
+BENCH_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.dirname(BENCH_DIR))
+sys.path.insert(0, BENCH_DIR)
+
+from config import NS3Config
+from benchmark_suite import DEFAULT_CASES, run_case, get_metric
+
+DEFAULT_SCHEDULERS = [
+    "ns3::MapScheduler",
+    "ns3::HeapScheduler",
+    "ns3::CalendarScheduler",
+    "ns3::LadderScheduler",
+]
+
+
+def replay_trace(trace_file: str, out_dir: str, schedulers: list, ns3_root: str) -> list:
+    """回放调度器轨迹, 返回 scheduler_bench.json 的内容"""
+    result_file = os.path.join(out_dir, "scheduler_bench.json")
+    if os.path.exists(result_file):
+        os.remove(result_file)
+    args = [
+        f"--schedulerBench={trace_file}",
+        f"--schedulerBenchTypes={','.join(schedulers)}",
+        f"--outputDir={out_dir}",
+    ]
+    log_file = os.path.join(out_dir, "scheduler_replay.log")
+    with open(log_file, 'w') as log:
+        ret = subprocess.call(["./ns3", "run", "--no-build", "scratch/starlink/starlink-sim " + " ".join(args)],
+                              cwd=ns3_root, stdout=log, stderr=subprocess.STDOUT)
+    if ret != 0 or not os.path.exists(result_file):
+        print(f"   ❌ 轨迹回放失败 (查看 {log_file})")
+        return []
+    with open(result_file, 'r') as f:
+        return json.load(f)
+
+
+def bench_case(case, schedulers: list, ns3_root: str, work_dir: str, keep_trace: bool) -> dict:
+    case_dir = os.path.join(work_dir, case.name)
+    trace_file = os.path.join(case_dir, "scheduler.trace")
+
+    print(f"   ⏳ {case.name}: 记录调度器轨迹 ...")
+    if not run_case(case, ns3_root, work_dir, [f"--schedulerTrace={trace_file}"]):
+        return {}
+    trace_mb = os.path.getsize(trace_file) / 1e6 if os.path.exists(trace_file) else 0
+    print(f"      轨迹大小 {trace_mb:.1f} MB")
+
+    print(f"   ⏳ {case.name}: 回放轨迹 ...")
+    replay = replay_trace(trace_file, os.path.join(case_dir, "output"), schedulers, ns3_root)
+    if not keep_trace and os.path.exists(trace_file):
+        os.remove(trace_file)
+
+    full = {}
+    for sched in schedulers:
+        print(f"   ⏳ {case.name}: 完整运行 {sched} ...")
+        summary = run_case(case, ns3_root, work_dir, [f"--scheduler={sched}"])
+        if summary:
+            run_wall = next((p["wall_s"] for p in summary["phases"] if p["name"] == "run"), None)
+            full[sched] = {
+                "run_wall_s": run_wall,
+                "events": get_metric(summary, ("run", "events")),
+                "events_per_sec": get_metric(summary, ("run", "events_per_sec")),
+                "peak_rss_kb": get_metric(summary, ("total", "peak_rss_kb")),
+            }
+    return {"replay": replay, "full_run": full}
+
+
+def print_case(name: str, result: dict):
+    print("\n" + "=" * 84)
+    print(f"📊 {name}")
+    print(f"{'调度器':<26}{'回放 ns/op':>12}{'最大待处理':>12}{'run(s)':>10}{'events/s':>14}{'峰值内存(MB)':>14}")
+    print("-" * 84)
+    replay = {r["scheduler"]: r for r in result["replay"]}
+    for sched in sorted(set(replay) | set(result["full_run"])):
+        r = replay.get(sched, {})
+        f = result["full_run"].get(sched, {})
+        ns_op = f"{r['ns_per_op']:.1f}" if r else "-"
+        pending = str(r["max_pending"]) if r else "-"
+        run_wall = f"{f['run_wall_s']:.3f}" if f.get("run_wall_s") is not None else "-"
+        eps = f"{f['events_per_sec']:.0f}" if f.get("events_per_sec") else "-"
+        rss = f"{f['peak_rss_kb'] / 1024:.1f}" if f.get("peak_rss_kb") else "-"
+        print(f"{sched:<26}{ns_op:>12}{pending:>12}{run_wall:>10}{eps:>14}{rss:>14}")
+    print("=" * 84)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="事件调度器对比基准")
+    parser.add_argument("--cases", nargs="*", default=["walker_720", "walker_1584", "walker_4408"])
+    parser.add_argument("--schedulers", nargs="*", default=DEFAULT_SCHEDULERS)
+    parser.add_argument("--ns3-root", default=NS3Config().ns3_root)
+    parser.add_argument("--work-dir", default=os.path.join(BENCH_DIR, "work", "scheduler"))
+    parser.add_argument("--keep-trace", action="store_true", help="保留二进制轨迹文件")
+    args = parser.parse_args()
+
+    cases = [c for c in DEFAULT_CASES if c.name in args.cases]
+    if not cases:
+        print("❌ 没有匹配的用例")
+        return 1
+
+    print("=" * 60)
+    print(f"🚀 调度器对比基准 ({len(cases)} 个用例, {len(args.schedulers)} 种调度器)")
+    print("=" * 60)
+
+    results = {}
+    for case in cases:
+        result = bench_case(case, args.schedulers, args.ns3_root, args.work_dir, args.keep_trace)
+        if result:
+            results[case.name] = result
+            print_case(case.name, result)
+
+    if not results:
+        print("❌ 没有成功的用例")
+        return 1
+
+    out_file = os.path.join(args.work_dir, f"scheduler_{datetime.now().strftime('%Y%m%d_%H%M%S')}.json")
+    os.makedirs(args.work_dir, exist_ok=True)
+    with open(out_file, 'w') as f:
+        json.dump({"date": datetime.now().isoformat(timespec="seconds"), "cases": results}, f, indent=2)
+    print(f"💾 已保存: {out_file}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
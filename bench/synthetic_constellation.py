@@ -0,0 +1,177 @@
+"""
+@Function :
+            合成星座拓扑生成器
+            - 按 Walker Delta/Star 参数生成 +Grid 星间链路拓扑 (轨道内环 + 相邻轨道同编号)
+            - 由卫星几何位置计算链路距离和传播时延
+            - 按指定模式生成流量需求 (uniform / hotspot / neighbor)
+            - 输出格式与 TimeSliceManager.export_for_ns3 一致，可直接作为 starlink-sim 输入
+"""
+
+import os
+import csv
+import math
+import random
+import argparse
+from dataclasses import dataclass
+from typing import List, Tuple
+
+LIGHT_SPEED_KM_S = 299792.458
+EARTH_RADIUS_KM = 6371.0
+
+
+@dataclass
+class WalkerShell:
+    """Walker 星座参数"""
+    name: str
+    planes: int
+    sats_per_plane: int
+    altitude_km: float = 550.0
+    inclination_deg: float = 53.0
+    phasing_factor: int = 1
+    pattern: str = "delta"          # delta: RAAN 覆盖 360°; star: 覆盖 180° (极轨)
+    data_rate_bps: int = 50_000_000
+    packet_loss_rate: float = 0.0
+
+    @property
+    def total_sats(self) -> int:
+        return self.planes * self.sats_per_plane
+
+
+# 基准测试使用的标准规模 (卫星总数 66 / 720 / 1584 / 4408 / 12000)
+STANDARD_SHELLS = {
+    "walker_66": WalkerShell("walker_66", 6, 11, altitude_km=780.0, inclination_deg=86.4, pattern="star"),
+    "walker_720": WalkerShell("walker_720", 36, 20),
+    "walker_1584": WalkerShell("walker_1584", 72, 22),
+    "walker_4408": WalkerShell("walker_4408", 76, 58),
+    "walker_12k": WalkerShell("walker_12k", 120, 100),
+}
+
+
+def sat_name(plane: int, index: int) -> str:
+    return f"Sat_{plane}_{index}"
+
+
+def sat_position(shell: WalkerShell, plane: int, index: int) -> Tuple[float, float, float]:
+    """t=0 时刻卫星在 ECI 坐标系下的位置 (km)"""
+    r = EARTH_RADIUS_KM + shell.altitude_km
+    raan_span = 360.0 if shell.pattern == "delta" else 180.0
+    raan = math.radians(raan_span * plane / shell.planes)
+    u = math.radians(360.0 * index / shell.sats_per_plane
+                     + 360.0 * shell.phasing_factor * plane / shell.total_sats)
+    inc = math.radians(shell.inclination_deg)
+    x = r * (math.cos(raan) * math.cos(u) - math.sin(raan) * math.sin(u) * math.cos(inc))
+    y = r * (math.sin(raan) * math.cos(u) + math.cos(raan) * math.sin(u) * math.cos(inc))
+    z = r * math.sin(u) * math.sin(inc)
+    return x, y, z
+
+
+def build_grid_links(shell: WalkerShell) -> List[dict]:
+    """生成 +Grid 链路: 轨道内前后相邻 + 相邻轨道同编号"""
+    pos = {}
+    for p in range(shell.planes):
+        for s in range(shell.sats_per_plane):
+            pos[(p, s)] = sat_position(shell, p, s)
+
+    def node_id(p, s):
+        return p * shell.sats_per_plane + s
+
+    pairs = []
+    for p in range(shell.planes):
+        for s in range(shell.sats_per_plane):
+            pairs.append(((p, s), (p, (s + 1) % shell.sats_per_plane)))
+            # Star 星座在反向缝处不建立轨道间链路
+            if p + 1 < shell.planes or shell.pattern == "delta":
+                pairs.append(((p, s), ((p + 1) % shell.planes, s)))
+
+    links = []
+    for a, b in pairs:
+        dist = math.dist(pos[a], pos[b])
+        links.append({
+            "src_id": node_id(*a),
+            "dst_id": node_id(*b),
+            "src_name": sat_name(*a),
+            "dst_name": sat_name(*b),
+            "delay_ms": round(dist / LIGHT_SPEED_KM_S * 1000.0, 4),
+            "data_rate_bps": shell.data_rate_bps,
+            "packet_loss_rate": shell.packet_loss_rate,
+            "ber": 0.0,
+            "distance_km": round(dist, 2),
+            "timestamp": "synthetic",
+        })
+    return links
+
+
+def generate_demands(shell: WalkerShell, num_demands: int, pattern: str = "uniform",
+                     rate_min_mbps: float = 1.0, rate_max_mbps: float = 5.0,
+                     start_time_sec: float = 0.5, duration_sec: float = 1.0,
+                     num_hotspots: int = 4, hotspot_fraction: float = 0.5,
+                     seed: int = 42) -> List[dict]:
+    """
+    生成流量需求
+
+    Args:
+        pattern: uniform  - 任意两颗卫星之间
+                 hotspot  - hotspot_fraction 比例的需求以少数热点卫星为目的
+                 neighbor - 目的卫星位于同轨道或相邻轨道
+    """
+    rng = random.Random(seed)
+    n = shell.total_sats
+    hotspots = rng.sample(range(n), min(num_hotspots, n))
+
+    demands = []
+    for i in range(num_demands):
+        src = rng.randrange(n)
+        if pattern == "hotspot" and rng.random() < hotspot_fraction:
+            dst = rng.choice(hotspots)
+        elif pattern == "neighbor":
+            p, s = divmod(src, shell.sats_per_plane)
+            dp = (p + rng.choice([-1, 0, 1])) % shell.planes
+            dst = dp * shell.sats_per_plane + rng.randrange(shell.sats_per_plane)
+        else:
+            dst = rng.randrange(n)
+        if dst == src:
+            dst = (src + 1) % n
+
+        demands.append({
+            "demand_id": i,
+            "src_node": sat_name(*divmod(src, shell.sats_per_plane)),
+            "dst_node": sat_name(*divmod(dst, shell.sats_per_plane)),
+            "src_id": src,
+            "dst_id": dst,
+            "data_rate_mbps": round(rng.uniform(rate_min_mbps, rate_max_mbps), 3),
+            "start_time_sec": start_time_sec,
+            "duration_sec": duration_sec,
+        })
+    return demands
+
+
+def write_csv(path: str, rows: List[dict]):
+    os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+    with open(path, 'w', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=list(rows[0].keys()))
+        writer.writeheader()
+        writer.writerows(rows)
+
+
+def export_case(shell: WalkerShell, out_dir: str, num_demands: int, **demand_kwargs) -> Tuple[str, str]:
+    """生成一个基准用例, 返回 (link_params 路径, traffic_demands 路径)"""
+    link_file = os.path.join(out_dir, "link_params.csv")
+    demand_file = os.path.join(out_dir, "traffic_demands.csv")
+    write_csv(link_file, build_grid_links(shell))
+    write_csv(demand_file, generate_demands(shell, num_demands, **demand_kwargs))
+    return link_file, demand_file
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="合成 Walker +Grid 星座拓扑")
+    parser.add_argument("--shell", choices=list(STANDARD_SHELLS.keys()), default="walker_66")
+    parser.add_argument("--num-demands", type=int, default=20)
+    parser.add_argument("--pattern", choices=["uniform", "hotspot", "neighbor"], default="uniform")
+    parser.add_argument("--out-dir", default="bench/work")
+    parser.add_argument("--seed", type=int, default=42)
+    args = parser.parse_args()
+
+    shell = STANDARD_SHELLS[args.shell]
+    out_dir = os.path.join(args.out_dir, shell.name)
+    links, demands = export_case(shell, out_dir, args.num_demands, pattern=args.pattern, seed=args.seed)
+    print(f"✅ {shell.name}: {shell.total_sats} 颗卫星 -> {links}, {demands}")
@@ -0,0 +1,44 @@
+#include "hop-trace-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(HopTraceTag);
+
+TypeId HopTraceTag::GetTypeId() {
+    static TypeId tid = TypeId("ns3::HopTraceTag")
+        .SetParent<Tag>()
+        .SetGroupName("Network")
+        .AddConstructor<HopTraceTag>();
+    return tid;
+}
+
+TypeId HopTraceTag::GetInstanceTypeId() const {
+    return GetTypeId();
+}
+
+HopTraceTag::HopTraceTag() : m_direction(0), m_enqueueNs(0), m_waitNs(0) {}
+
+HopTraceTag::HopTraceTag(uint32_t direction, int64_t enqueueNs, uint32_t waitNs)
+    : m_direction(direction), m_enqueueNs(enqueueNs), m_waitNs(waitNs) {}
+
+uint32_t HopTraceTag::GetSerializedSize() const {
+    return 4 + 8 + 4;
+}
+
+void HopTraceTag::Serialize(TagBuffer buf) const {
+    buf.WriteU32(m_direction);
+    buf.WriteU64(static_cast<uint64_t>(m_enqueueNs));
+    buf.WriteU32(m_waitNs);
+}
+
+void HopTraceTag::Deserialize(TagBuffer buf) {
+    m_direction = buf.ReadU32();
+    m_enqueueNs = static_cast<int64_t>(buf.ReadU64());
+    m_waitNs = buf.ReadU32();
+}
+
+void HopTraceTag::Print(std::ostream& os) const {
+    os << "dir=" << m_direction << " enqueue=" << m_enqueueNs << "ns wait=" << m_waitNs << "ns";
+}
+
+} // namespace ns3
@@ -0,0 +1,41 @@
+#ifndef HOP_TRACE_TAG_H
+#define HOP_TRACE_TAG_H
+
+// hop-trace-tag.h - 抽样分组的逐跳时间戳
+// --hopSample N 时，uid 为 N 的倍数的分组在每个设备开始发送 (PhyTxBegin) 时追加一个
+// 字节标记：链路方向、进入设备的时刻 (MacTx) 与排队等待时长。字节标记随分组跨跳保留，
+// 接收端据此把端到端时延分解为各跳的排队、串行化和传播时延 (见 starlink-hoplatency.h)。
+
+#include "ns3/nstime.h"
+#include "ns3/tag.h"
+
+#include <cstdint>
+
+namespace ns3 {
+
+class HopTraceTag : public Tag {
+public:
+    static TypeId GetTypeId();
+    TypeId GetInstanceTypeId() const override;
+
+    HopTraceTag();
+    HopTraceTag(uint32_t direction, int64_t enqueueNs, uint32_t waitNs);
+
+    uint32_t GetSerializedSize() const override;
+    void Serialize(TagBuffer buf) const override;
+    void Deserialize(TagBuffer buf) override;
+    void Print(std::ostream& os) const override;
+
+    uint32_t GetDirection() const { return m_direction; }
+    int64_t GetEnqueueNs() const { return m_enqueueNs; }
+    uint32_t GetWaitNs() const { return m_waitNs; }
+
+private:
+    uint32_t m_direction;
+    int64_t m_enqueueNs;
+    uint32_t m_waitNs;
+};
+
+} // namespace ns3
+
+#endif // HOP_TRACE_TAG_H
@@ -0,0 +1,267 @@
+#include "ladder-scheduler.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(LadderScheduler);
+
+// 单个 rung 的最大桶数，避免 Top 中事件极多时一次性分配过多空桶
+static const uint64_t kMaxBuckets = 1 << 20;
+
+static bool KeyLess(const Scheduler::Event& a, const Scheduler::Event& b) {
+    return a.key < b.key;
+}
+
+TypeId LadderScheduler::GetTypeId() {
+    static TypeId tid = TypeId("ns3::LadderScheduler")
+        .SetParent<Scheduler>()
+        .SetGroupName("Core")
+        .AddConstructor<LadderScheduler>()
+        .AddAttribute("BucketThreshold",
+                      "Bucket or Bottom size above which a new rung is spawned instead of sorting into Bottom",
+                      UintegerValue(50),
+                      MakeUintegerAccessor(&LadderScheduler::m_threshold),
+                      MakeUintegerChecker<uint32_t>(1))
+        .AddAttribute("MaxRungs",
+                      "Maximum number of ladder rungs",
+                      UintegerValue(8),
+                      MakeUintegerAccessor(&LadderScheduler::m_maxRungs),
+                      MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+LadderScheduler::LadderScheduler()
+    : m_topMin(std::numeric_limits<uint64_t>::max()),
+      m_topMax(0),
+      m_topStart(0),
+      m_nRungs(0),
+      m_size(0),
+      m_threshold(50),
+      m_maxRungs(8) {
+    NS_LOG_FUNCTION(this);
+}
+
+LadderScheduler::~LadderScheduler() {
+    NS_LOG_FUNCTION(this);
+}
+
+// ==================== 插入 ====================
+
+void LadderScheduler::Insert(const Event& ev) {
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    uint64_t ts = ev.key.m_ts;
+    m_size++;
+
+    if (ts >= m_topStart) {
+        m_top.push_back(ev);
+        m_topMin = std::min(m_topMin, ts);
+        m_topMax = std::max(m_topMax, ts);
+        return;
+    }
+
+    int r = FindRung(ts);
+    if (r >= 0) {
+        Rung& rung = m_rungs[r];
+        rung.buckets[BucketIndex(rung, ts)].push_back(ev);
+        rung.count++;
+        return;
+    }
+
+    InsertBottom(ev);
+}
+
+// rung 由粗到细排列，下级 rung 覆盖上级当前桶之前的时间段
+int LadderScheduler::FindRung(uint64_t ts) const {
+    for (uint32_t i = 0; i < m_nRungs; ++i) {
+        if (ts >= m_rungs[i].CurrentStart()) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// 超出末桶范围的时间戳归入末桶 (末桶总是该 rung 最后被取出的桶)
+uint32_t LadderScheduler::BucketIndex(const Rung& rung, uint64_t ts) const {
+    uint64_t idx = (ts - rung.start) / rung.bucketWidth;
+    uint64_t last = rung.buckets.size() - 1;
+    return static_cast<uint32_t>(std::min(idx, last));
+}
+
+void LadderScheduler::InsertBottom(const Event& ev) {
+    auto it = std::upper_bound(m_bottom.begin(), m_bottom.end(), ev, KeyLess);
+    m_bottom.insert(it, ev);
+    // 最早时间戳上的事件超过阈值时不转：它们无法分桶，取回 Bottom 后会立刻再次超过阈值
+    if (m_bottom.size() > m_threshold && m_nRungs < m_maxRungs &&
+        m_bottom[m_threshold].key.m_ts > m_bottom.front().key.m_ts) {
+        SpillBottom();
+    }
+}
+
+// Bottom 中的时间戳都早于最细一级 rung 的当前桶，新 rung 接在它下面，FindRung 的顺序不变
+void LadderScheduler::SpillBottom() {
+    NS_LOG_FUNCTION(this << m_bottom.size());
+    uint64_t lo = m_bottom.front().key.m_ts;
+    uint64_t span = m_bottom.back().key.m_ts - lo;
+    uint64_t n = std::min<uint64_t>(m_bottom.size(), kMaxBuckets);
+    uint64_t width = span / n + 1;
+    Rung& rung = PushRung(lo, width, static_cast<uint32_t>(span / width + 1));
+    for (const Event& ev : m_bottom) {
+        rung.buckets[BucketIndex(rung, ev.key.m_ts)].push_back(ev);
+    }
+    rung.count = m_bottom.size();
+    m_bottom.clear();
+}
+
+LadderScheduler::Rung& LadderScheduler::PushRung(uint64_t start, uint64_t width, uint32_t nBuckets) {
+    if (m_nRungs == m_rungs.size()) m_rungs.emplace_back();
+    Rung& rung = m_rungs[m_nRungs++];
+    rung.start = start;
+    rung.bucketWidth = width;
+    rung.current = 0;
+    rung.count = 0;
+    for (auto& b : rung.buckets) b.clear();
+    rung.buckets.resize(nBuckets);
+    return rung;
+}
+
+// ==================== 取出 ====================
+
+void LadderScheduler::TransferTopToLadder() {
+    NS_LOG_FUNCTION(this << m_top.size());
+    if (m_topMin == m_topMax) {
+        // 时间戳全部相同，无法分桶，直接按 uid 排序进入 Bottom
+        MoveBucketToBottom(m_top);
+    } else {
+        uint64_t span = m_topMax - m_topMin;
+        uint64_t n = std::min<uint64_t>(m_top.size(), kMaxBuckets);
+        uint64_t width = span / n + 1;
+        Rung& rung = PushRung(m_topMin, width, static_cast<uint32_t>(span / width + 1));
+        for (const Event& ev : m_top) {
+            rung.buckets[BucketIndex(rung, ev.key.m_ts)].push_back(ev);
+        }
+        rung.count = m_top.size();
+        m_top.clear();
+    }
+    m_topStart = m_topMax + 1;
+    m_topMin = std::numeric_limits<uint64_t>::max();
+    m_topMax = 0;
+}
+
+void LadderScheduler::MoveBucketToBottom(std::vector<Event>& bucket) {
+    std::sort(bucket.begin(), bucket.end(), KeyLess);
+    m_bottom.insert(m_bottom.end(), bucket.begin(), bucket.end());
+    bucket.clear();
+}
+
+void LadderScheduler::RefillBottom() {
+    while (m_bottom.empty()) {
+        if (m_nRungs == 0) {
+            if (m_top.empty()) return;
+            TransferTopToLadder();
+            continue;
+        }
+
+        Rung& rung = m_rungs[m_nRungs - 1];
+        if (rung.count == 0) {
+            m_nRungs--;
+            continue;
+        }
+        while (rung.buckets[rung.current].empty()) rung.current++;
+
+        std::vector<Event> events;
+        events.swap(rung.buckets[rung.current]);
+        rung.count -= events.size();
+        rung.current++;
+        bool rungDone = (rung.count == 0 || rung.current >= rung.buckets.size());
+
+        uint64_t lo = std::numeric_limits<uint64_t>::max(), hi = 0;
+        if (events.size() > m_threshold) {
+            for (const Event& ev : events) {
+                lo = std::min(lo, ev.key.m_ts);
+                hi = std::max(hi, ev.key.m_ts);
+            }
+        }
+
+        // 当前 rung 已取完时先弹出，新 rung 占用它的位置
+        uint32_t depth = m_nRungs - (rungDone ? 1 : 0);
+        if (events.size() > m_threshold && hi > lo && depth < m_maxRungs) {
+            // 桶太大：按实际时间范围细分出下一级 rung
+            m_nRungs = depth;
+            uint64_t span = hi - lo;
+            uint64_t n = std::min<uint64_t>(events.size(), kMaxBuckets);
+            uint64_t width = span / n + 1;
+            Rung& child = PushRung(lo, width, static_cast<uint32_t>(span / width + 1));
+            for (const Event& ev : events) {
+                child.buckets[BucketIndex(child, ev.key.m_ts)].push_back(ev);
+            }
+            child.count = events.size();
+        } else {
+            MoveBucketToBottom(events);
+            m_nRungs = depth;
+        }
+    }
+}
+
+bool LadderScheduler::IsEmpty() const {
+    return m_size == 0;
+}
+
+Scheduler::Event LadderScheduler::PeekNext() const {
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    const_cast<LadderScheduler*>(this)->RefillBottom();
+    return m_bottom.front();
+}
+
+Scheduler::Event LadderScheduler::RemoveNext() {
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    RefillBottom();
+    Event ev = m_bottom.front();
+    m_bottom.pop_front();
+    m_size--;
+    return ev;
+}
+
+// ==================== 删除 ====================
+
+void LadderScheduler::Remove(const Event& ev) {
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    uint64_t ts = ev.key.m_ts;
+    auto sameUid = [&ev](const Event& e) { return e.key.m_uid == ev.key.m_uid; };
+
+    if (ts >= m_topStart) {
+        auto it = std::find_if(m_top.begin(), m_top.end(), sameUid);
+        NS_ASSERT_MSG(it != m_top.end(), "Event not found in top");
+        *it = m_top.back();
+        m_top.pop_back();
+        m_size--;
+        return;
+    }
+
+    int r = FindRung(ts);
+    if (r >= 0) {
+        Rung& rung = m_rungs[r];
+        std::vector<Event>& bucket = rung.buckets[BucketIndex(rung, ts)];
+        auto it = std::find_if(bucket.begin(), bucket.end(), sameUid);
+        NS_ASSERT_MSG(it != bucket.end(), "Event not found in ladder");
+        *it = bucket.back();
+        bucket.pop_back();
+        rung.count--;
+        m_size--;
+        return;
+    }
+
+    auto it = std::lower_bound(m_bottom.begin(), m_bottom.end(), ev, KeyLess);
+    NS_ASSERT_MSG(it != m_bottom.end() && it->key.m_uid == ev.key.m_uid, "Event not found in bottom");
+    m_bottom.erase(it);
+    m_size--;
+}
+
+} // namespace ns3
@@ -0,0 +1,76 @@
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+// ladder-scheduler.h - Ladder Queue 事件调度器
+// 参考 Tang, Goh & Thng, "Ladder Queue: An O(1) Priority Queue Structure for
+// Large-Scale Discrete Event Simulation" (TOMACS 2005)。
+// 事件分三层存放：
+//   Top    - 未排序，存放时间戳 >= TopStart 的远期事件
+//   Ladder - 若干级桶 (rung)，每级桶宽由上一级细分得到，桶内不排序
+//   Bottom - 已排序，存放最近的一批事件，RemoveNext 直接从这里取
+// 桶内事件超过 BucketThreshold 时向下细分出新的一级，桶宽随事件密度自适应；
+// 插入使 Bottom 超过同一阈值时，Bottom 整体转成新的一级 rung，有序插入的代价不随 Bottom 增长。
+// 对大量时间戳相近的分组事件，插入和取出的均摊代价与事件总数无关。
+
+#include "ns3/scheduler.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace ns3 {
+
+class LadderScheduler : public Scheduler {
+public:
+    static TypeId GetTypeId();
+
+    LadderScheduler();
+    ~LadderScheduler() override;
+
+    void Insert(const Event& ev) override;
+    bool IsEmpty() const override;
+    Event PeekNext() const override;
+    Event RemoveNext() override;
+    void Remove(const Event& ev) override;
+
+private:
+    struct Rung {
+        uint64_t start = 0;         // 第 0 个桶的起始时间戳
+        uint64_t bucketWidth = 1;
+        uint32_t current = 0;       // 当前 (最早的非空) 桶
+        uint64_t count = 0;
+        std::vector<std::vector<Event>> buckets;
+
+        uint64_t CurrentStart() const { return start + current * bucketWidth; }
+    };
+
+    // 找到事件应当所在的 rung，不属于任何 rung 时返回 -1
+    int FindRung(uint64_t ts) const;
+    uint32_t BucketIndex(const Rung& rung, uint64_t ts) const;
+    Rung& PushRung(uint64_t start, uint64_t width, uint32_t nBuckets);
+    void TransferTopToLadder();
+    void MoveBucketToBottom(std::vector<Event>& bucket);
+    void InsertBottom(const Event& ev);
+    // Bottom 转成最细一级 rung，之后由 RefillBottom 重新取出
+    void SpillBottom();
+    // 保证 Bottom 非空 (队列为空时除外)
+    void RefillBottom();
+
+    std::vector<Event> m_top;
+    uint64_t m_topMin;
+    uint64_t m_topMax;
+    uint64_t m_topStart;
+
+    std::vector<Rung> m_rungs;      // 复用已分配的 rung，m_nRungs 之后的为空闲
+    uint32_t m_nRungs;
+
+    std::deque<Event> m_bottom;     // 按 EventKey 升序
+
+    uint64_t m_size;
+    uint32_t m_threshold;
+    uint32_t m_maxRungs;
+};
+
+} // namespace ns3
+
+#endif // LADDER_SCHEDULER_H
@@ -154,6 +154,7 @@ class NS3SimulationManager:
 
         import glob
         files = glob.glob(os.path.join(result_dir, "flow_results_slice_*.csv"))
+        files += glob.glob(os.path.join(result_dir, "flow_results_slice_*.csv.gz"))
 
         if not files:
             print("   ❌ 未找到时间片结果文件")
@@ -19,6 +19,8 @@ import os
 import glob
 import pandas as pd
 
+from starlink_columnar import read_columnar
+
 
 class NS3SimulationManager:
     """NS3仿真管理器"""
@@ -29,11 +31,24 @@ class NS3SimulationManager:
 
     def _sort_by_slice_id(self, files: list) -> list:
         """按时间片编号排序"""
-        return sorted(files, key=lambda x: int(x.split("slice_")[1].replace(".csv", "")))
+        return sorted(files, key=lambda x: int(x.split("slice_")[1].split(".")[0]))
+
+    def _result_files(self) -> list:
+        """每个时间片一个结果文件，优先级 .slcol > .csv.gz (--compressOutput) > .csv"""
+        files = {}
+        for ext in ("csv", "csv.gz", "slcol"):
+            for f in glob.glob(f"{self.results_dir}/flow_results_slice_*.{ext}"):
+                files[os.path.basename(f).split(".")[0]] = f
+        return list(files.values())
+
+    def _load_results(self, path: str) -> pd.DataFrame:
+        if path.endswith(".slcol"):
+            return read_columnar(path).to_dataframe()
+        return pd.read_csv(path)
 
     def check_results_available(self) -> bool:
         """检查NS3结果是否可用"""
-        result_files = glob.glob(f"{self.results_dir}/flow_results_slice_*.csv")
+        result_files = self._result_files()
 
         if result_files:
             result_files = self._sort_by_slice_id(result_files)
@@ -47,7 +62,7 @@ class NS3SimulationManager:
 
     def analyze_results(self):
         """分析NS3结果"""
-        result_files = glob.glob(f"{self.results_dir}/flow_results_slice_*.csv")
+        result_files = self._result_files()
 
         if not result_files:
             print("❌ 没有结果文件")
@@ -59,10 +74,10 @@ class NS3SimulationManager:
         all_results = []
         for f in result_files:
             try:
-                df = pd.read_csv(f)
+                df = self._load_results(f)
                 if df.empty:
                     continue
-                slice_id = int(f.split("slice_")[1].replace(".csv", ""))
+                slice_id = int(f.split("slice_")[1].split(".")[0])
                 df['slice_id'] = slice_id
                 all_results.append(df)
                 print(f"📊 加载: {f} ({len(df)} 条流)")
@@ -0,0 +1,104 @@
+"""
+@Function :
+            仿真性能汇总
+            - 读取 starlink-sim 每个切片输出的 perf_summary_slice_*.json
+            - 按阶段聚合墙钟时间 / CPU 时间 / 峰值内存 / 分配次数
+            - 仅依赖标准库，可在 Linux 端由 run_slices.sh 直接调用
+"""
+
+import os
+import sys
+import json
+import glob
+
+
+def _slice_id(path: str) -> int:
+    return int(os.path.basename(path).split("slice_")[1].split(".")[0])
+
+
+def load_perf_summaries(result_dir: str) -> dict:
+    """读取目录下所有切片的性能汇总, 返回 slice_id -> summary"""
+    summaries = {}
+    for f in glob.glob(os.path.join(result_dir, "perf_summary_slice_*.json")):
+        try:
+            with open(f, 'r', encoding='utf-8') as fp:
+                summaries[_slice_id(f)] = json.load(fp)
+        except (ValueError, OSError) as e:
+            print(f"⚠️ 读取失败 {f}: {e}")
+    return dict(sorted(summaries.items()))
+
+
+def aggregate_perf_summaries(summaries: dict) -> dict:
+    """跨切片聚合: 每个阶段的总和 / 均值 / 最大值"""
+    phases = {}
+    order = []
+    for summary in summaries.values():
+        for p in summary.get("phases", []):
+            name = p["name"]
+            if name not in phases:
+                phases[name] = {"wall_s": [], "cpu_s": [], "peak_rss_kb": [], "allocs": [], "events": []}
+                order.append(name)
+            for key in phases[name]:
+                phases[name][key].append(p.get(key, 0))
+
+    result = {"num_slices": len(summaries), "phases": []}
+    for name in order:
+        v = phases[name]
+        n = len(v["wall_s"])
+        result["phases"].append({
+            "name": name,
+            "wall_s_total": sum(v["wall_s"]),
+            "wall_s_mean": sum(v["wall_s"]) / n,
+            "wall_s_max": max(v["wall_s"]),
+            "cpu_s_total": sum(v["cpu_s"]),
+            "peak_rss_kb_max": max(v["peak_rss_kb"]),
+            "allocs_total": sum(v["allocs"]),
+            "events_total": sum(v["events"]),
+        })
+
+    runs = [s.get("run", {}) for s in summaries.values()]
+    totals = [s.get("total", {}) for s in summaries.values()]
+    events = sum(r.get("events", 0) for r in runs)
+    run_wall = sum(p["wall_s_total"] for p in result["phases"] if p["events_total"] > 0)
+    result["run"] = {
+        "events": events,
+        "events_per_sec": events / run_wall if run_wall > 0 else 0.0,
+    }
+    result["total"] = {
+        "wall_s": sum(t.get("wall_s", 0) for t in totals),
+        "cpu_s": sum(t.get("cpu_s", 0) for t in totals),
+        "peak_rss_kb": max((t.get("peak_rss_kb", 0) for t in totals), default=0),
+        "allocs": sum(t.get("allocs", 0) for t in totals),
+    }
+    result["slices"] = {str(k): v.get("total", {}) for k, v in summaries.items()}
+    return result
+
+
+def print_perf_report(agg: dict):
+    """打印聚合后的阶段耗时表"""
+    print("\n" + "=" * 72)
+    print(f"⏱️  阶段耗时汇总 ({agg['num_slices']} 个切片)")
+    print("=" * 72)
+    print(f"{'阶段':<16}{'总耗时(s)':>12}{'平均(s)':>10}{'最大(s)':>10}{'CPU(s)':>10}{'峰值内存(MB)':>14}")
+    for p in agg["phases"]:
+        print(f"{p['name']:<16}{p['wall_s_total']:>12.3f}{p['wall_s_mean']:>10.3f}{p['wall_s_max']:>10.3f}"
+              f"{p['cpu_s_total']:>10.3f}{p['peak_rss_kb_max'] / 1024:>14.1f}")
+    print("-" * 72)
+    print(f"仿真事件: {agg['run']['events']}  ({agg['run']['events_per_sec']:.0f} events/s)")
+    print(f"总耗时:   {agg['total']['wall_s']:.3f} s")
+    print("=" * 72)
+
+
+if __name__ == "__main__":
+    result_dir = sys.argv[1] if len(sys.argv) > 1 else "ns3_results"
+    summaries = load_perf_summaries(result_dir)
+    if not summaries:
+        print("❌ 未找到 perf_summary_slice_*.json")
+        sys.exit(1)
+
+    agg = aggregate_perf_summaries(summaries)
+    out_file = os.path.join(result_dir, "perf_summary_all.json")
+    with open(out_file, 'w', encoding='utf-8') as f:
+        json.dump(agg, f, indent=2)
+    print_perf_report(agg)
+    print(f"💾 已保存: {out_file}")
@@ -0,0 +1,176 @@
+#include "profiling-simulator-impl.h"
+#include "starlink-zstream.h"
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <iomanip>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("ProfilingSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(ProfilingSimulatorImpl);
+
+// ==================== 包装事件 ====================
+
+// 持有原事件的引用；被取消时 EventImpl::Invoke 不会调用 Notify，原事件也不会执行
+class ProfiledEvent : public EventImpl {
+public:
+    ProfiledEvent(ProfilingSimulatorImpl* sim, EventImpl* inner, uint32_t typeIndex)
+        : m_sim(sim), m_inner(inner, false), m_typeIndex(typeIndex) {}
+
+protected:
+    void Notify() override {
+        if (!m_sim->BeginEvent(m_typeIndex)) {
+            m_inner->Invoke();
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        m_inner->Invoke();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        m_sim->EndEvent(m_typeIndex, static_cast<uint64_t>(ns.count()));
+    }
+
+private:
+    ProfilingSimulatorImpl* m_sim;
+    Ptr<EventImpl> m_inner;
+    uint32_t m_typeIndex;
+};
+
+// 去掉 MakeEvent 生成的包装类名中的冗余部分，只保留回调签名
+static std::string EventTypeName(const std::type_info& ti) {
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(ti.name(), nullptr, nullptr, &status);
+    std::string name = (status == 0 && demangled) ? demangled : ti.name();
+    std::free(demangled);
+    std::string::size_type pos;
+    while ((pos = name.find("ns3::")) != std::string::npos) name.erase(pos, 5);
+    if (name.compare(0, 10, "MakeEvent<") == 0) {
+        std::string::size_type end = name.rfind(">(");
+        if (end != std::string::npos) name = name.substr(10, end - 10);
+    }
+    return name;
+}
+
+// ==================== ProfilingSimulatorImpl ====================
+
+TypeId ProfilingSimulatorImpl::GetTypeId() {
+    static TypeId tid = TypeId("ns3::ProfilingSimulatorImpl")
+        .SetParent<DefaultSimulatorImpl>()
+        .SetGroupName("Core")
+        .AddConstructor<ProfilingSimulatorImpl>()
+        .AddAttribute("SampleInterval",
+                      "Time one in every N executed events",
+                      UintegerValue(64),
+                      MakeUintegerAccessor(&ProfilingSimulatorImpl::m_sampleInterval),
+                      MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+ProfilingSimulatorImpl::ProfilingSimulatorImpl()
+    : m_sampleInterval(64), m_executed(0) {
+    NS_LOG_FUNCTION(this);
+}
+
+ProfilingSimulatorImpl::~ProfilingSimulatorImpl() {
+    NS_LOG_FUNCTION(this);
+}
+
+EventImpl* ProfilingSimulatorImpl::Wrap(EventImpl* event) {
+    std::type_index key(typeid(*event));
+    auto it = m_typeIndex.find(key);
+    uint32_t index;
+    if (it == m_typeIndex.end()) {
+        index = static_cast<uint32_t>(m_stats.size());
+        m_typeIndex.emplace(key, index);
+        m_stats.push_back(EventTypeStats());
+        m_stats.back().name = EventTypeName(typeid(*event));
+    } else {
+        index = it->second;
+    }
+    return new ProfiledEvent(this, event, index);
+}
+
+EventId ProfilingSimulatorImpl::Schedule(const Time& delay, EventImpl* event) {
+    return DefaultSimulatorImpl::Schedule(delay, Wrap(event));
+}
+
+void ProfilingSimulatorImpl::ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) {
+    DefaultSimulatorImpl::ScheduleWithContext(context, delay, Wrap(event));
+}
+
+EventId ProfilingSimulatorImpl::ScheduleNow(EventImpl* event) {
+    return DefaultSimulatorImpl::ScheduleNow(Wrap(event));
+}
+
+bool ProfilingSimulatorImpl::BeginEvent(uint32_t typeIndex) {
+    m_stats[typeIndex].count++;
+    return (m_executed++ % m_sampleInterval) == 0;
+}
+
+void ProfilingSimulatorImpl::EndEvent(uint32_t typeIndex, uint64_t elapsedNs) {
+    m_stats[typeIndex].sampled++;
+    m_stats[typeIndex].sampledNs += elapsedNs;
+}
+
+// 按估计总耗时（采样均值 × 执行次数）排序
+static std::vector<const EventTypeStats*> SortByCost(const std::vector<EventTypeStats>& stats) {
+    std::vector<const EventTypeStats*> sorted;
+    for (const auto& s : stats) sorted.push_back(&s);
+    auto cost = [](const EventTypeStats* s) {
+        return s->sampled ? (double)s->sampledNs / s->sampled * s->count : 0.0;
+    };
+    std::sort(sorted.begin(), sorted.end(), [&](const EventTypeStats* a, const EventTypeStats* b) {
+        return cost(a) != cost(b) ? cost(a) > cost(b) : a->count > b->count;
+    });
+    return sorted;
+}
+
+void ProfilingSimulatorImpl::PrintTopN(std::ostream& os, uint32_t n) const {
+    uint64_t totalCount = 0;
+    double totalNs = 0;
+    for (const auto& s : m_stats) {
+        totalCount += s.count;
+        if (s.sampled) totalNs += (double)s.sampledNs / s.sampled * s.count;
+    }
+
+    os << "Event profile (" << totalCount << " events, 1/" << m_sampleInterval << " timed):\n";
+    os << std::setw(12) << "count" << std::setw(8) << "%evt"
+       << std::setw(10) << "ns/evt" << std::setw(12) << "est ms" << std::setw(8) << "%time"
+       << "  type\n";
+    auto sorted = SortByCost(m_stats);
+    for (uint32_t i = 0; i < sorted.size() && i < n; ++i) {
+        const EventTypeStats* s = sorted[i];
+        double mean = s->sampled ? (double)s->sampledNs / s->sampled : 0;
+        std::string name = s->name.size() > 100 ? s->name.substr(0, 97) + "..." : s->name;
+        os << std::fixed << std::setprecision(1)
+           << std::setw(12) << s->count
+           << std::setw(8) << (totalCount ? 100.0 * s->count / totalCount : 0)
+           << std::setw(10) << mean
+           << std::setw(12) << mean * s->count / 1e6
+           << std::setw(8) << (totalNs > 0 ? 100.0 * mean * s->count / totalNs : 0)
+           << "  " << name << "\n";
+    }
+    os.unsetf(std::ios::floatfield);
+}
+
+bool ProfilingSimulatorImpl::WriteCsv(const std::string& file, bool compress) const {
+    OutputFile f;
+    if (!f.Open(file, compress)) return false;
+    f << "EventType,Count,Sampled,MeanNs,EstTotalMs\n";
+    for (const EventTypeStats* s : SortByCost(m_stats)) {
+        double mean = s->sampled ? (double)s->sampledNs / s->sampled : 0;
+        std::string name = s->name;
+        std::replace(name.begin(), name.end(), '"', '\'');
+        f << "\"" << name << "\"," << s->count << "," << s->sampled << ","
+          << std::fixed << std::setprecision(1) << mean << "," << std::setprecision(3) << mean * s->count / 1e6 << "\n";
+    }
+    return f.Close();
+}
+
+} // namespace ns3
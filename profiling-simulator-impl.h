@@ -0,0 +1,58 @@
+#ifndef PROFILING_SIMULATOR_IMPL_H
+#define PROFILING_SIMULATOR_IMPL_H
+
+// profiling-simulator-impl.h - 按事件类型统计的仿真器实现
+// 在 DefaultSimulatorImpl 之上包装每个被调度的事件，按回调类型 (EventImpl 的动态类型)
+// 统计执行次数，并对每 SampleInterval 个事件采样一次执行耗时。
+// 通过 --eventProfile 选择，运行结束后打印 Top-N 表。
+
+#include "ns3/default-simulator-impl.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+struct EventTypeStats {
+    std::string name;
+    uint64_t count = 0;         // 已执行次数
+    uint64_t sampled = 0;       // 被采样计时的次数
+    uint64_t sampledNs = 0;     // 采样事件的累计耗时
+};
+
+class ProfilingSimulatorImpl : public DefaultSimulatorImpl {
+public:
+    static TypeId GetTypeId();
+
+    ProfilingSimulatorImpl();
+    ~ProfilingSimulatorImpl() override;
+
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+
+    // 由包装事件回调：记录一次执行，返回是否需要对本次执行计时
+    bool BeginEvent(uint32_t typeIndex);
+    void EndEvent(uint32_t typeIndex, uint64_t elapsedNs);
+
+    const std::vector<EventTypeStats>& GetStats() const { return m_stats; }
+    void PrintTopN(std::ostream& os, uint32_t n) const;
+    // compress 时写分块 gzip (starlink-zstream.h)
+    bool WriteCsv(const std::string& file, bool compress = false) const;
+
+private:
+    EventImpl* Wrap(EventImpl* event);
+
+    std::unordered_map<std::type_index, uint32_t> m_typeIndex;
+    std::vector<EventTypeStats> m_stats;
+    uint32_t m_sampleInterval;
+    uint64_t m_executed;
+};
+
+} // namespace ns3
+
+#endif // PROFILING_SIMULATOR_IMPL_H
@@ -50,14 +50,17 @@ echo "--------------------------------------------------"
 
 files=$(ls -v "$INPUT_DIR"/link_params_slice_*.csv)
 
+# 每个切片运行后按 <名字>_slice_<编号> 重命名的输出 (flow_results 由 --output 直接命名)
+SLICE_OUTPUTS="route_paths link_monitor link_stats components steady_state demand_results tcp_flows
+    surrogate_results surrogate_links flow_timeseries link_timeseries hop_latency_links hop_latency_flows
+    event_profile"
+
 for file in $files; do
     filename=$(basename "$file")
     slice_id=$(echo "$filename" | grep -oP '(?<=slice_)\d+')
     
     result_file="flow_results_slice_${slice_id}.csv"
-    route_file="route_paths_slice_${slice_id}.csv"
-    monitor_file="link_monitor_slice_${slice_id}.csv"
-    stats_file="link_stats_slice_${slice_id}.csv"
+    perf_file="perf_summary_slice_${slice_id}.json"
     
     echo -n "   ⏳ Slice $slice_id ... "
     
@@ -68,10 +71,13 @@ for file in $files; do
         --no-sync > "$PROJECT_DIR/logs/slice_${slice_id}.log" 2>&1
     
     if [ $? -eq 0 ]; then
-        # 重命名输出文件
-        [ -f "$OUTPUT_DIR/route_paths.csv" ] && mv "$OUTPUT_DIR/route_paths.csv" "$OUTPUT_DIR/$route_file"
-        [ -f "$OUTPUT_DIR/link_monitor.csv" ] && mv "$OUTPUT_DIR/link_monitor.csv" "$OUTPUT_DIR/$monitor_file"
-        [ -f "$OUTPUT_DIR/link_stats.csv" ] && mv "$OUTPUT_DIR/link_stats.csv" "$OUTPUT_DIR/$stats_file"
+        # 重命名输出文件 (每种输出可能是 .csv / .slcol / --compressOutput 的 .csv.gz 和索引)
+        for name in $SLICE_OUTPUTS; do
+            for ext in csv slcol csv.gz csv.gz.idx; do
+                [ -f "$OUTPUT_DIR/$name.$ext" ] && mv "$OUTPUT_DIR/$name.$ext" "$OUTPUT_DIR/${name}_slice_${slice_id}.$ext"
+            done
+        done
+        [ -f "$OUTPUT_DIR/perf_summary.json" ] && mv "$OUTPUT_DIR/perf_summary.json" "$OUTPUT_DIR/$perf_file"
         
         echo "✅ 完成"
     else
@@ -81,6 +87,15 @@ done
 
 echo "--------------------------------------------------"
 
+#=============================================================================
+# 性能汇总
+#=============================================================================
+
+if command -v python3 >/dev/null 2>&1; then
+    python3 "$PROJECT_DIR/perf_report.py" "$OUTPUT_DIR"
+    echo "--------------------------------------------------"
+fi
+
 #=============================================================================
 # 回传结果
 #=============================================================================
@@ -88,10 +103,10 @@ echo "--------------------------------------------------"
 echo -n "📤 正在回传结果 (Linux -> Windows) ... "
 mkdir -p "$SHARED_OUTPUT"
 
-cp "$OUTPUT_DIR"/flow_results_slice_*.csv "$SHARED_OUTPUT/" 2>/dev/null
-cp "$OUTPUT_DIR"/route_paths_slice_*.csv "$SHARED_OUTPUT/" 2>/dev/null
-cp "$OUTPUT_DIR"/link_monitor_slice_*.csv "$SHARED_OUTPUT/" 2>/dev/null
-cp "$OUTPUT_DIR"/link_stats_slice_*.csv "$SHARED_OUTPUT/" 2>/dev/null
+cp "$OUTPUT_DIR"/*_slice_*.csv "$SHARED_OUTPUT/" 2>/dev/null
+cp "$OUTPUT_DIR"/*_slice_*.slcol "$SHARED_OUTPUT/" 2>/dev/null
+cp "$OUTPUT_DIR"/*_slice_*.csv.gz* "$SHARED_OUTPUT/" 2>/dev/null
+cp "$OUTPUT_DIR"/perf_summary_*.json "$SHARED_OUTPUT/" 2>/dev/null
 
 echo "✅ 完成"
 echo "=================================================="
@@ -0,0 +1,160 @@
+#include "scheduler-trace.h"
+
+#include "ns3/log.h"
+#include "ns3/object-factory.h"
+#include "ns3/string.h"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("SchedulerTrace");
+
+NS_OBJECT_ENSURE_REGISTERED(TracingScheduler);
+
+// 轨迹记录：1 字节操作类型 + 8 字节时间戳 + 4 字节 uid，小端
+enum TraceOp : uint8_t { TRACE_INSERT = 0, TRACE_REMOVE_NEXT = 1, TRACE_REMOVE = 2 };
+static const size_t kRecordSize = 13;
+
+// ==================== TracingScheduler ====================
+
+TypeId TracingScheduler::GetTypeId() {
+    static TypeId tid = TypeId("ns3::TracingScheduler")
+        .SetParent<MapScheduler>()
+        .SetGroupName("Core")
+        .AddConstructor<TracingScheduler>()
+        .AddAttribute("TraceFile",
+                      "Binary file receiving the scheduler operation trace",
+                      StringValue("scheduler.trace"),
+                      MakeStringAccessor(&TracingScheduler::m_traceFile),
+                      MakeStringChecker());
+    return tid;
+}
+
+TracingScheduler::TracingScheduler() {
+    NS_LOG_FUNCTION(this);
+}
+
+TracingScheduler::~TracingScheduler() {
+    NS_LOG_FUNCTION(this);
+    if (m_out.is_open()) m_out.close();
+}
+
+void TracingScheduler::Record(uint8_t op, const Event& ev) {
+    if (!m_out.is_open()) {
+        m_out.open(m_traceFile.c_str(), std::ios::binary);
+        if (!m_out.is_open()) NS_FATAL_ERROR("Cannot open scheduler trace " << m_traceFile);
+    }
+    char rec[kRecordSize];
+    rec[0] = static_cast<char>(op);
+    std::memcpy(rec + 1, &ev.key.m_ts, 8);
+    std::memcpy(rec + 9, &ev.key.m_uid, 4);
+    m_out.write(rec, kRecordSize);
+}
+
+void TracingScheduler::Insert(const Event& ev) {
+    Record(TRACE_INSERT, ev);
+    MapScheduler::Insert(ev);
+}
+
+Scheduler::Event TracingScheduler::RemoveNext() {
+    Event ev = MapScheduler::RemoveNext();
+    Record(TRACE_REMOVE_NEXT, ev);
+    return ev;
+}
+
+void TracingScheduler::Remove(const Event& ev) {
+    Record(TRACE_REMOVE, ev);
+    MapScheduler::Remove(ev);
+}
+
+// ==================== 回放 ====================
+
+std::vector<SchedulerReplayResult> ReplaySchedulerTrace(const std::string& file, const std::string& types) {
+    std::vector<SchedulerReplayResult> results;
+    std::ifstream in(file.c_str(), std::ios::binary);
+    if (!in.is_open()) { std::cerr << "Cannot open: " << file << std::endl; return results; }
+    std::vector<char> trace((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    size_t nOps = trace.size() / kRecordSize;
+    std::cout << "Replaying " << nOps << " scheduler operations from " << file << "\n";
+
+    std::stringstream ss(types);
+    std::string type;
+    while (std::getline(ss, type, ',')) {
+        if (type.empty()) continue;
+        ObjectFactory factory;
+        factory.SetTypeId(type);
+        Ptr<Scheduler> scheduler = factory.Create<Scheduler>();
+
+        SchedulerReplayResult r;
+        r.type = type;
+        uint64_t pending = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < nOps; ++i) {
+            const char* rec = &trace[i * kRecordSize];
+            Scheduler::Event ev;
+            ev.impl = nullptr;
+            std::memcpy(&ev.key.m_ts, rec + 1, 8);
+            std::memcpy(&ev.key.m_uid, rec + 9, 4);
+            ev.key.m_context = 0;
+            switch (static_cast<uint8_t>(rec[0])) {
+            case TRACE_INSERT:
+                scheduler->Insert(ev);
+                r.inserts++;
+                if (++pending > r.maxPending) r.maxPending = pending;
+                break;
+            case TRACE_REMOVE_NEXT:
+                scheduler->RemoveNext();
+                r.removes++;
+                pending--;
+                break;
+            case TRACE_REMOVE:
+                scheduler->Remove(ev);
+                r.removes++;
+                pending--;
+                break;
+            }
+        }
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        r.ops = nOps;
+        results.push_back(r);
+    }
+    return results;
+}
+
+void PrintSchedulerReplay(std::ostream& os, const std::vector<SchedulerReplayResult>& results) {
+    os << std::left << std::setw(26) << "scheduler" << std::right
+       << std::setw(14) << "ops" << std::setw(12) << "pending" << std::setw(12) << "total s"
+       << std::setw(10) << "ns/op" << "\n";
+    for (const auto& r : results) {
+        os << std::left << std::setw(26) << r.type << std::right
+           << std::setw(14) << r.ops << std::setw(12) << r.maxPending
+           << std::fixed << std::setprecision(3) << std::setw(12) << r.seconds
+           << std::setprecision(1) << std::setw(10) << (r.ops ? r.seconds * 1e9 / r.ops : 0.0) << "\n";
+    }
+    os.unsetf(std::ios::floatfield);
+}
+
+bool WriteSchedulerReplayJson(const std::string& file, const std::vector<SchedulerReplayResult>& results) {
+    std::ofstream f(file.c_str());
+    if (!f.is_open()) return false;
+    f << std::setprecision(9) << "[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        f << (i ? ",\n " : "\n ")
+          << "{\"scheduler\": \"" << r.type << "\", \"ops\": " << r.ops
+          << ", \"inserts\": " << r.inserts << ", \"removes\": " << r.removes
+          << ", \"max_pending\": " << r.maxPending << ", \"seconds\": " << r.seconds
+          << ", \"ns_per_op\": " << (r.ops ? r.seconds * 1e9 / r.ops : 0.0) << "}";
+    }
+    f << "\n]\n";
+    f.close();
+    return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,54 @@
+#ifndef SCHEDULER_TRACE_H
+#define SCHEDULER_TRACE_H
+
+// scheduler-trace.h - 调度器操作轨迹的记录与回放
+// TracingScheduler 在 MapScheduler 的基础上把每次 Insert / RemoveNext / Remove
+// 的 (时间戳, uid) 写入二进制文件；ReplaySchedulerTrace 把同一轨迹依次回放到
+// 不同的 Scheduler 实现上，测量每次操作的平均耗时。
+// 用于在真实星座流量的事件序列上比较 Map / Heap / Calendar / Ladder 调度器。
+
+#include "ns3/map-scheduler.h"
+
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class TracingScheduler : public MapScheduler {
+public:
+    static TypeId GetTypeId();
+
+    TracingScheduler();
+    ~TracingScheduler() override;
+
+    void Insert(const Event& ev) override;
+    Event RemoveNext() override;
+    void Remove(const Event& ev) override;
+
+private:
+    void Record(uint8_t op, const Event& ev);
+
+    std::string m_traceFile;
+    std::ofstream m_out;
+};
+
+struct SchedulerReplayResult {
+    std::string type;
+    uint64_t ops = 0;
+    uint64_t inserts = 0;
+    uint64_t removes = 0;
+    uint64_t maxPending = 0;
+    double seconds = 0;
+};
+
+// types 为逗号分隔的调度器 TypeId 列表
+std::vector<SchedulerReplayResult> ReplaySchedulerTrace(const std::string& file, const std::string& types);
+void PrintSchedulerReplay(std::ostream& os, const std::vector<SchedulerReplayResult>& results);
+bool WriteSchedulerReplayJson(const std::string& file, const std::vector<SchedulerReplayResult>& results);
+
+} // namespace ns3
+
+#endif // SCHEDULER_TRACE_H
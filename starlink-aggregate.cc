@@ -0,0 +1,72 @@
+#include "starlink-aggregate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <sstream>
+
+std::vector<DemandGroup> AggregateDemands(const DemandPaths& paths, bool enabled, double toleranceSec) {
+    std::vector<DemandGroup> groups;
+    // (源, 目的) -> 该端点对上已有的组下标
+    std::map<std::pair<uint32_t, uint32_t>, std::vector<size_t>> byEndpoints;
+    for (size_t k = 0; k < g_demands.size() && k < paths.size(); ++k) {
+        if (paths[k].size() < 2) continue;
+        const TrafficDemand& d = g_demands[k];
+        double start = d.startTimeSec, end = d.startTimeSec + d.durationSec;
+
+        if (enabled) {
+            auto& candidates = byEndpoints[{d.srcId, d.dstId}];
+            bool merged = false;
+            for (size_t g : candidates) {
+                // 与组代表比较，避免链式合并把时间窗逐步拉长
+                const TrafficDemand& rep = g_demands[groups[g].members.front()];
+                double repEnd = rep.startTimeSec + rep.durationSec;
+                if (std::fabs(start - rep.startTimeSec) <= toleranceSec && std::fabs(end - repEnd) <= toleranceSec) {
+                    DemandGroup& group = groups[g];
+                    group.members.push_back(static_cast<uint32_t>(k));
+                    group.rateMbps += d.dataRateMbps;
+                    group.startSec = std::min(group.startSec, start);
+                    group.endSec = std::max(group.endSec, end);
+                    merged = true;
+                    break;
+                }
+            }
+            if (merged) continue;
+            candidates.push_back(groups.size());
+        }
+
+        DemandGroup group;
+        group.members.push_back(static_cast<uint32_t>(k));
+        group.rateMbps = d.dataRateMbps;
+        group.startSec = start;
+        group.endSec = end;
+        groups.push_back(group);
+    }
+    return groups;
+}
+
+std::string GroupDemandIds(const DemandGroup& group) {
+    std::ostringstream ids;
+    for (size_t i = 0; i < group.members.size(); ++i) {
+        if (i) ids << ";";
+        ids << g_demands[group.members[i]].demandId;
+    }
+    return ids.str();
+}
+
+// ==================== 平滑加权轮询 ====================
+
+WeightedRoundRobin::WeightedRoundRobin(const std::vector<double>& weights)
+    : m_weights(weights), m_current(weights.size(), 0), m_total(0) {
+    for (double w : m_weights) m_total += w;
+}
+
+uint32_t WeightedRoundRobin::Next() {
+    uint32_t best = 0;
+    for (uint32_t i = 0; i < m_weights.size(); ++i) {
+        m_current[i] += m_weights[i];
+        if (m_current[i] > m_current[best]) best = i;
+    }
+    m_current[best] -= m_total;
+    return best;
+}
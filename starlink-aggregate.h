@@ -0,0 +1,41 @@
+#ifndef STARLINK_AGGREGATE_H
+#define STARLINK_AGGREGATE_H
+
+// starlink-aggregate.h - 端点与时间窗相同的需求合并
+// 同一 (源, 目的) 上起止时刻相差不超过 tolerance 的需求合并成一个组，由一个 OnOff 源
+// 以速率之和发送；每个分组按成员速率做平滑加权轮询，打上 SubFlowTag 标明所属的原始需求，
+// 在接收端按原始需求分别统计。大量重叠需求的矩阵可以少装很多应用、端口和流状态。
+
+#include "starlink-topology.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct DemandGroup {
+    std::vector<uint32_t> members;  // g_demands 下标，第一个为代表
+    double rateMbps = 0;            // 成员速率之和 (未乘 demandScale)
+    double startSec = 0;            // 成员中最早的开始时刻
+    double endSec = 0;              // 成员中最晚的结束时刻
+};
+
+// 只对有路径的需求分组；enabled 为 false 时每条需求单独成组，组的顺序与 g_demands 一致
+std::vector<DemandGroup> AggregateDemands(const DemandPaths& paths, bool enabled, double toleranceSec);
+
+// 成员的 demandId 列表，以 ';' 分隔
+std::string GroupDemandIds(const DemandGroup& group);
+
+// 平滑加权轮询 (nginx 算法)：任意前缀中各成员的选中次数与权重成比例，偏差不超过 1
+class WeightedRoundRobin {
+public:
+    explicit WeightedRoundRobin(const std::vector<double>& weights);
+
+    uint32_t Next();
+
+private:
+    std::vector<double> m_weights;
+    std::vector<double> m_current;
+    double m_total;
+};
+
+#endif // STARLINK_AGGREGATE_H
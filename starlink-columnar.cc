@@ -0,0 +1,143 @@
+#include "starlink-columnar.h"
+
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+namespace {
+
+const char kMagic[8] = {'S', 'L', 'C', 'O', 'L', '0', '0', '1'};
+const char kEndMagic[8] = {'S', 'L', 'C', 'O', 'L', 'E', 'N', 'D'};
+
+template <typename T>
+void WritePod(std::ofstream& out, T v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+} // namespace
+
+// ==================== 写出 ====================
+
+ColumnarWriter::~ColumnarWriter() {
+    Close();
+}
+
+bool ColumnarWriter::Open(const std::string& file, const std::vector<std::pair<std::string, Type>>& columns,
+                          bool compress, uint32_t blockRows) {
+    Close();
+    m_buffer.resize(1 << 20);
+    m_out.rdbuf()->pubsetbuf(m_buffer.data(), m_buffer.size());
+    m_out.open(file.c_str(), std::ios::binary | std::ios::trunc);
+    if (!m_out.is_open()) {
+        std::cerr << "❌ 无法创建列式结果文件: " << file << std::endl;
+        return false;
+    }
+    m_out.write(kMagic, 8);
+    WritePod<uint32_t>(m_out, columns.size());
+    m_types.clear();
+    for (const auto& [name, type] : columns) {
+        WritePod<uint8_t>(m_out, type);
+        WritePod<uint16_t>(m_out, name.size());
+        m_out.write(name.data(), name.size());
+        m_types.push_back(type);
+    }
+    m_columns.assign(columns.size(), std::vector<uint8_t>());
+    m_dictIndex.clear();
+    m_dict.clear();
+    m_compress = compress && ZlibAvailable();
+    m_blockRows = blockRows ? blockRows : 1;
+    m_rows = m_blocks = m_cursor = 0;
+    m_totalRows = 0;
+    return true;
+}
+
+ColumnarWriter& ColumnarWriter::Put(Type type, const void* data, size_t bytes) {
+    if (m_cursor >= m_types.size() || m_types[m_cursor] != type) {
+        std::cerr << "❌ 列式结果第 " << m_cursor << " 列类型不符" << std::endl;
+        return *this;
+    }
+    std::vector<uint8_t>& col = m_columns[m_cursor++];
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    col.insert(col.end(), p, p + bytes);
+    return *this;
+}
+
+ColumnarWriter& ColumnarWriter::Str(const std::string& v) {
+    auto it = m_dictIndex.find(v);
+    uint32_t code;
+    if (it != m_dictIndex.end()) {
+        code = it->second;
+    } else {
+        code = static_cast<uint32_t>(m_dict.size());
+        m_dictIndex.emplace(v, code);
+        m_dict.push_back(v);
+    }
+    return Put(String, &code, 4);
+}
+
+void ColumnarWriter::EndRow() {
+    m_cursor = 0;
+    m_totalRows++;
+    if (++m_rows >= m_blockRows) WriteBlock();
+}
+
+void ColumnarWriter::WriteBlock() {
+    if (m_rows == 0) return;
+    if (!m_compress) {
+        WriteColumns(m_rows, m_columns);
+    } else {
+        // 整块移交后台线程；各列换成同样容量的新缓冲区继续填
+        size_t bytes = 0;
+        auto columns = std::make_shared<std::vector<std::vector<uint8_t>>>(std::move(m_columns));
+        m_columns.assign(columns->size(), std::vector<uint8_t>());
+        for (size_t i = 0; i < columns->size(); ++i) {
+            bytes += (*columns)[i].size();
+            m_columns[i].reserve((*columns)[i].size());
+        }
+        uint32_t rows = m_rows;
+        m_queue.Submit([this, columns, rows] { WriteColumns(rows, *columns); }, bytes);
+    }
+    m_rows = 0;
+    m_blocks++;
+}
+
+void ColumnarWriter::WriteColumns(uint32_t rows, std::vector<std::vector<uint8_t>>& columns) {
+    WritePod<uint32_t>(m_out, rows);
+    for (auto& col : columns) {
+        uint8_t codec = 0;
+        const uint8_t* data = col.data();
+        size_t stored = col.size();
+        // 压缩后不更小的段按原样存储
+        if (m_compress && !col.empty() && ZlibCompress(col.data(), col.size(), m_packed) &&
+            m_packed.size() < col.size()) {
+            codec = 1;
+            data = m_packed.data();
+            stored = m_packed.size();
+        }
+        WritePod<uint8_t>(m_out, codec);
+        WritePod<uint32_t>(m_out, col.size());
+        WritePod<uint32_t>(m_out, stored);
+        m_out.write(reinterpret_cast<const char*>(data), stored);
+        col.clear();
+    }
+}
+
+bool ColumnarWriter::Close() {
+    if (!m_out.is_open()) return false;
+    WriteBlock();
+    m_queue.Wait();
+    uint64_t footer = static_cast<uint64_t>(m_out.tellp());
+    WritePod<uint32_t>(m_out, m_dict.size());
+    for (const std::string& s : m_dict) {
+        WritePod<uint16_t>(m_out, s.size());
+        m_out.write(s.data(), s.size());
+    }
+    WritePod<uint32_t>(m_out, m_blocks);
+    WritePod<uint64_t>(m_out, footer);
+    m_out.write(kEndMagic, 8);
+    bool ok = m_out.good();
+    m_out.close();
+    m_dictIndex.clear();
+    m_dict.clear();
+    return ok;
+}
@@ -0,0 +1,67 @@
+#ifndef STARLINK_COLUMNAR_H
+#define STARLINK_COLUMNAR_H
+
+// starlink-columnar.h - 自描述的列式二进制结果格式 (.slcol)
+// 按行追加、按列缓存，每 blockRows 行写出一个块，块内每列一段连续的定长数组，
+// 可选逐段 zlib 压缩 (starlink-zstream.h，找不到 libz 时写未压缩段)；压缩时整块交给
+// 后台写线程压缩并写盘，调用方只做内存拷贝。字符串列写成全文件共享
+// 字典的 uint32 编号，字典在文件尾。所有整数小端。
+//
+//   文件头  "SLCOL001" | u32 列数 | 每列: u8 类型, u16 名字长度, 名字
+//   块      u32 行数 | 每列: u8 编码(0 原始, 1 zlib), u32 原始字节数, u32 存储字节数, 数据
+//   文件尾  u32 字典项数 | 每项: u16 长度, 字节 | u32 块数 | u64 文件尾偏移 | "SLCOLEND"
+//
+// 读取方 (starlink_columnar.py) 先读末尾 20 字节定位字典，再按块把各列拼成数组。
+
+#include "starlink-zstream.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class ColumnarWriter {
+public:
+    enum Type : uint8_t { Int64 = 0, UInt64 = 1, Float64 = 2, String = 3 };
+
+    ~ColumnarWriter();
+
+    bool Open(const std::string& file, const std::vector<std::pair<std::string, Type>>& columns, bool compress,
+              uint32_t blockRows = 65536);
+    // 写出剩余行和字典
+    bool Close();
+    bool IsOpen() const { return m_out.is_open(); }
+
+    // 按列顺序填一行，EndRow 结束；缺失的浮点值填 NaN
+    ColumnarWriter& Int(int64_t v) { return Put(Int64, &v, 8); }
+    ColumnarWriter& UInt(uint64_t v) { return Put(UInt64, &v, 8); }
+    ColumnarWriter& Float(double v) { return Put(Float64, &v, 8); }
+    ColumnarWriter& Str(const std::string& v);
+    void EndRow();
+
+    uint64_t Rows() const { return m_totalRows; }
+
+private:
+    ColumnarWriter& Put(Type type, const void* data, size_t bytes);
+    void WriteBlock();
+    void WriteColumns(uint32_t rows, std::vector<std::vector<uint8_t>>& columns);
+
+    std::ofstream m_out;
+    std::vector<char> m_buffer;                     // 文件流缓冲区
+    std::vector<Type> m_types;
+    std::vector<std::vector<uint8_t>> m_columns;    // 当前块各列的原始字节
+    std::vector<uint8_t> m_packed;                 // 压缩时只由后台线程使用
+    std::unordered_map<std::string, uint32_t> m_dictIndex;
+    std::vector<std::string> m_dict;
+    bool m_compress = false;
+    uint32_t m_blockRows = 65536;
+    uint32_t m_rows = 0;            // 当前块的行数
+    uint32_t m_blocks = 0;
+    uint32_t m_cursor = 0;          // 当前行下一个要填的列
+    uint64_t m_totalRows = 0;
+    WriteQueue m_queue;         // 压缩块的后台写任务；写 m_out 前先 Wait
+};
+
+#endif // STARLINK_COLUMNAR_H
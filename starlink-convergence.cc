@@ -0,0 +1,230 @@
+#include "starlink-convergence.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// ==================== 统计工具 ====================
+
+// Acklam 有理函数近似，相对误差约 1e-9
+static double NormalQuantile(double p) {
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+    const double pLow = 0.02425;
+    if (p <= 0) return -std::numeric_limits<double>::infinity();
+    if (p >= 1) return std::numeric_limits<double>::infinity();
+    if (p < pLow) {
+        double q = std::sqrt(-2 * std::log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+    if (p > 1 - pLow) return -NormalQuantile(1 - p);
+    double q = p - 0.5, r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+// 正则化不完全 beta 函数 I_x(a, b)，连分式用修正 Lentz 法求值
+static double IncompleteBeta(double a, double b, double x) {
+    if (x <= 0) return 0;
+    if (x >= 1) return 1;
+    // 连分式在 x < (a + 1) / (a + b + 2) 时收敛快，否则用 I_x(a, b) = 1 - I_{1-x}(b, a)
+    if (x > (a + 1) / (a + b + 2)) return 1 - IncompleteBeta(b, a, 1 - x);
+    const double tiny = 1e-300;
+    double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) +
+                            a * std::log(x) + b * std::log1p(-x)) / a;
+    double c = 1, d = 1 - (a + b) * x / (a + 1);
+    if (std::fabs(d) < tiny) d = tiny;
+    d = 1 / d;
+    double f = d;
+    for (int m = 1; m <= 300; ++m) {
+        for (int odd = 0; odd < 2; ++odd) {
+            double num = odd ? -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1))
+                             : m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+            d = 1 + num * d;
+            if (std::fabs(d) < tiny) d = tiny;
+            c = 1 + num / c;
+            if (std::fabs(c) < tiny) c = tiny;
+            d = 1 / d;
+            f *= c * d;
+        }
+        if (std::fabs(c * d - 1) < 1e-15) break;
+    }
+    return front * f;
+}
+
+static double StudentTCdf(double t, double df) {
+    double tail = 0.5 * IncompleteBeta(df / 2, 0.5, df / (df + t * t));
+    return t >= 0 ? 1 - tail : tail;
+}
+
+static double StudentTPdf(double t, double df) {
+    return std::exp(std::lgamma((df + 1) / 2) - std::lgamma(df / 2) - (df + 1) / 2 * std::log1p(t * t / df)) /
+           std::sqrt(df * M_PI);
+}
+
+// df = 1、2 用闭式解；其余以 Cornish-Fisher 展开为初值，在精确 CDF 上做 Newton 迭代
+double StudentTQuantile(double p, double df) {
+    if (df <= 0 || std::isinf(df)) return NormalQuantile(p);
+    if (p <= 0) return -std::numeric_limits<double>::infinity();
+    if (p >= 1) return std::numeric_limits<double>::infinity();
+    if (p < 0.5) return -StudentTQuantile(1 - p, df);
+    if (df == 1) return std::tan(M_PI * (p - 0.5));
+    if (df == 2) return (2 * p - 1) / std::sqrt(2 * p * (1 - p));
+
+    double z = NormalQuantile(p);
+    double z2 = z * z, z3 = z2 * z, z5 = z3 * z2, z7 = z5 * z2, z9 = z7 * z2;
+    double t = z + (z3 + z) / (4 * df)
+                 + (5 * z5 + 16 * z3 + 3 * z) / (96 * df * df)
+                 + (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / (384 * df * df * df)
+                 + (79 * z9 + 776 * z7 + 1482 * z5 - 1920 * z3 - 945 * z) / (92160 * df * df * df * df);
+    // t >= 0 时 CDF 为凹函数，Newton 迭代从第一步起单调收敛
+    for (int i = 0; i < 50; ++i) {
+        double step = (StudentTCdf(t, df) - p) / StudentTPdf(t, df);
+        t -= step;
+        if (std::fabs(step) <= 1e-12 * std::max(1.0, std::fabs(t))) break;
+    }
+    return t;
+}
+
+uint32_t MserTruncation(const std::vector<double>& x) {
+    size_t n = x.size();
+    if (n < 4) return 0;
+    // 从尾部累加，O(n) 求出每个截断点之后的方差和
+    double sum = 0, sumSq = 0;
+    std::vector<double> stat(n, 0);
+    for (size_t i = n; i-- > 0;) {
+        sum += x[i];
+        sumSq += x[i] * x[i];
+        double k = static_cast<double>(n - i);
+        stat[i] = std::max(0.0, sumSq - sum * sum / k) / (k * k);
+    }
+    size_t best = 0;
+    for (size_t d = 1; d <= n / 2; ++d) {
+        if (stat[d] < stat[best]) best = d;
+    }
+    return static_cast<uint32_t>(best);
+}
+
+static double Lag1Autocorrelation(const std::vector<double>& x, double mean) {
+    double num = 0, den = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        den += (x[i] - mean) * (x[i] - mean);
+        if (i + 1 < x.size()) num += (x[i] - mean) * (x[i + 1] - mean);
+    }
+    return den > 0 ? num / den : 0;
+}
+
+ConfidenceInterval BatchMeansCI(const std::vector<double>& x, double confidence,
+                                uint32_t minBatches, double maxLag1) {
+    ConfidenceInterval ci;
+    std::vector<double> batches = x;
+    uint32_t batchSize = 1;
+    while (batches.size() >= std::max<uint32_t>(minBatches, 2)) {
+        double sum = 0;
+        for (double v : batches) sum += v;
+        double k = static_cast<double>(batches.size());
+        double mean = sum / k;
+        double lag1 = Lag1Autocorrelation(batches, mean);
+
+        ci.mean = mean;
+        ci.batches = static_cast<uint32_t>(batches.size());
+        ci.batchSize = batchSize;
+        ci.lag1 = lag1;
+        if (lag1 <= maxLag1) {
+            double var = 0;
+            for (double v : batches) var += (v - mean) * (v - mean);
+            var /= (k - 1);
+            ci.halfWidth = StudentTQuantile(0.5 + confidence / 2, k - 1) * std::sqrt(var / k);
+            ci.relHalfWidth = mean != 0 ? ci.halfWidth / std::fabs(mean)
+                                        : (ci.halfWidth > 0 ? std::numeric_limits<double>::infinity() : 0);
+            ci.valid = true;
+            return ci;
+        }
+        // 相关性过高：相邻两批合并，奇数个时丢弃最早的一批
+        std::vector<double> merged;
+        for (size_t i = batches.size() % 2; i + 1 < batches.size(); i += 2) {
+            merged.push_back((batches[i] + batches[i + 1]) / 2);
+        }
+        batches.swap(merged);
+        batchSize *= 2;
+    }
+    return ci;
+}
+
+// ==================== 收敛监视器 ====================
+
+ConvergenceMonitor::ConvergenceMonitor(double relPrecision, double confidence, uint32_t minBatches)
+    : m_relPrecision(relPrecision),
+      m_confidence(confidence),
+      m_minBatches(std::max<uint32_t>(minBatches, 2)),
+      m_maxLag1(0.1),
+      m_numBatches(0),
+      m_warmup(0),
+      m_nextEval(0),
+      m_batchThroughput(0),
+      m_batchDelaySum(0),
+      m_batchPackets(0) {}
+
+void ConvergenceMonitor::BeginBatch() {
+    m_batchThroughput = 0;
+    m_batchDelaySum = 0;
+    m_batchPackets = 0;
+}
+
+void ConvergenceMonitor::AddThroughput(uint32_t flow, double mbps) {
+    Series& s = m_flows[flow].throughput;
+    s.batch.push_back(m_numBatches);
+    s.value.push_back(mbps);
+    m_batchThroughput += mbps;
+}
+
+void ConvergenceMonitor::AddDelay(uint32_t flow, double meanMs, uint64_t packets) {
+    if (packets == 0) return;
+    Series& s = m_flows[flow].delay;
+    s.batch.push_back(m_numBatches);
+    s.value.push_back(meanMs);
+    m_batchDelaySum += meanMs * packets;
+    m_batchPackets += packets;
+}
+
+void ConvergenceMonitor::EndBatch() {
+    m_totalThroughput.push_back(m_batchThroughput);
+    // 没有收到分组的批沿用上一批的总体时延，避免 0 值干扰截断点
+    double delay = m_batchPackets ? m_batchDelaySum / m_batchPackets
+                                  : (m_totalDelay.empty() ? 0 : m_totalDelay.back());
+    m_totalDelay.push_back(delay);
+    m_numBatches++;
+}
+
+ConfidenceInterval ConvergenceMonitor::SeriesCI(const Series& s) const {
+    auto first = std::lower_bound(s.batch.begin(), s.batch.end(), m_warmup);
+    std::vector<double> x(s.value.begin() + (first - s.batch.begin()), s.value.end());
+    return BatchMeansCI(x, m_confidence, m_minBatches, m_maxLag1);
+}
+
+void ConvergenceMonitor::Evaluate(bool force) {
+    if (!force && m_numBatches < m_nextEval) return;
+    m_nextEval = std::max(m_numBatches + 1, static_cast<uint32_t>(m_numBatches * 1.05));
+
+    m_warmup = std::max(MserTruncation(m_totalThroughput), MserTruncation(m_totalDelay));
+    for (auto& entry : m_flows) {
+        FlowSeries& f = entry.second;
+        f.estimate.throughput = SeriesCI(f.throughput);
+        f.estimate.delay = SeriesCI(f.delay);
+        f.estimate.converged = f.estimate.throughput.valid && f.estimate.delay.valid
+                            && f.estimate.throughput.relHalfWidth <= m_relPrecision
+                            && f.estimate.delay.relHalfWidth <= m_relPrecision;
+    }
+}
+
+FlowEstimate ConvergenceMonitor::GetEstimate(uint32_t flow) const {
+    auto it = m_flows.find(flow);
+    return it != m_flows.end() ? it->second.estimate : FlowEstimate();
+}
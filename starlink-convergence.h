@@ -0,0 +1,96 @@
+#ifndef STARLINK_CONVERGENCE_H
+#define STARLINK_CONVERGENCE_H
+
+// starlink-convergence.h - 稳态检测与批均值置信区间
+// 仿真按固定的仿真时间间隔切成批 (batch)，每批记录各流的吞吐量和平均时延。
+// 预热期由 MSER 在网络总吞吐 / 总平均时延序列上确定 (取两者中较晚的截断点)，
+// 截断之后的批均值用于估计各流的稳态均值及其 Student-t 置信区间；
+// 相邻批均值的一阶自相关过高时两两合并批次，直到近似独立或批数不足。
+// 所有需要判断的流的相对半宽都低于阈值时视为收敛，starlink-sim 据此提前结束仿真。
+// bench/check_stats 单独编译本模块对照 t 分布表，不能引入 ns-3 头文件。
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// ==================== 统计工具 ====================
+
+struct ConfidenceInterval {
+    double mean = 0;
+    double halfWidth = 0;
+    double relHalfWidth = 0;    // halfWidth / |mean|，mean 为 0 时为无穷大
+    uint32_t batches = 0;       // 合并后的批数
+    uint32_t batchSize = 1;     // 每个合并批包含的原始批数
+    double lag1 = 0;            // 合并后批均值的一阶自相关
+    bool valid = false;         // 批数不足或自相关无法消除时为 false
+};
+
+// Student t 分布的 p 分位数 (df = 1、2 为闭式解，其余在精确 CDF 上 Newton 迭代，相对误差约 1e-12)
+double StudentTQuantile(double p, double df);
+
+// MSER 截断点：使截断后序列均值的标准误最小的起始下标 (只在前一半中搜索)
+uint32_t MserTruncation(const std::vector<double>& x);
+
+ConfidenceInterval BatchMeansCI(const std::vector<double>& x, double confidence,
+                                uint32_t minBatches, double maxLag1);
+
+// ==================== 收敛监视器 ====================
+
+struct FlowEstimate {
+    ConfidenceInterval throughput;  // Mbps
+    ConfidenceInterval delay;       // ms
+    bool converged = false;
+};
+
+class ConvergenceMonitor {
+public:
+    ConvergenceMonitor(double relPrecision, double confidence, uint32_t minBatches);
+
+    // 每批：BeginBatch，然后对本批中活跃的流调用 AddThroughput / AddDelay，最后 EndBatch
+    void BeginBatch();
+    void AddThroughput(uint32_t flow, double mbps);
+    void AddDelay(uint32_t flow, double meanMs, uint64_t packets);
+    void EndBatch();
+
+    // 重新确定预热期并更新各流估计；批数增长不足 5% 时直接沿用上次的结果 (force 除外)
+    void Evaluate(bool force = false);
+
+    uint32_t GetNumBatches() const { return m_numBatches; }
+    uint32_t GetWarmupBatches() const { return m_warmup; }
+    bool HasFlow(uint32_t flow) const { return m_flows.count(flow) > 0; }
+    // Evaluate 之后的估计
+    FlowEstimate GetEstimate(uint32_t flow) const;
+
+private:
+    struct Series {
+        std::vector<uint32_t> batch;
+        std::vector<double> value;
+    };
+    struct FlowSeries {
+        Series throughput;
+        Series delay;
+        FlowEstimate estimate;
+    };
+
+    ConfidenceInterval SeriesCI(const Series& s) const;
+
+    double m_relPrecision;
+    double m_confidence;
+    uint32_t m_minBatches;
+    double m_maxLag1;
+
+    uint32_t m_numBatches;
+    uint32_t m_warmup;
+    uint32_t m_nextEval;
+
+    // 当前批的网络总量
+    double m_batchThroughput;
+    double m_batchDelaySum;
+    uint64_t m_batchPackets;
+
+    std::vector<double> m_totalThroughput;
+    std::vector<double> m_totalDelay;
+    std::map<uint32_t, FlowSeries> m_flows;
+};
+
+#endif // STARLINK_CONVERGENCE_H
@@ -0,0 +1,140 @@
+#include "starlink-flightrec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// ==================== 分组环 ====================
+
+void PacketRing::Init(uint32_t capacity, uint32_t snapLen) {
+    capacity = std::max<uint32_t>(capacity, 1);
+    m_snapLen = snapLen;
+    m_data.assign(static_cast<size_t>(capacity) * snapLen, 0);
+    m_time.assign(capacity, 0);
+    m_origLen.assign(capacity, 0);
+    m_capLen.assign(capacity, 0);
+    m_next = 0;
+}
+
+uint8_t* PacketRing::Push(int64_t timeNs, uint32_t origLen, uint32_t capLen) {
+    size_t slot = m_next++ % m_time.size();
+    m_time[slot] = timeNs;
+    m_origLen[slot] = origLen;
+    m_capLen[slot] = std::min(capLen, m_snapLen);
+    return &m_data[slot * m_snapLen];
+}
+
+void PacketRing::Collect(int64_t sinceNs, std::vector<Entry>& out) const {
+    uint64_t capacity = m_time.size();
+    uint64_t first = m_next > capacity ? m_next - capacity : 0;
+    for (uint64_t i = first; i < m_next; ++i) {
+        size_t slot = i % capacity;
+        if (m_time[slot] < sinceNs) continue;
+        out.push_back({m_time[slot], m_origLen[slot], m_capLen[slot], &m_data[slot * m_snapLen]});
+    }
+}
+
+// ==================== 飞行记录仪 ====================
+
+bool FlightRecorder::Init(size_t directions, const FlightRecorderConfig& config, const std::string& outDir) {
+    m_config = config;
+    m_config.dropBurst = std::max<uint32_t>(m_config.dropBurst, 1);
+    m_outDir = outDir;
+    m_rings.assign(directions, PacketRing());
+    for (auto& ring : m_rings) ring.Init(m_config.ringPackets, m_config.snapLen);
+    m_queueDropTimes.assign(directions * m_config.dropBurst, INT64_MIN);
+    m_phyDropTimes.assign(directions * m_config.dropBurst, INT64_MIN);
+    m_queueDropNext.assign(directions, 0);
+    m_phyDropNext.assign(directions, 0);
+    m_lastTrigger.assign(directions, INT64_MIN);
+    m_dumps = 0;
+    m_triggers = 0;
+
+    m_index.open((outDir + "/flightrec_index.csv").c_str());
+    if (!m_index.is_open()) {
+        std::cerr << "❌ 无法创建飞行记录索引: " << outDir << "/flightrec_index.csv" << std::endl;
+        return false;
+    }
+    m_index << "File,Time_s,Reason,Link,Directions,Packets\n";
+    return true;
+}
+
+void FlightRecorder::Close() {
+    if (m_index.is_open()) m_index.close();
+}
+
+bool FlightRecorder::Ready(uint32_t dir, int64_t timeNs) const {
+    if (m_dumps >= m_config.maxDumps) return false;
+    return m_lastTrigger[dir] == INT64_MIN || timeNs - m_lastTrigger[dir] >= m_config.cooldownMs * 1e6;
+}
+
+bool FlightRecorder::OnDrop(Reason reason, uint32_t dir, int64_t timeNs) {
+    std::vector<int64_t>& times = reason == PhyDrops ? m_phyDropTimes : m_queueDropTimes;
+    std::vector<uint32_t>& next = reason == PhyDrops ? m_phyDropNext : m_queueDropNext;
+    uint32_t k = m_config.dropBurst;
+    int64_t* ring = &times[static_cast<size_t>(dir) * k];
+    // 环中下一个位置即最近 k 次中最早的一次
+    uint32_t slot = next[dir];
+    ring[slot] = timeNs;
+    next[dir] = (slot + 1) % k;
+    int64_t oldest = ring[next[dir]];
+    if (oldest == INT64_MIN || timeNs - oldest > m_config.burstWindowMs * 1e6) return false;
+    return Ready(dir, timeNs);
+}
+
+bool FlightRecorder::OnQueueDelay(uint32_t dir, int64_t timeNs, double delayMs) {
+    return m_config.delayMs > 0 && delayMs > m_config.delayMs && Ready(dir, timeNs);
+}
+
+bool FlightRecorder::Dump(Reason reason, uint32_t dir, int64_t timeNs, const std::vector<uint32_t>& dirs,
+                          const std::string& label) {
+    m_lastTrigger[dir] = timeNs;
+    m_triggers++;
+    std::vector<PacketRing::Entry> packets;
+    int64_t since = timeNs - static_cast<int64_t>(m_config.windowMs * 1e6);
+    for (uint32_t d : dirs) {
+        if (d < m_rings.size()) m_rings[d].Collect(since, packets);
+    }
+    std::stable_sort(packets.begin(), packets.end(),
+                     [](const PacketRing::Entry& a, const PacketRing::Entry& b) { return a.timeNs < b.timeNs; });
+
+    static const char* kReasons[] = {"queue_drops", "phy_drops", "delay_spike"};
+    std::ostringstream name;
+    name << "flightrec_" << std::setw(3) << std::setfill('0') << m_dumps << "_" << kReasons[reason] << ".pcap";
+    if (!WritePcap(m_outDir + "/" + name.str(), packets)) return false;
+    m_dumps++;
+    m_index << name.str() << "," << std::fixed << std::setprecision(9) << timeNs / 1e9 << "," << kReasons[reason]
+            << "," << label << "," << dirs.size() << "," << packets.size() << "\n";
+    m_index.flush();
+    return true;
+}
+
+// ==================== pcap ====================
+
+bool WritePcap(const std::string& file, const std::vector<PacketRing::Entry>& packets) {
+    std::ofstream out(file.c_str(), std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "❌ 无法创建 pcap 文件: " << file << std::endl;
+        return false;
+    }
+    uint32_t magic = 0xa1b23c4d;    // 纳秒精度
+    uint16_t major = 2, minor = 4;
+    int32_t zone = 0;
+    uint32_t sigfigs = 0, snaplen = 65535, linkType = 101;
+    out.write(reinterpret_cast<const char*>(&magic), 4);
+    out.write(reinterpret_cast<const char*>(&major), 2);
+    out.write(reinterpret_cast<const char*>(&minor), 2);
+    out.write(reinterpret_cast<const char*>(&zone), 4);
+    out.write(reinterpret_cast<const char*>(&sigfigs), 4);
+    out.write(reinterpret_cast<const char*>(&snaplen), 4);
+    out.write(reinterpret_cast<const char*>(&linkType), 4);
+    for (const auto& p : packets) {
+        uint32_t rec[4] = {static_cast<uint32_t>(p.timeNs / 1000000000), static_cast<uint32_t>(p.timeNs % 1000000000),
+                           p.capLen, p.origLen};
+        out.write(reinterpret_cast<const char*>(rec), sizeof(rec));
+        out.write(reinterpret_cast<const char*>(p.data), p.capLen);
+    }
+    return out.good();
+}
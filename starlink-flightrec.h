@@ -0,0 +1,97 @@
+#ifndef STARLINK_FLIGHTREC_H
+#define STARLINK_FLIGHTREC_H
+
+// starlink-flightrec.h - 丢包触发的飞行记录仪
+// 每个链路方向一个固定容量的环形缓冲区，保存最近 capacity 个分组的前 snapLen 字节
+// (IP 头起) 及时间戳和原长，平时只有一次定长拷贝，内存为 方向数 x capacity x snapLen。
+// 触发条件 (队列丢包突发、误码丢包突发、排队时延尖峰) 满足时，把受影响方向及经过它的
+// 需求路径上所有方向最近 windowMs 内的分组按时间合并写成一个 pcap (LINKTYPE_RAW，纳秒
+// 时间戳)，并在 flightrec_index.csv 中登记。同一方向在冷却期内不重复触发，总转储数有上限。
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct FlightRecorderConfig {
+    uint32_t ringPackets = 1024;    // 每个方向保留的分组数
+    uint32_t snapLen = 64;          // 每个分组保存的字节数
+    double windowMs = 50;           // 转储触发前多长时间内的分组
+    uint32_t dropBurst = 10;        // burstWindowMs 内达到该丢包数即触发
+    double burstWindowMs = 10;
+    double delayMs = 0;             // 排队时延超过该值触发，0 表示不检测
+    double cooldownMs = 100;        // 同一方向两次触发的最小间隔
+    uint32_t maxDumps = 20;
+};
+
+// 固定容量的分组环
+class PacketRing {
+public:
+    void Init(uint32_t capacity, uint32_t snapLen);
+
+    // 返回本次记录的数据区 (snapLen 字节)，调用方填入前 capLen 字节
+    uint8_t* Push(int64_t timeNs, uint32_t origLen, uint32_t capLen);
+
+    struct Entry {
+        int64_t timeNs;
+        uint32_t origLen;
+        uint32_t capLen;
+        const uint8_t* data;
+    };
+    // 追加时间不早于 sinceNs 的记录 (按记录顺序)
+    void Collect(int64_t sinceNs, std::vector<Entry>& out) const;
+
+private:
+    std::vector<uint8_t> m_data;
+    std::vector<int64_t> m_time;
+    std::vector<uint32_t> m_origLen;
+    std::vector<uint32_t> m_capLen;
+    uint32_t m_snapLen = 0;
+    uint64_t m_next = 0;        // 已写入的总数
+};
+
+class FlightRecorder {
+public:
+    enum Reason { QueueDrops, PhyDrops, DelaySpike };
+
+    bool Init(size_t directions, const FlightRecorderConfig& config, const std::string& outDir);
+    void Close();
+
+    uint8_t* Record(uint32_t dir, int64_t timeNs, uint32_t origLen, uint32_t capLen) {
+        return m_rings[dir].Push(timeNs, origLen, capLen);
+    }
+    uint32_t SnapLen() const { return m_config.snapLen; }
+
+    // 记录一次丢包，返回该方向是否构成突发且不在冷却期
+    bool OnDrop(Reason reason, uint32_t dir, int64_t timeNs);
+    // 排队时延检测，返回是否应触发
+    bool OnQueueDelay(uint32_t dir, int64_t timeNs, double delayMs);
+
+    // 把 dirs 中各方向的窗口内分组合并写成 pcap；label 用于索引文件
+    bool Dump(Reason reason, uint32_t dir, int64_t timeNs, const std::vector<uint32_t>& dirs,
+              const std::string& label);
+
+    uint32_t Dumps() const { return m_dumps; }
+    uint64_t Triggers() const { return m_triggers; }
+
+private:
+    bool Ready(uint32_t dir, int64_t timeNs) const;
+
+    FlightRecorderConfig m_config;
+    std::string m_outDir;
+    std::vector<PacketRing> m_rings;
+    // 每个方向最近 dropBurst 次丢包的时刻 (环形)，两类丢包分开统计
+    std::vector<int64_t> m_queueDropTimes;
+    std::vector<int64_t> m_phyDropTimes;
+    std::vector<uint32_t> m_queueDropNext;
+    std::vector<uint32_t> m_phyDropNext;
+    std::vector<int64_t> m_lastTrigger;
+    std::ofstream m_index;
+    uint32_t m_dumps = 0;
+    uint64_t m_triggers = 0;
+};
+
+// 纳秒时间戳、LINKTYPE_RAW 的 libpcap 文件
+bool WritePcap(const std::string& file, const std::vector<PacketRing::Entry>& packets);
+
+#endif // STARLINK_FLIGHTREC_H
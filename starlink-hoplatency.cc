@@ -0,0 +1,73 @@
+#include "starlink-hoplatency.h"
+#include "starlink-zstream.h"
+
+#include <algorithm>
+#include <iomanip>
+
+void HopLatencyStats::Init(size_t directions, size_t flows) {
+    m_links.assign(directions, LinkAcc());
+    m_flows.assign(flows, FlowAcc());
+    m_samples = 0;
+}
+
+void HopLatencyStats::AddPacket(uint32_t flow, std::vector<HopRecord>& hops, int64_t rxNs, uint32_t ipBytes,
+                                const std::vector<uint64_t>& rateBps, const std::vector<int64_t>& delayNs) {
+    if (hops.empty() || flow >= m_flows.size()) return;
+    std::sort(hops.begin(), hops.end(),
+              [](const HopRecord& a, const HopRecord& b) { return a.enqueueNs < b.enqueueNs; });
+    FlowAcc& fa = m_flows[flow];
+    for (size_t h = 0; h < hops.size(); ++h) {
+        const HopRecord& hop = hops[h];
+        if (hop.direction >= m_links.size()) continue;
+        double serialization = rateBps[hop.direction] ? (ipBytes + 2) * 8e9 / rateBps[hop.direction] : 0;
+        double propagation = static_cast<double>(delayNs[hop.direction]);
+
+        LinkAcc& la = m_links[hop.direction];
+        la.samples++;
+        la.queueNs += hop.waitNs;
+        la.serializationNs += serialization;
+        la.propagationNs += propagation;
+        la.maxQueueNs = std::max(la.maxQueueNs, static_cast<double>(hop.waitNs));
+
+        fa.queueNs += hop.waitNs;
+        fa.serializationNs += serialization;
+        fa.propagationNs += propagation;
+    }
+    fa.samples++;
+    fa.hops += hops.size();
+    fa.delayNs += rxNs - hops.front().enqueueNs;
+    m_samples++;
+}
+
+bool HopLatencyStats::WriteLinks(const std::string& file, const std::vector<std::string>& labels,
+                                 bool compress) const {
+    OutputFile f;
+    if (!f.Open(file, compress)) return false;
+    f << "Link,Samples,Queueing_ms,Serialization_ms,Propagation_ms,MaxQueueing_ms\n";
+    f << std::fixed << std::setprecision(6);
+    for (size_t d = 0; d < m_links.size() && d < labels.size(); ++d) {
+        const LinkAcc& la = m_links[d];
+        if (la.samples == 0) continue;
+        double n = la.samples * 1e6;
+        f << labels[d] << "," << la.samples << "," << la.queueNs / n << "," << la.serializationNs / n << ","
+          << la.propagationNs / n << "," << la.maxQueueNs / 1e6 << "\n";
+    }
+    return f.Close();
+}
+
+bool HopLatencyStats::WriteFlows(const std::string& file, const std::vector<std::string>& labels,
+                                 bool compress) const {
+    OutputFile f;
+    if (!f.Open(file, compress)) return false;
+    f << "DemandId,Samples,MeanHops,Delay_ms,Queueing_ms,Serialization_ms,Propagation_ms\n";
+    f << std::fixed << std::setprecision(6);
+    for (size_t i = 0; i < m_flows.size() && i < labels.size(); ++i) {
+        const FlowAcc& fa = m_flows[i];
+        if (fa.samples == 0) continue;
+        double n = fa.samples * 1e6;
+        f << labels[i] << "," << fa.samples << "," << static_cast<double>(fa.hops) / fa.samples << ","
+          << fa.delayNs / n << "," << fa.queueNs / n << "," << fa.serializationNs / n << ","
+          << fa.propagationNs / n << "\n";
+    }
+    return f.Close();
+}
@@ -0,0 +1,59 @@
+#ifndef STARLINK_HOPLATENCY_H
+#define STARLINK_HOPLATENCY_H
+
+// starlink-hoplatency.h - 抽样分组的逐跳时延分解
+// 每个抽样分组带回所经各跳的 (链路方向, 进入设备时刻, 排队等待) (见 hop-trace-tag.h)。
+// 设备的 DropTail 队列是唯一的缓冲区 (仿真卸掉了默认队列规则)，进入设备即开始排队。
+// 按进入时刻排序后逐跳分解：
+//   排队     = 等待时长
+//   串行化   = (IP 分组长度 + 2 字节 PPP 头) x 8 / 链路速率
+//   传播     = 链路时延
+// 分别按链路方向和按流累加，内存与抽样数无关。
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct HopRecord {
+    uint32_t direction = 0;
+    int64_t enqueueNs = 0;
+    uint32_t waitNs = 0;
+};
+
+class HopLatencyStats {
+public:
+    void Init(size_t directions, size_t flows);
+
+    // hops 会被就地排序；rxNs 为到达目的节点的时刻，rateBps 与 delayNs 按链路方向
+    void AddPacket(uint32_t flow, std::vector<HopRecord>& hops, int64_t rxNs, uint32_t ipBytes,
+                   const std::vector<uint64_t>& rateBps, const std::vector<int64_t>& delayNs);
+
+    // 标签与 Init 的方向 / 流一一对应；compress 时写分块 gzip (starlink-zstream.h)
+    bool WriteLinks(const std::string& file, const std::vector<std::string>& labels, bool compress = false) const;
+    bool WriteFlows(const std::string& file, const std::vector<std::string>& labels, bool compress = false) const;
+
+    uint64_t Samples() const { return m_samples; }
+
+private:
+    struct LinkAcc {
+        uint64_t samples = 0;
+        double queueNs = 0;
+        double serializationNs = 0;
+        double propagationNs = 0;
+        double maxQueueNs = 0;
+    };
+    struct FlowAcc {
+        uint64_t samples = 0;
+        uint64_t hops = 0;
+        double delayNs = 0;
+        double queueNs = 0;
+        double serializationNs = 0;
+        double propagationNs = 0;
+    };
+
+    std::vector<LinkAcc> m_links;
+    std::vector<FlowAcc> m_flows;
+    uint64_t m_samples = 0;
+};
+
+#endif // STARLINK_HOPLATENCY_H
@@ -0,0 +1,365 @@
+#include "starlink-perf.h"
+#include "starlink-pool.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// ==================== 分配计数 ====================
+// 替换全局 operator new，对整个进程（包括 ns-3 库）的堆分配计数。
+// 分配池启用 (--allocPool) 时先尝试 PoolAlloc，未命中的分配才进入 malloc。
+
+static std::atomic<uint64_t> g_allocCount{0};
+static std::atomic<uint64_t> g_mallocCount{0};
+
+static void* PooledMalloc(std::size_t size) {
+    if (void* p = PoolAlloc(size)) return p;
+    g_mallocCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+static void PooledFree(void* p) {
+    if (p && !PoolFree(p)) std::free(p);
+}
+
+static void* CountedAlloc(std::size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    void* p = PooledMalloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size) { return CountedAlloc(size); }
+void* operator new[](std::size_t size) { return CountedAlloc(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    return PooledMalloc(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    return PooledMalloc(size);
+}
+// std::pmr::new_delete_resource 使用带对齐参数的版本
+static void* CountedAlignedAlloc(std::size_t size, std::size_t align) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    if (align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) return PooledMalloc(size);
+    g_mallocCount.fetch_add(1, std::memory_order_relaxed);
+    return std::aligned_alloc(align, (size + align - 1) / align * align);
+}
+
+void* operator new(std::size_t size, std::align_val_t al) {
+    void* p = CountedAlignedAlloc(size, static_cast<std::size_t>(al));
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](std::size_t size, std::align_val_t al) {
+    void* p = CountedAlignedAlloc(size, static_cast<std::size_t>(al));
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { PooledFree(p); }
+void operator delete[](void* p) noexcept { PooledFree(p); }
+void operator delete(void* p, std::size_t) noexcept { PooledFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { PooledFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { PooledFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { PooledFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { PooledFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { PooledFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { PooledFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { PooledFree(p); }
+
+uint64_t GetAllocationCount() {
+    return g_allocCount.load(std::memory_order_relaxed);
+}
+
+uint64_t GetMallocCount() {
+    return g_mallocCount.load(std::memory_order_relaxed);
+}
+
+// ==================== 资源采样 ====================
+
+static double ClockSeconds(clockid_t id) {
+    timespec ts;
+    clock_gettime(id, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+ResourceSnapshot TakeSnapshot() {
+    ResourceSnapshot s;
+    s.wallSec = ClockSeconds(CLOCK_MONOTONIC);
+    s.cpuSec = ClockSeconds(CLOCK_PROCESS_CPUTIME_ID);
+    s.allocs = GetAllocationCount();
+    s.mallocs = GetMallocCount();
+    return s;
+}
+
+// 优先读取 /proc/self/status 的 VmHWM（可被 ResetPeakRss 清零），否则退回 getrusage
+uint64_t GetPeakRssKb() {
+    std::ifstream f("/proc/self/status");
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::strtoull(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) return static_cast<uint64_t>(ru.ru_maxrss);
+    return 0;
+}
+
+// 向 clear_refs 写 5 重置峰值 RSS，使每个阶段的峰值独立统计（Linux >= 4.0）
+void ResetPeakRss() {
+    FILE* f = std::fopen("/proc/self/clear_refs", "w");
+    if (!f) return;
+    std::fputs("5", f);
+    std::fclose(f);
+}
+
+// ==================== 硬件计数器 ====================
+
+PerfCounterValues PerfCounterValues::operator-(const PerfCounterValues& o) const {
+    PerfCounterValues d;
+    for (int i = 0; i < PERF_NUM_COUNTERS; ++i) {
+        d.valid[i] = valid[i] && o.valid[i];
+        d.value[i] = (d.valid[i] && value[i] >= o.value[i]) ? value[i] - o.value[i] : 0;
+    }
+    return d;
+}
+
+PerfCounters::~PerfCounters() { Close(); }
+
+const char* PerfCounters::GetName(int id) {
+    static const char* names[PERF_NUM_COUNTERS] = {
+        "cycles", "instructions", "llc_misses", "branch_misses", "page_faults"
+    };
+    return (id >= 0 && id < PERF_NUM_COUNTERS) ? names[id] : "unknown";
+}
+
+int PerfCounters::Open() {
+    static const uint32_t types[PERF_NUM_COUNTERS] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+        PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE
+    };
+    static const uint64_t configs[PERF_NUM_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_SW_PAGE_FAULTS
+    };
+    Close();
+    int opened = 0;
+    for (int i = 0; i < PERF_NUM_COUNTERS; ++i) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = types[i];
+        attr.config = configs[i];
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.exclude_kernel = 1;    // perf_event_paranoid=2 时仍可用
+        attr.exclude_hv = 1;
+        attr.inherit = 1;
+        m_fd[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (m_fd[i] >= 0) opened++;
+    }
+    return opened;
+}
+
+void PerfCounters::Close() {
+    for (int i = 0; i < PERF_NUM_COUNTERS; ++i) {
+        if (m_fd[i] >= 0) close(m_fd[i]);
+        m_fd[i] = -1;
+    }
+}
+
+bool PerfCounters::IsOpen() const {
+    for (int i = 0; i < PERF_NUM_COUNTERS; ++i) {
+        if (m_fd[i] >= 0) return true;
+    }
+    return false;
+}
+
+// 计数器被复用 (multiplexing) 时按 enabled/running 时间比例缩放
+PerfCounterValues PerfCounters::Read() const {
+    PerfCounterValues v;
+    for (int i = 0; i < PERF_NUM_COUNTERS; ++i) {
+        if (m_fd[i] < 0) continue;
+        uint64_t buf[3] = {0, 0, 0};
+        if (read(m_fd[i], buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf)) || buf[2] == 0) continue;
+        v.value[i] = (buf[2] < buf[1]) ? static_cast<uint64_t>(buf[0] * (double)buf[1] / buf[2]) : buf[0];
+        v.valid[i] = true;
+    }
+    return v;
+}
+
+// 输出计数器 JSON 字段：原始值、IPC，以及按事件数归一化的缺失次数
+static void WriteCountersJson(std::ostream& f, const PerfCounterValues& c, uint64_t events) {
+    f << "{";
+    bool first = true;
+    for (int i = 0; i < PERF_NUM_COUNTERS; ++i) {
+        if (!c.valid[i]) continue;
+        f << (first ? "" : ", ") << "\"" << PerfCounters::GetName(i) << "\": " << c.value[i];
+        first = false;
+        if (events > 0 && (i == PERF_LLC_MISSES || i == PERF_BRANCH_MISSES)) {
+            f << ", \"" << PerfCounters::GetName(i) << "_per_event\": " << (double)c.value[i] / events;
+        }
+    }
+    if (c.valid[PERF_CYCLES] && c.valid[PERF_INSTRUCTIONS] && c.value[PERF_CYCLES] > 0) {
+        f << (first ? "" : ", ") << "\"ipc\": " << (double)c.value[PERF_INSTRUCTIONS] / c.value[PERF_CYCLES];
+    }
+    f << "}";
+}
+
+// ==================== PhaseProfiler ====================
+
+void PhaseProfiler::Begin(const std::string& name) {
+    if (m_open) End();
+    if (!m_started) {
+        m_begin = TakeSnapshot();
+        m_started = true;
+    }
+    ResetPeakRss();
+    m_phases.push_back(PhaseRecord());
+    m_phases.back().name = name;
+    m_open = true;
+    if (m_counters.IsOpen()) m_startCounters = m_counters.Read();
+    m_start = TakeSnapshot();
+}
+
+PhaseRecord& PhaseProfiler::End() {
+    ResourceSnapshot now = TakeSnapshot();
+    PhaseRecord& rec = m_phases.back();
+    if (!m_open) return rec;
+    if (m_counters.IsOpen()) rec.counters = m_counters.Read() - m_startCounters;
+    rec.wallSec = now.wallSec - m_start.wallSec;
+    rec.cpuSec = now.cpuSec - m_start.cpuSec;
+    rec.allocs = now.allocs - m_start.allocs;
+    rec.peakRssKb = GetPeakRssKb();
+    m_open = false;
+    return rec;
+}
+
+bool PhaseProfiler::EnableCounters() {
+    int opened = m_counters.Open();
+    if (opened == 0) {
+        std::cerr << "Warning: perf_event_open unavailable (check /proc/sys/kernel/perf_event_paranoid), "
+                  << "hardware counters disabled\n";
+        return false;
+    }
+    if (opened < PERF_NUM_COUNTERS) {
+        std::cerr << "Warning: only " << opened << "/" << PERF_NUM_COUNTERS << " perf counters available\n";
+    }
+    return true;
+}
+
+void PhaseProfiler::SampleWindow(double simTimeSec, uint64_t totalEvents) {
+    PerfWindow now;
+    now.simTimeSec = simTimeSec;
+    now.wallSec = TakeSnapshot().wallSec;
+    now.events = totalEvents;
+    if (m_counters.IsOpen()) now.counters = m_counters.Read();
+    if (m_windowStarted) {
+        PerfWindow w;
+        w.simTimeSec = simTimeSec;
+        w.wallSec = now.wallSec - m_lastWindow.wallSec;
+        w.events = now.events - m_lastWindow.events;
+        w.counters = now.counters - m_lastWindow.counters;
+        m_windows.push_back(w);
+    }
+    m_lastWindow = now;
+    m_windowStarted = true;
+}
+
+void PhaseProfiler::AddMetric(const std::string& key, double value) {
+    for (auto& m : m_metrics) {
+        if (m.first == key) { m.second = value; return; }
+    }
+    m_metrics.push_back({key, value});
+}
+
+void PhaseProfiler::Print() const {
+    std::cout << "Phase timing:\n";
+    for (const auto& p : m_phases) {
+        std::cout << "  " << std::left << std::setw(14) << p.name << std::right
+                  << std::fixed << std::setprecision(3)
+                  << " wall=" << p.wallSec << "s"
+                  << " cpu=" << p.cpuSec << "s"
+                  << " rss=" << p.peakRssKb / 1024.0 << "MB"
+                  << " allocs=" << p.allocs;
+        if (p.events > 0 && p.wallSec > 0) {
+            std::cout << " events=" << p.events
+                      << " (" << std::setprecision(0) << p.events / p.wallSec << "/s)";
+        }
+        const PerfCounterValues& c = p.counters;
+        if (c.valid[PERF_CYCLES] && c.valid[PERF_INSTRUCTIONS] && c.value[PERF_CYCLES] > 0) {
+            std::cout << std::setprecision(2) << " ipc=" << (double)c.value[PERF_INSTRUCTIONS] / c.value[PERF_CYCLES];
+        }
+        if (c.valid[PERF_LLC_MISSES]) std::cout << " llc_miss=" << c.value[PERF_LLC_MISSES];
+        if (c.valid[PERF_BRANCH_MISSES]) std::cout << " br_miss=" << c.value[PERF_BRANCH_MISSES];
+        std::cout << "\n";
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+}
+
+bool PhaseProfiler::WriteJson(const std::string& file) const {
+    std::ofstream f(file.c_str());
+    if (!f.is_open()) { std::cerr << "Cannot open: " << file << std::endl; return false; }
+
+    ResourceSnapshot now = TakeSnapshot();
+    uint64_t peakKb = 0, events = 0;
+    double runWall = 0;
+    for (const auto& p : m_phases) {
+        if (p.peakRssKb > peakKb) peakKb = p.peakRssKb;
+        if (p.events > 0) { events += p.events; runWall += p.wallSec; }
+    }
+
+    f << std::setprecision(9);
+    f << "{\n  \"version\": 1,\n  \"metrics\": {";
+    for (size_t i = 0; i < m_metrics.size(); ++i) {
+        f << (i ? ",\n" : "\n") << "    \"" << m_metrics[i].first << "\": " << m_metrics[i].second;
+    }
+    f << "\n  },\n  \"phases\": [";
+    for (size_t i = 0; i < m_phases.size(); ++i) {
+        const auto& p = m_phases[i];
+        f << (i ? ",\n" : "\n")
+          << "    {\"name\": \"" << p.name << "\", \"wall_s\": " << p.wallSec
+          << ", \"cpu_s\": " << p.cpuSec << ", \"peak_rss_kb\": " << p.peakRssKb
+          << ", \"allocs\": " << p.allocs << ", \"events\": " << p.events;
+        if (m_counters.IsOpen()) {
+            f << ", \"counters\": ";
+            WriteCountersJson(f, p.counters, p.events);
+        }
+        f << "}";
+    }
+    f << "\n  ],\n  \"run_windows\": [";
+    for (size_t i = 0; i < m_windows.size(); ++i) {
+        const auto& w = m_windows[i];
+        f << (i ? ",\n" : "\n")
+          << "    {\"sim_time_s\": " << w.simTimeSec << ", \"wall_s\": " << w.wallSec
+          << ", \"events\": " << w.events
+          << ", \"events_per_sec\": " << (w.wallSec > 0 ? w.events / w.wallSec : 0.0);
+        if (m_counters.IsOpen()) {
+            f << ", \"counters\": ";
+            WriteCountersJson(f, w.counters, w.events);
+        }
+        f << "}";
+    }
+    f << "\n  ],\n  \"run\": {\"events\": " << events
+      << ", \"events_per_sec\": " << (runWall > 0 ? events / runWall : 0.0) << "},\n"
+      << "  \"total\": {\"wall_s\": " << (m_started ? now.wallSec - m_begin.wallSec : 0.0)
+      << ", \"cpu_s\": " << (m_started ? now.cpuSec - m_begin.cpuSec : 0.0)
+      << ", \"peak_rss_kb\": " << peakKb
+      << ", \"allocs\": " << (m_started ? now.allocs - m_begin.allocs : 0) << "}\n}\n";
+    f.close();
+    return true;
+}
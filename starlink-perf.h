@@ -0,0 +1,116 @@
+#ifndef STARLINK_PERF_H
+#define STARLINK_PERF_H
+
+// starlink-perf.h - 仿真阶段性能统计
+// 记录每个阶段的墙钟时间、CPU 时间、峰值内存 (RSS) 和内存分配次数，
+// 运行结束后输出 JSON 汇总，由 run_slices.sh / perf_report.py 跨切片聚合。
+// 可选的硬件计数器模式 (--perfCounters) 通过 perf_event_open 读取周期、指令、
+// LLC 缺失、分支预测失败和缺页次数；计数器不可用时自动降级为仅计时。
+// bench/microbench 单独编译本模块并复用其中的分配计数，不能引入 ns-3 头文件。
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ==================== 资源采样 ====================
+
+struct ResourceSnapshot {
+    double wallSec = 0;
+    double cpuSec = 0;
+    uint64_t allocs = 0;
+    uint64_t mallocs = 0;       // 其中实际进入 malloc 的次数 (分配池未命中)
+};
+
+ResourceSnapshot TakeSnapshot();
+uint64_t GetAllocationCount();
+uint64_t GetMallocCount();
+uint64_t GetPeakRssKb();
+void ResetPeakRss();
+
+// ==================== 硬件计数器 ====================
+
+enum PerfCounterId {
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_PAGE_FAULTS,
+    PERF_NUM_COUNTERS
+};
+
+struct PerfCounterValues {
+    uint64_t value[PERF_NUM_COUNTERS] = {};
+    bool valid[PERF_NUM_COUNTERS] = {};
+
+    PerfCounterValues operator-(const PerfCounterValues& o) const;
+};
+
+class PerfCounters {
+public:
+    ~PerfCounters();
+
+    // 逐个打开计数器，返回成功打开的数量；单个计数器失败不影响其他计数器
+    int Open();
+    void Close();
+    bool IsOpen() const;
+    PerfCounterValues Read() const;
+
+    static const char* GetName(int id);
+
+private:
+    int m_fd[PERF_NUM_COUNTERS] = {-1, -1, -1, -1, -1};
+};
+
+// ==================== 阶段记录 ====================
+
+struct PhaseRecord {
+    std::string name;
+    double wallSec = 0;
+    double cpuSec = 0;
+    uint64_t allocs = 0;
+    uint64_t peakRssKb = 0;
+    uint64_t events = 0;    // 仅 Simulator::Run 阶段有效
+    PerfCounterValues counters;
+};
+
+// Simulator::Run 期间按仿真时间采样的窗口
+struct PerfWindow {
+    double simTimeSec = 0;
+    double wallSec = 0;
+    uint64_t events = 0;
+    PerfCounterValues counters;
+};
+
+class PhaseProfiler {
+public:
+    void Begin(const std::string& name);
+    PhaseRecord& End();
+
+    bool EnableCounters();
+    bool HasCounters() const { return m_counters.IsOpen(); }
+
+    // 以上一次采样为起点记录一个运行窗口，totalEvents 为累计已执行事件数
+    void SampleWindow(double simTimeSec, uint64_t totalEvents);
+
+    void AddMetric(const std::string& key, double value);
+    const std::vector<PhaseRecord>& GetPhases() const { return m_phases; }
+
+    void Print() const;
+    bool WriteJson(const std::string& file) const;
+
+private:
+    std::vector<PhaseRecord> m_phases;
+    std::vector<PerfWindow> m_windows;
+    std::vector<std::pair<std::string, double>> m_metrics;
+    ResourceSnapshot m_begin;
+    ResourceSnapshot m_start;
+    PerfCounters m_counters;
+    PerfCounterValues m_startCounters;
+    PerfWindow m_lastWindow;
+    bool m_windowStarted = false;
+    bool m_started = false;
+    bool m_open = false;
+};
+
+#endif // STARLINK_PERF_H
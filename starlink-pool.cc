@@ -0,0 +1,189 @@
+#include "starlink-pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+
+#include <sys/mman.h>
+
+// ==================== 大小分级 ====================
+
+static const uint32_t kNumClasses = 20;
+static const std::size_t kMaxBlock = 4096;
+static const std::size_t kClassRegion = std::size_t(512) << 20;   // 每级预留 512 MiB 虚拟地址
+static const std::size_t kRefillBytes = 64 << 10;                // 每次从区间切出的批量
+static const uint32_t kMaxThreads = 64;                          // 更多的线程不使用池
+// 每批至少 kRefillBytes - 255 字节 (块不超过 256 时按块大小取整，更大的块整除 64K)
+static const std::size_t kMaxChunks = kClassRegion / (kRefillBytes - 255) + 1;
+
+// 16..256 按 16 字节分级 (0-15)，512 / 1K / 2K / 4K 各一级 (16-19)
+static inline uint32_t ClassIndex(std::size_t size) {
+    if (size <= 256) return size ? static_cast<uint32_t>((size - 1) >> 4) : 0;
+    return 16 + (63 - __builtin_clzll(size - 1)) - 8;
+}
+
+static inline std::size_t BlockSize(uint32_t c) {
+    return c < 16 ? (c + 1) * 16 : std::size_t(512) << (c - 16);
+}
+
+static inline std::size_t ChunkBytes(uint32_t c) {
+    std::size_t bs = BlockSize(c);
+    return (kRefillBytes > bs ? kRefillBytes / bs : 1) * bs;
+}
+
+// ==================== 全局区间与线程缓存 ====================
+
+static std::atomic<char*> g_poolBase{nullptr};
+static std::atomic<bool> g_poolEnabled{false};
+static std::atomic<std::size_t> g_classUsed[kNumClasses];
+static std::atomic<uint32_t> g_nextSlot{0};
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+// 每批块记下切给了哪个线程 (槽位 + 1)。其他线程释放的块压入属主的远程链表，
+// 属主在本地链表空时整串取回，块因此总回到分配它的线程，不会滞留在只释放不分配的
+// 线程 (如后台写线程) 里。远程链表是静态存储，线程退出后其中的块只是不再复用。
+static std::atomic<uint8_t> g_chunkOwner[kNumClasses][kMaxChunks];
+static std::atomic<FreeBlock*> g_remoteFree[kMaxThreads][kNumClasses];
+
+// 必须保持平凡类型：operator new 可能在线程局部存储的动态初始化之前被调用。
+// 线程退出时其空闲链表中的块不再复用。
+struct ThreadCache {
+    FreeBlock* freeList[kNumClasses];
+    char* cur[kNumClasses];
+    char* end[kNumClasses];
+    uint64_t allocs[kNumClasses];
+    uint64_t reused[kNumClasses];
+    uint64_t frees[kNumClasses];
+    uint64_t remoteFrees;
+    uint64_t fallbacks;
+    uint32_t slot;              // 0 未分配槽位，1..kMaxThreads，超出时为 kMaxThreads + 1
+};
+
+static thread_local ThreadCache t_cache;
+
+bool EnableAllocPool() {
+    if (!g_poolBase.load(std::memory_order_acquire)) {
+        void* base = mmap(nullptr, kNumClasses * kClassRegion, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (base == MAP_FAILED) return false;
+        g_poolBase.store(static_cast<char*>(base), std::memory_order_release);
+    }
+    g_poolEnabled.store(true, std::memory_order_release);
+    return true;
+}
+
+void DisableAllocPool() {
+    g_poolEnabled.store(false, std::memory_order_release);
+}
+
+bool IsAllocPoolEnabled() {
+    return g_poolEnabled.load(std::memory_order_relaxed);
+}
+
+// 从该级的地址区间切出一批块给当前线程
+static bool Refill(ThreadCache& t, uint32_t c) {
+    std::size_t chunk = ChunkBytes(c);
+    std::size_t off = g_classUsed[c].fetch_add(chunk, std::memory_order_relaxed);
+    if (off + chunk > kClassRegion) return false;
+    g_chunkOwner[c][off / chunk].store(static_cast<uint8_t>(t.slot), std::memory_order_release);
+    t.cur[c] = g_poolBase.load(std::memory_order_relaxed) + c * kClassRegion + off;
+    t.end[c] = t.cur[c] + chunk;
+    return true;
+}
+
+// ==================== 分配与释放 ====================
+
+void* PoolAlloc(std::size_t size) {
+    if (!g_poolEnabled.load(std::memory_order_relaxed)) return nullptr;
+    ThreadCache& t = t_cache;
+    if (size > kMaxBlock) {
+        t.fallbacks++;
+        return nullptr;
+    }
+    if (t.slot == 0) t.slot = std::min(g_nextSlot.fetch_add(1, std::memory_order_relaxed), kMaxThreads) + 1;
+    if (t.slot > kMaxThreads) {
+        t.fallbacks++;
+        return nullptr;
+    }
+    uint32_t c = ClassIndex(size);
+    if (!t.freeList[c]) t.freeList[c] = g_remoteFree[t.slot - 1][c].exchange(nullptr, std::memory_order_acquire);
+    if (FreeBlock* b = t.freeList[c]) {
+        t.freeList[c] = b->next;
+        t.allocs[c]++;
+        t.reused[c]++;
+        return b;
+    }
+    if (t.cur[c] == t.end[c] && !Refill(t, c)) {
+        t.fallbacks++;
+        return nullptr;
+    }
+    void* p = t.cur[c];
+    t.cur[c] += BlockSize(c);
+    t.allocs[c]++;
+    return p;
+}
+
+bool PoolFree(void* p) {
+    char* base = g_poolBase.load(std::memory_order_relaxed);
+    if (!base) return false;
+    std::uintptr_t off = reinterpret_cast<std::uintptr_t>(p) - reinterpret_cast<std::uintptr_t>(base);
+    if (off >= kNumClasses * kClassRegion) return false;
+    uint32_t c = static_cast<uint32_t>(off / kClassRegion);
+    uint32_t owner = g_chunkOwner[c][off % kClassRegion / ChunkBytes(c)].load(std::memory_order_acquire);
+    ThreadCache& t = t_cache;
+    FreeBlock* b = static_cast<FreeBlock*>(p);
+    t.frees[c]++;
+    if (owner == t.slot) {
+        b->next = t.freeList[c];
+        t.freeList[c] = b;
+        return true;
+    }
+    std::atomic<FreeBlock*>& head = g_remoteFree[owner - 1][c];
+    FreeBlock* old = head.load(std::memory_order_relaxed);
+    do {
+        b->next = old;
+    } while (!head.compare_exchange_weak(old, b, std::memory_order_release, std::memory_order_relaxed));
+    t.remoteFrees++;
+    return true;
+}
+
+// ==================== 统计 ====================
+
+PoolStats GetPoolStats() {
+    PoolStats s;
+    const ThreadCache& t = t_cache;
+    for (uint32_t c = 0; c < kNumClasses; ++c) {
+        PoolClassStats cs;
+        cs.blockSize = static_cast<uint32_t>(BlockSize(c));
+        cs.allocs = t.allocs[c];
+        cs.reused = t.reused[c];
+        cs.frees = t.frees[c];
+        s.classes.push_back(cs);
+        s.allocs += cs.allocs;
+        s.reused += cs.reused;
+        s.frees += cs.frees;
+        std::size_t used = g_classUsed[c].load(std::memory_order_relaxed);
+        s.reservedBytes += used < kClassRegion ? used : kClassRegion;
+    }
+    s.remoteFrees = t.remoteFrees;
+    s.fallbacks = t.fallbacks;
+    return s;
+}
+
+void PrintPoolStats(std::ostream& os, const PoolStats& stats) {
+    os << "Allocation pool (" << stats.allocs << " pooled, " << stats.fallbacks << " to malloc, "
+       << stats.remoteFrees << " freed to other threads, "
+       << std::fixed << std::setprecision(1) << 100.0 * stats.HitRate() << "% free-list hits, "
+       << stats.reservedBytes / 1048576.0 << " MB carved):\n";
+    os << std::setw(8) << "block" << std::setw(14) << "allocs" << std::setw(14) << "reused"
+       << std::setw(14) << "frees" << std::setw(8) << "hit%" << "\n";
+    for (const PoolClassStats& c : stats.classes) {
+        if (c.allocs == 0 && c.frees == 0) continue;
+        os << std::setw(8) << c.blockSize << std::setw(14) << c.allocs << std::setw(14) << c.reused
+           << std::setw(14) << c.frees << std::setw(8) << (c.allocs ? 100.0 * c.reused / c.allocs : 0.0) << "\n";
+    }
+    os.unsetf(std::ios::floatfield);
+}
@@ -0,0 +1,53 @@
+#ifndef STARLINK_POOL_H
+#define STARLINK_POOL_H
+
+// starlink-pool.h - 小对象分配池
+// 流量路径上每个分组都会分配 Packet、Buffer 数据区、包头/标签存储和调度事件，
+// 在接收端或丢包时释放。starlink-perf.cc 替换的全局 operator new 在池启用后
+// 先调用 PoolAlloc：按大小分级 (16 字节步长到 256，之后 512 / 1K / 2K / 4K)，
+// 每个线程维护各级的空闲链表，命中时无需进入 malloc。在其他线程释放的块经无锁链表
+// 还给分配它的线程。
+// 各级从一段预留的虚拟地址区间中按批切分，释放时按地址判断是否属于池，
+// 因此池外分配 (启用之前或超过 4K) 仍由 free 归还，两者可以混用。
+// bench/microbench 单独编译本模块，不能引入 ns-3 头文件。
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// 预留地址区间并开始从池中分配；预留失败时返回 false，分配仍走 malloc
+bool EnableAllocPool();
+// 停止从池中分配新块 (已分配的块仍可正常释放)
+void DisableAllocPool();
+bool IsAllocPoolEnabled();
+
+// 返回 nullptr 表示池未启用、大小超出最大级别或该级地址区间已用尽
+void* PoolAlloc(std::size_t size);
+// p 属于池时回收到分配它的线程的空闲链表并返回 true
+bool PoolFree(void* p);
+
+struct PoolClassStats {
+    uint32_t blockSize = 0;
+    uint64_t allocs = 0;        // 由池提供的分配
+    uint64_t reused = 0;        // 其中来自空闲链表的次数
+    uint64_t frees = 0;
+};
+
+struct PoolStats {
+    std::vector<PoolClassStats> classes;
+    uint64_t allocs = 0;
+    uint64_t reused = 0;
+    uint64_t frees = 0;
+    uint64_t remoteFrees = 0;   // 其中还给其他线程的块
+    uint64_t fallbacks = 0;     // 池启用期间转交 malloc 的分配
+    uint64_t reservedBytes = 0; // 各级已切分出的字节数
+
+    double HitRate() const { return allocs ? (double)reused / allocs : 0.0; }
+};
+
+// 统计为当前线程的计数 (仿真主线程)，reservedBytes 为全局值
+PoolStats GetPoolStats();
+void PrintPoolStats(std::ostream& os, const PoolStats& stats);
+
+#endif // STARLINK_POOL_H
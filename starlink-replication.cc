@@ -0,0 +1,209 @@
+#include "starlink-replication.h"
+#include "starlink-convergence.h"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+// ==================== 子进程调度 ====================
+
+int ForkWorkers(uint32_t tasks, uint32_t jobs, std::vector<uint32_t>& failed) {
+    failed.clear();
+    if (jobs == 0) jobs = 1;
+    // 缓冲区中未输出的内容会被每个子进程复制一份
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(nullptr);
+
+    std::map<pid_t, uint32_t> running;
+    uint32_t next = 0;
+    while (next < tasks || !running.empty()) {
+        while (next < tasks && running.size() < jobs) {
+            pid_t pid = fork();
+            if (pid == 0) return static_cast<int>(next);
+            if (pid < 0) {
+                std::cerr << "❌ fork 失败，副本 " << next << " 未运行" << std::endl;
+                failed.push_back(next++);
+                continue;
+            }
+            running[pid] = next++;
+        }
+        if (running.empty()) break;
+
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) break;
+        auto it = running.find(pid);
+        if (it == running.end()) continue;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::cerr << "❌ 副本 " << it->second << " 异常退出 (status=" << status << ")" << std::endl;
+            failed.push_back(it->second);
+        }
+        running.erase(it);
+    }
+    return -1;
+}
+
+// ==================== CSV 表 ====================
+
+static std::vector<std::string> SplitCsvLine(const std::string& line) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ',')) fields.push_back(field);
+    if (!line.empty() && line.back() == ',') fields.push_back("");
+    return fields;
+}
+
+int CsvTable::Column(const std::string& name) const {
+    for (size_t i = 0; i < header.size(); ++i) {
+        if (header[i] == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+bool ReadCsv(const std::string& file, CsvTable& table) {
+    std::ifstream in(file);
+    if (!in.is_open()) return false;
+    std::string line;
+    if (!std::getline(in, line)) return false;
+    table.header = SplitCsvLine(line);
+    table.rows.clear();
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        std::vector<std::string> row = SplitCsvLine(line);
+        row.resize(table.header.size());
+        table.rows.push_back(std::move(row));
+    }
+    return true;
+}
+
+// ==================== 副本合并 ====================
+
+bool MergeReplicationResults(const std::vector<std::string>& files, const std::string& keyColumn,
+                             const std::vector<std::string>& metricColumns, double confidence,
+                             const std::string& outFile, const std::string& allFile) {
+    std::vector<CsvTable> tables;
+    std::vector<uint32_t> reps;
+    for (uint32_t r = 0; r < files.size(); ++r) {
+        CsvTable t;
+        if (!ReadCsv(files[r], t)) {
+            std::cerr << "⚠️ 缺少副本结果: " << files[r] << std::endl;
+            continue;
+        }
+        if (!tables.empty() && t.header != tables.front().header) {
+            std::cerr << "⚠️ 副本结果列不一致，已跳过: " << files[r] << std::endl;
+            continue;
+        }
+        tables.push_back(std::move(t));
+        reps.push_back(r);
+    }
+    if (tables.empty()) return false;
+
+    const std::vector<std::string>& header = tables.front().header;
+    int keyCol = tables.front().Column(keyColumn);
+    if (keyCol < 0) {
+        std::cerr << "❌ 副本结果中没有列 " << keyColumn << std::endl;
+        return false;
+    }
+    std::vector<int> metricCols;
+    for (const auto& name : metricColumns) metricCols.push_back(tables.front().Column(name));
+
+    std::ofstream all(allFile);
+    if (all.is_open()) {
+        all << "Replication";
+        for (const auto& h : header) all << "," << h;
+        all << "\n";
+        for (size_t t = 0; t < tables.size(); ++t) {
+            for (const auto& row : tables[t].rows) {
+                all << reps[t];
+                for (const auto& f : row) all << "," << f;
+                all << "\n";
+            }
+        }
+    }
+
+    // 按 key 分组，保持第一个副本中的行顺序。key 为空的行 (TCP 反向 ACK 流、对应不到需求的流)
+    // 在副本之间没有稳定的身份，不参与合并，只保留在 allFile 中
+    std::vector<std::string> keys;
+    std::map<std::string, std::vector<const std::vector<std::string>*>> groups;
+    uint64_t unkeyed = 0;
+    for (const auto& t : tables) {
+        for (const auto& row : t.rows) {
+            if (row[keyCol].empty()) {
+                unkeyed++;
+                continue;
+            }
+            auto& g = groups[row[keyCol]];
+            if (g.empty()) keys.push_back(row[keyCol]);
+            g.push_back(&row);
+        }
+    }
+    if (unkeyed > 0) {
+        std::cerr << "⚠️ " << unkeyed << " 行没有 " << keyColumn << "，未参与副本合并 (见 " << allFile << ")"
+                  << std::endl;
+    }
+
+    std::ofstream out(outFile);
+    if (!out.is_open()) {
+        std::cerr << "❌ 无法创建输出文件: " << outFile << std::endl;
+        return false;
+    }
+    out << std::fixed << std::setprecision(6);
+    for (size_t i = 0; i < header.size(); ++i) out << (i ? "," : "") << header[i];
+    out << ",Replications";
+    for (size_t m = 0; m < metricColumns.size(); ++m) {
+        if (metricCols[m] >= 0) out << "," << metricColumns[m] << "_CI";
+    }
+    out << "\n";
+
+    for (const auto& key : keys) {
+        const auto& g = groups[key];
+        std::vector<std::string> merged = *g.front();
+        std::vector<std::string> ci;
+        for (int col : metricCols) {
+            if (col < 0) continue;
+            double sum = 0, sumSq = 0;
+            uint32_t n = 0;
+            for (const auto* row : g) {
+                const std::string& f = (*row)[col];
+                if (f.empty()) continue;
+                double v = std::atof(f.c_str());
+                sum += v;
+                sumSq += v * v;
+                n++;
+            }
+            if (n == 0) {
+                ci.push_back("");
+                continue;
+            }
+            double mean = sum / n;
+            std::ostringstream m;
+            m << std::fixed << std::setprecision(6) << mean;
+            merged[col] = m.str();
+            if (n < 2) {
+                ci.push_back("");
+                continue;
+            }
+            double var = std::max(0.0, (sumSq - n * mean * mean) / (n - 1));
+            double half = StudentTQuantile(0.5 + confidence / 2, n - 1) * std::sqrt(var / n);
+            std::ostringstream c;
+            c << std::fixed << std::setprecision(6) << half;
+            ci.push_back(c.str());
+        }
+        for (size_t i = 0; i < merged.size(); ++i) out << (i ? "," : "") << merged[i];
+        out << "," << g.size();
+        for (const auto& c : ci) out << "," << c;
+        out << "\n";
+    }
+    return true;
+}
@@ -0,0 +1,40 @@
+#ifndef STARLINK_REPLICATION_H
+#define STARLINK_REPLICATION_H
+
+// starlink-replication.h - 多副本并行运行与结果合并
+// 拓扑解析和路由计算只在父进程中做一次，然后 fork 子进程，子进程以写时复制
+// 方式继承只读的安装数据，各自用不同的 RNG run 编号构建网络并运行。
+// 最多 jobs 个子进程同时运行，每个子进程只运行一个任务后退出，
+// 避免在同一进程中重复初始化 ns-3 的全局状态。
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 在子进程中返回任务编号 (0..tasks-1)，调用方运行该任务后直接退出；
+// 父进程等待所有子进程结束后返回 -1，failed 中为异常退出的任务编号
+int ForkWorkers(uint32_t tasks, uint32_t jobs, std::vector<uint32_t>& failed);
+
+// ==================== CSV 表 ====================
+
+struct CsvTable {
+    std::vector<std::string> header;
+    std::vector<std::vector<std::string>> rows;
+
+    int Column(const std::string& name) const;
+};
+
+bool ReadCsv(const std::string& file, CsvTable& table);
+
+// ==================== 副本合并 ====================
+
+// 读取各副本的 flow_results，按 keyColumn 分组：
+//   allFile - 所有副本的行，首列为 Replication
+//   outFile - 每组一行，metricColumns 取各副本均值，并追加 Replications 列和
+//             <列名>_CI 列 (Student-t 置信区间半宽)，其余列取第一个副本的值
+// keyColumn 为空的行只写入 allFile，不合并，数量打印到 stderr
+bool MergeReplicationResults(const std::vector<std::string>& files, const std::string& keyColumn,
+                             const std::vector<std::string>& metricColumns, double confidence,
+                             const std::string& outFile, const std::string& allFile);
+
+#endif // STARLINK_REPLICATION_H
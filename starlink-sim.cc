@@ -8,16 +8,46 @@
 #include "ns3/queue.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/traffic-control-helper.h"
+
+#include "profiling-simulator-impl.h"
+#include "scheduler-trace.h"
+#include "starlink-aggregate.h"
+#include "starlink-columnar.h"
+#include "starlink-convergence.h"
+#include "starlink-flightrec.h"
+#include "starlink-hoplatency.h"
+#include "starlink-perf.h"
+#include "starlink-pool.h"
+#include "starlink-replication.h"
+#include "starlink-surrogate.h"
+#include "starlink-sweep.h"
+#include "starlink-timeseries.h"
+#include "starlink-topology.h"
+#include "starlink-trace.h"
+#include "starlink-traffic-gen.h"
+#include "starlink-validate.h"
+#include "starlink-zstream.h"
+#include "hop-trace-tag.h"
+#include "subflow-sender.h"
+#include "subflow-tag.h"
+
+#include <unistd.h>
 
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <deque>
 #include <map>
-#include <queue>
-#include <limits>
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <memory>
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <unordered_map>
 
 using namespace ns3;
 
@@ -25,33 +55,25 @@ NS_LOG_COMPONENT_DEFINE("StarlinkSim");
 
 // ==================== 数据结构 ====================
 
-struct LinkParam {
-    uint32_t srcId;
-    uint32_t dstId;
-    std::string srcName;
-    std::string dstName;
-    double delayMs;
-    uint64_t dataRateBps;
-    double packetLossRate;
-    double distanceKm;
-};
-
-struct TrafficDemand {
-    uint32_t demandId;
-    std::string srcNode;
-    std::string dstNode;
-    uint32_t srcId;
-    uint32_t dstId;
-    double dataRateMbps;
-    double startTimeSec;
-    double durationSec;
-};
+// 链路计数按方向展开：下标 2i 为 g_links[i] 的 src->dst，2i+1 为 dst->src。
+// 每类计数一个扁平数组，回调里只有一次下标累加，常开也不影响仿真速度。
+struct LinkCounters {
+    std::vector<uint64_t> txPackets;        // 进入设备发送的分组 (MacTx，含随后被队列丢弃的)
+    std::vector<uint64_t> txBytes;
+    std::vector<uint64_t> rxPackets;        // 对端设备收到的分组 (MacRx)
+    std::vector<uint64_t> rxBytes;
+    std::vector<uint64_t> queueDrops;       // 发送队列满 (Queue Drop)
+    std::vector<uint64_t> queueDropBytes;
+    std::vector<uint64_t> phyDrops;         // 接收端误码模型丢弃 (PhyRxDrop)
+    std::vector<uint64_t> busyNs;           // 已结束的发送 PhyTxBegin -> PhyTxEnd 时长之和
+    std::vector<int64_t> txBeginNs;         // 正在发送的分组的 PhyTxBegin 时刻，空闲时为 -1
 
-struct LinkStats {
-    std::string srcName;
-    std::string dstName;
-    uint64_t txPackets = 0;
-    uint64_t rxPackets = 0;
+    void Resize(size_t directions) {
+        for (auto* v : {&txPackets, &txBytes, &rxPackets, &rxBytes, &queueDrops, &queueDropBytes, &phyDrops, &busyNs}) {
+            v->assign(directions, 0);
+        }
+        txBeginNs.assign(directions, -1);
+    }
 };
 
 struct MonitorEntry {
@@ -61,34 +83,300 @@ struct MonitorEntry {
 };
 
 // ==================== 全局变量 ====================
-std::vector<LinkStats> g_linkStats;
-std::vector<LinkParam> g_links;
-std::vector<TrafficDemand> g_demands;
+LinkCounters g_linkCounters;
 std::vector<MonitorEntry> g_monitoredLinks;
-uint32_t g_numNodes = 0;
 NodeContainer g_nodes;
 
-std::map<std::string, std::string> g_ipToSatellite;
-std::map<uint32_t, std::string> g_nodeIdToName;
-std::map<uint32_t, Ipv4Address> g_nodeFirstIp;
-std::vector<std::vector<std::pair<uint32_t, double>>> g_adjList;
+// 安装期查找表与拓扑容器一样从 setup 资源分配 (--setupArena)
+std::pmr::map<std::string, std::string> g_ipToSatellite(GetSetupResource());
+std::pmr::map<uint32_t, Ipv4Address> g_nodeFirstIp(GetSetupResource());
 
 // 用于查找两个节点之间的接口信息
-std::map<std::pair<uint32_t, uint32_t>, std::pair<uint32_t, Ipv4Address>> g_linkInterface;
+std::pmr::map<std::pair<uint32_t, uint32_t>, std::pair<uint32_t, Ipv4Address>> g_linkInterface(GetSetupResource());
+
+OutputFile g_monitorFile;
+PhaseProfiler g_profiler;
+
+// 结果文件格式 (--resultFormat)：CSV 文本、.slcol 列式二进制 (starlink-columnar.h) 或两者都写；
+// --compressOutput 时 CSV 以分块 gzip 写出 (starlink-zstream.h)。多副本 / 扫描任务的 flow_results
+// 和 surrogate_results 由父进程读取合并，保持未压缩；components.csv 在 fork 之前写出，
+// 那时还不能启动后台写线程，也不压缩
+struct ResultFormat {
+    bool csv = true;
+    bool columnar = false;
+    bool zlib = true;
+    bool gzip = false;
+    bool gzipMerged = false;    // 父进程要合并的结果文件是否压缩
+    ColumnarWriter monitor;     // link_monitor 按采样周期流式追加
+};
+ResultFormat g_results;
+
+// xxx.csv -> xxx.slcol
+static std::string ColumnarPath(const std::string& csvFile) {
+    std::string base = csvFile;
+    if (base.size() >= 4 && base.compare(base.size() - 4, 4, ".csv") == 0) base.resize(base.size() - 4);
+    return base + ".slcol";
+}
+
+// ==================== 提前结束 ====================
+// 所有需求的发送时段结束后周期性检查：各设备队列为空，且应用发出的分组都已被
+// 接收端收到或在途中丢弃时停止仿真。计数覆盖不到的丢弃 (例如目的端口未监听)
+// 由兜底条件处理：队列持续为空超过最长路径的传输 + 传播时延后同样停止。
+
+struct DrainState {
+    uint64_t appTx = 0;
+    uint64_t sinkRx = 0;
+    uint64_t dropped = 0;
+    double demandsEndTime = 0;  // 最后一个需求的发送结束时刻
+    double drainTimeout = 0;    // 最长路径的传输 + 传播时延
+    double emptySince = -1;     // 队列开始持续为空的时刻
+    double cutoffTime = -1;     // 提前结束的时刻，未提前结束时为 -1
+};
+DrainState g_drain;
+
+// ==================== 稳态检测 ====================
+// 每 batchInterval 秒从 FlowMonitor 读取各流累计的接收字节、时延和分组数，
+// 差分得到本批的吞吐量与平均时延交给 ConvergenceMonitor (starlink-convergence.h)。
+// 需求按目的端口对应到 FlowMonitor 的流；所有需求都已开始，且仍在发送的需求
+// 全部收敛时停止仿真。
+
+struct SteadyStateFlow {
+    uint32_t demandIndex = 0;   // 合并需求时为组代表
+    std::string demandIds;      // 组内各需求的 demandId，以 ';' 分隔
+    double startSec = 0;
+    double endSec = 0;
+    bool seen = false;          // FlowMonitor 中已出现对应的流
+    uint64_t lastRxBytes = 0;
+    uint64_t lastRxPackets = 0;
+    double lastDelaySumMs = 0;
+};
+
+struct SteadyState {
+    std::unique_ptr<ConvergenceMonitor> monitor;
+    Ptr<FlowMonitor> flowMonitor;
+    Ptr<Ipv4FlowClassifier> classifier;
+    std::vector<SteadyStateFlow> flows;         // 已安装的需求，按安装顺序
+    // (目的地址, 目的端口) -> 先后占用该端口的 (占用开始时刻, flows 下标)，见 FlowKey / LookupFlow
+    std::unordered_map<uint64_t, std::vector<std::pair<double, uint32_t>>> portToFlow;
+    std::map<FlowId, uint32_t> flowIdToFlow;
+    double interval = 0.1;
+    double lastDemandStart = 0;
+    double stopTime = -1;       // 收敛后停止的时刻，未停止时为 -1
+};
+SteadyState g_steady;
+
+// 端口按目的节点分配，不同目的节点上的需求可以使用相同端口，映射需带上目的地址
+static uint64_t FlowKey(Ipv4Address dst, uint16_t port) {
+    return (static_cast<uint64_t>(dst.Get()) << 16) | port;
+}
+
+// --lazyApps 下端口在接收端释放后回收，同一键先后对应多个流；接收端在首包发出之前创建、
+// 在末包到达之后释放，按流的首包发送时刻找占用期覆盖它的那个流。找不到返回 -1
+static int64_t LookupFlow(Ipv4Address dst, uint16_t port, double firstTxSec) {
+    auto it = g_steady.portToFlow.find(FlowKey(dst, port));
+    if (it == g_steady.portToFlow.end()) return -1;
+    const auto& occupants = it->second;
+    auto next = std::upper_bound(occupants.begin(), occupants.end(), firstTxSec,
+                                 [](double t, const std::pair<double, uint32_t>& o) { return t < o.first; });
+    return next == occupants.begin() ? -1 : static_cast<int64_t>(std::prev(next)->second);
+}
+
+// 目的端口按目的节点从 kFirstPort 起分配，上限低于临时端口范围 (49152 起)，避免与 TCP 源端口
+// 及反向 ACK 流冲突。--lazyApps 释放接收端后端口回到该节点的空闲队列，先进先出复用，
+// 限制的是同一目的节点上同时存在的需求组数而不是总数
+struct PortAllocator {
+    static constexpr uint32_t kFirstPort = 9000;
+    static constexpr uint32_t kLastPort = 49151;
+    std::vector<uint32_t> next;
+    std::vector<std::deque<uint16_t>> free;
+
+    void Init(uint32_t nodes) {
+        next.assign(nodes, kFirstPort);
+        free.assign(nodes, std::deque<uint16_t>());
+    }
+    // 用尽时返回 0
+    uint16_t Take(uint32_t node) {
+        if (!free[node].empty()) {
+            uint16_t port = free[node].front();
+            free[node].pop_front();
+            return port;
+        }
+        return next[node] <= kLastPort ? static_cast<uint16_t>(next[node]++) : 0;
+    }
+    void Release(uint32_t node, uint16_t port) { free[node].push_back(port); }
+};
+PortAllocator g_ports;
+
+// 需求合并 (--aggregateDemands)：按原始需求统计的子流
+struct SubFlowStats {
+    uint64_t txPackets = 0;
+    uint64_t rxPackets = 0;
+    uint64_t rxBytes = 0;       // 含 UDP/IP 头，与 FlowMonitor 一致
+    double delaySumSec = 0;
+    double firstTxSec = -1;
+    double lastRxSec = -1;
+};
+
+struct SubFlowAccounting {
+    std::vector<SubFlowStats> stats;                // 按 g_demands 下标
+    std::vector<std::vector<uint32_t>> members;     // 按组
+    std::vector<WeightedRoundRobin> pickers;        // 按组
+};
+SubFlowAccounting g_subflows;
+
+// ==================== 按需创建应用 ====================
+// --lazyApps：需求按开始时刻排序保存，PacketSink 与 OnOff 在开始前 lazyAppWindow 秒内
+// 才创建；发送结束后再等 lazyAppLinger + 路径时延，关闭 socket 并 Dispose，槽位回收复用。
+// 峰值应用数随并发需求数而不是需求总数增长；目的端口同样在创建时分配、释放时回收
+// (PortAllocator)。ns-3 的 Node 不支持移除应用，节点应用列表里只留下已释放的空壳。
+
+struct DemandApp {
+    uint32_t src = 0;
+    uint32_t dst = 0;
+    uint16_t port = 0;
+    int32_t subflowGroup = -1;  // 合并需求的组下标，未合并为 -1
+    uint32_t flow = 0;          // g_steady.flows 下标
+    int32_t series = -1;        // 时间序列下标 (g_steady.flows 下标)，未启用为 -1
+    double rateMbps = 0;
+    double startSec = 0;
+    double endSec = 0;
+    double releaseSec = 0;      // 释放时刻 (仅 --lazyApps)
+};
+
+struct ActiveApps {
+    Ptr<Application> sender;
+    Ptr<PacketSink> sink;
+    uint32_t dst = 0;
+    uint16_t port = 0;
+};
+
+struct AppInstaller {
+    bool lazy = false;
+    bool drainTraces = false;           // --earlyStop 的计数回调需在创建时逐个连接
+    uint32_t packetSize = 1024;
+    std::string onTime;
+    std::string offTime;
+    double simTime = 0;
+    double window = 1.0;
+    std::vector<DemandApp> pending;     // 按 startSec 排序
+    size_t next = 0;
+    std::vector<ActiveApps> slots;
+    std::vector<uint32_t> freeSlots;
+    uint32_t active = 0;
+    uint32_t peakActive = 0;
+    bool portsExhausted = false;        // 运行中端口用尽，已提前停止
+};
+AppInstaller g_apps;
+
+// ==================== 轨迹回放 ====================
+// --trafficTrace：不安装 OnOff，每个需求 (组) 在源节点上建一个 UDP socket，
+// 由 mmap 的二进制轨迹 (starlink-trace.h) 驱动发送。每个调度事件发出所有已到时刻的
+// 记录，下一个事件至少间隔 traceBatch 秒，事件数随批次而不是分组数增长。
+
+struct TraceReplay {
+    TraceReader reader;
+    std::vector<Ptr<Socket>> sockets;                   // 按需求 (组)
+    std::unordered_map<uint32_t, uint32_t> demandToSocket;
+    std::unordered_map<uint32_t, uint32_t> demandToIndex; // demandId -> g_demands 下标
+    bool active = false;
+    bool tagSubflows = false;
+    TraceEvent next;
+    bool hasNext = false;
+    uint64_t startNs = 0;
+    uint64_t batchNs = 100000;
+    uint64_t sent = 0;
+    uint64_t unmatched = 0;
+    uint64_t batches = 0;
+};
+TraceReplay g_replay;
+
+// ==================== TCP 流 ====================
+// --transport=tcp：每个需求 (组) 是一条 TCP 连接，直接使用 socket 而不安装
+// BulkSend / PacketSink 应用。startSec 时在目的节点监听、源节点发起连接，发送端在
+// 发送缓冲区有空间时补满，接收端收齐 bytes 时记录完成时间 (FCT) 并释放 socket。
+// --tcpBulk 时不限大小，持续发送到 endSec。数据段序号低于已发送的最高序号时计为重传。
+
+struct TcpFlow {
+    uint32_t src = 0;
+    uint32_t dst = 0;
+    uint16_t port = 0;
+    std::string demandIds;
+    uint64_t bytes = 0;         // 0 表示 bulk
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    double startSec = 0;
+    double endSec = 0;
+    double lastRxSec = -1;
+    double completeSec = -1;
+    uint64_t retransmissions = 0;
+    int32_t series = -1;
+    SequenceNumber32 highestTx;
+    bool anyTx = false;
+    bool closed = false;        // 发送端已 Close
+    bool done = false;          // 已从 g_tcp.open 中扣除
+    bool failed = false;        // 连接失败或发送端异常关闭
+    Ptr<Socket> tx;
+    Ptr<Socket> listening;
+    Ptr<Socket> rx;
+};
+
+struct TcpFlows {
+    std::vector<TcpFlow> flows;
+    uint32_t open = 0;          // 尚未结束的流：有限大小流收齐前，bulk 流接收端收到 FIN 前
+};
+TcpFlows g_tcp;
 
-std::ofstream g_monitorFile;
+// 时间序列 (--timeSeriesBin)：需求按接收端收到的载荷字节，链路按方向 (2i 为 src->dst，
+// 2i+1 为 dst->src) 统计 MacTx 字节
+RingSeries g_flowSeries;
+RingSeries g_linkSeries;
+
+// 逐跳时延抽样 (--hopSample N)：uid 为 N 的倍数的分组在 MacTx 记下进入设备的时刻，
+// PhyTxBegin 时连同排队等待打上 HopTraceTag，UDP 接收端分解后按链路方向和流累加
+struct HopSampling {
+    uint32_t every = 0;                             // 0 表示关闭
+    std::unordered_map<uint64_t, int64_t> pending;  // uid -> 进入设备的时刻 (ns)
+    std::vector<uint64_t> rateBps;                  // 按链路方向
+    std::vector<int64_t> delayNs;                   // 按链路方向：传播时延
+    HopLatencyStats stats;
+};
+HopSampling g_hops;
+
+// 飞行记录仪 (--flightRecorder)：MacTx 时把分组头拷入所在方向的环，丢包突发或排队
+// 时延尖峰时转储该方向及经过它的需求路径上所有方向的环 (starlink-flightrec.h)
+struct FlightState {
+    bool enabled = false;
+    FlightRecorder recorder;
+    std::vector<std::vector<uint32_t>> groupDirs;   // 按需求组：路径经过的方向
+    std::vector<std::vector<uint32_t>> dirGroups;   // 按方向：经过它的需求组
+    std::vector<Ptr<Queue<Packet>>> queues;         // 按方向：发送队列 (时延检测)
+};
+FlightState g_flight;
 
 // ==================== 工具函数 ====================
 
-std::string Trim(const std::string& s) {
-    size_t start = s.find_first_not_of(" \t\r\n");
-    if (start == std::string::npos) return "";
-    size_t end = s.find_last_not_of(" \t\r\n");
-    return s.substr(start, end - start + 1);
+// 合并源每发送一个分组，按成员速率轮询选出所属的原始需求并打标记
+void SubFlowTxCallback(uint32_t group, Ptr<const Packet> packet) {
+    uint32_t demand = g_subflows.members[group][g_subflows.pickers[group].Next()];
+    SubFlowStats& st = g_subflows.stats[demand];
+    if (st.firstTxSec < 0) st.firstTxSec = Simulator::Now().GetSeconds();
+    st.txPackets++;
+    packet->AddPacketTag(SubFlowTag(demand, Simulator::Now()));
+}
+
+void SubFlowRxCallback(Ptr<const Packet> packet, const Address& from) {
+    SubFlowTag tag;
+    if (!packet->PeekPacketTag(tag)) return;
+    SubFlowStats& st = g_subflows.stats[tag.GetDemandIndex()];
+    st.rxPackets++;
+    st.rxBytes += packet->GetSize() + 28;
+    st.delaySumSec += (Simulator::Now() - tag.GetTxTime()).GetSeconds();
+    st.lastRxSec = Simulator::Now().GetSeconds();
 }
 
 void MonitorQueues(double interval) {
     double now = Simulator::Now().GetSeconds();
+    g_monitorFile.MarkTime(now);
     
     for (const auto& entry : g_monitoredLinks) {
         if (!entry.device) continue;
@@ -99,117 +387,473 @@ void MonitorQueues(double interval) {
             qSize = queue->GetNPackets();
         }
         
-        g_monitorFile << now << ","
-                      << entry.srcName << ","
-                      << entry.dstName << ","
-                      << qSize << "\n";
+        if (g_results.csv) {
+            g_monitorFile << now << ","
+                          << entry.srcName << ","
+                          << entry.dstName << ","
+                          << qSize << "\n";
+        }
+        if (g_results.monitor.IsOpen()) {
+            g_results.monitor.Float(now).Str(entry.srcName).Str(entry.dstName).UInt(qSize).EndRow();
+        }
     }
-    g_monitorFile.flush();
+    if (g_results.csv) g_monitorFile.flush();
     
     Simulator::Schedule(Seconds(interval), &MonitorQueues, interval);
 }
 
-static void LinkTxCallback(uint32_t linkIndex, Ptr<const Packet> p) {
-    if (linkIndex < g_linkStats.size()) g_linkStats[linkIndex].txPackets++;
+// --perfCounters 模式下按仿真时间周期性采样硬件计数器
+void SamplePerfWindow(double interval) {
+    g_profiler.SampleWindow(Simulator::Now().GetSeconds(), Simulator::GetEventCount());
+    Simulator::Schedule(Seconds(interval), &SamplePerfWindow, interval);
 }
-static void LinkRxCallback(uint32_t linkIndex, Ptr<const Packet> p) {
-    if (linkIndex < g_linkStats.size()) g_linkStats[linkIndex].rxPackets++;
+
+static void FlightTrigger(FlightRecorder::Reason reason, uint32_t dir) {
+    std::vector<uint32_t> dirs = {dir};
+    for (uint32_t g : g_flight.dirGroups[dir]) {
+        dirs.insert(dirs.end(), g_flight.groupDirs[g].begin(), g_flight.groupDirs[g].end());
+    }
+    std::sort(dirs.begin(), dirs.end());
+    dirs.erase(std::unique(dirs.begin(), dirs.end()), dirs.end());
+    const LinkParam& link = g_links[dir / 2];
+    std::string label = dir % 2 == 0 ? link.srcName + "->" + link.dstName : link.dstName + "->" + link.srcName;
+    g_flight.recorder.Dump(reason, dir, Simulator::Now().GetNanoSeconds(), dirs, label);
 }
 
-// ==================== Dijkstra ====================
+static void FlightRecord(uint32_t dir, Ptr<const Packet> p) {
+    int64_t now = Simulator::Now().GetNanoSeconds();
+    uint32_t cap = std::min(p->GetSize(), g_flight.recorder.SnapLen());
+    p->CopyData(g_flight.recorder.Record(dir, now, p->GetSize(), cap), cap);
+    const Ptr<Queue<Packet>>& queue = g_flight.queues[dir];
+    if (queue) {
+        double delayMs = queue->GetNBytes() * 8e3 / g_links[dir / 2].dataRateBps;
+        if (g_flight.recorder.OnQueueDelay(dir, now, delayMs)) FlightTrigger(FlightRecorder::DelaySpike, dir);
+    }
+}
 
-struct DijkstraResult {
-    std::vector<double> dist;
-    std::vector<int> prev;
-};
+static void LinkTxCallback(uint32_t dir, Ptr<const Packet> p) {
+    g_linkCounters.txPackets[dir]++;
+    g_linkCounters.txBytes[dir] += p->GetSize();
+    if (g_linkSeries.IsOpen()) g_linkSeries.Add(dir, Simulator::Now().GetSeconds(), p->GetSize());
+    if (g_hops.every && p->GetUid() % g_hops.every == 0) g_hops.pending[p->GetUid()] = Simulator::Now().GetNanoSeconds();
+    if (g_flight.enabled) FlightRecord(dir, p);
+}
+static void LinkRxCallback(uint32_t dir, Ptr<const Packet> p) {
+    g_linkCounters.rxPackets[dir]++;
+    g_linkCounters.rxBytes[dir] += p->GetSize();
+}
+static void LinkQueueDropCallback(uint32_t dir, Ptr<const Packet> p) {
+    g_linkCounters.queueDrops[dir]++;
+    g_linkCounters.queueDropBytes[dir] += p->GetSize();
+    if (g_hops.every && p->GetUid() % g_hops.every == 0) g_hops.pending.erase(p->GetUid());
+    if (g_flight.enabled && g_flight.recorder.OnDrop(FlightRecorder::QueueDrops, dir, Simulator::Now().GetNanoSeconds())) {
+        FlightTrigger(FlightRecorder::QueueDrops, dir);
+    }
+}
+static void HopTxBeginCallback(uint32_t dir, Ptr<const Packet> p) {
+    if (p->GetUid() % g_hops.every != 0) return;
+    auto it = g_hops.pending.find(p->GetUid());
+    if (it == g_hops.pending.end()) return;
+    int64_t wait = Simulator::Now().GetNanoSeconds() - it->second;
+    p->AddByteTag(HopTraceTag(dir, it->second, static_cast<uint32_t>(std::min<int64_t>(wait, UINT32_MAX))));
+    g_hops.pending.erase(it);
+}
+static void LinkPhyTxBeginCallback(uint32_t dir, Ptr<const Packet> p) {
+    g_linkCounters.txBeginNs[dir] = Simulator::Now().GetNanoSeconds();
+    if (g_hops.every) HopTxBeginCallback(dir, p);
+}
+static void LinkPhyTxEndCallback(uint32_t dir, Ptr<const Packet> p) {
+    int64_t& begin = g_linkCounters.txBeginNs[dir];
+    if (begin >= 0) g_linkCounters.busyNs[dir] += Simulator::Now().GetNanoSeconds() - begin;
+    begin = -1;
+}
+static void HopSampleRxCallback(uint32_t flow, Ptr<const Packet> p, const Address& from) {
+    if (p->GetUid() % g_hops.every != 0) return;
+    std::vector<HopRecord> hops;
+    ByteTagIterator it = p->GetByteTagIterator();
+    while (it.HasNext()) {
+        ByteTagIterator::Item item = it.Next();
+        if (item.GetTypeId() != HopTraceTag::GetTypeId()) continue;
+        HopTraceTag tag;
+        item.GetTag(tag);
+        hops.push_back({tag.GetDirection(), tag.GetEnqueueNs(), tag.GetWaitNs()});
+    }
+    // 载荷加 UDP/IP 头即各跳上的 IP 分组长度
+    g_hops.stats.AddPacket(flow, hops, Simulator::Now().GetNanoSeconds(), p->GetSize() + 28, g_hops.rateBps,
+                           g_hops.delayNs);
+}
+static void LinkPhyDropCallback(uint32_t dir, Ptr<const Packet> p) {
+    g_linkCounters.phyDrops[dir]++;
+    if (g_flight.enabled && g_flight.recorder.OnDrop(FlightRecorder::PhyDrops, dir, Simulator::Now().GetNanoSeconds())) {
+        FlightTrigger(FlightRecorder::PhyDrops, dir);
+    }
+}
+
+static void FlowSeriesRxCallback(uint32_t series, Ptr<const Packet> p, const Address& from) {
+    g_flowSeries.Add(series, Simulator::Now().GetSeconds(), p->GetSize());
+}
+
+static void AppTxCallback(Ptr<const Packet> p) { g_drain.appTx++; }
+static void SinkRxCallback(Ptr<const Packet> p, const Address& from) { g_drain.sinkRx++; }
+static void DeviceDropCallback(Ptr<const Packet> p) { g_drain.dropped++; }
+static void Ipv4DropCallback(const Ipv4Header& header, Ptr<const Packet> p, Ipv4L3Protocol::DropReason reason,
+                             Ptr<Ipv4> ipv4, uint32_t iface) {
+    g_drain.dropped++;
+}
+
+static bool AllQueuesEmpty() {
+    for (const auto& entry : g_monitoredLinks) {
+        if (!entry.device) continue;
+        Ptr<Queue<Packet>> queue = entry.device->GetQueue();
+        if (queue && queue->GetNPackets() > 0) return false;
+    }
+    return true;
+}
+
+// 在当前时刻创建一个需求的接收与发送应用，开始/结束时间换算为相对当前时刻
+static ActiveApps InstallDemandApps(const DemandApp& app) {
+    double now = Simulator::Now().GetSeconds();
+    PacketSinkHelper sink("ns3::UdpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), app.port));
+    ApplicationContainer sinkApps = sink.Install(g_nodes.Get(app.dst));
+    sinkApps.Start(Seconds(0.0));
+    if (!g_apps.lazy) sinkApps.Stop(Seconds(g_apps.simTime));
+    if (app.series >= 0) {
+        sinkApps.Get(0)->TraceConnectWithoutContext("Rx", MakeBoundCallback(&FlowSeriesRxCallback,
+                                                                            static_cast<uint32_t>(app.series)));
+    }
+    if (g_hops.every) {
+        sinkApps.Get(0)->TraceConnectWithoutContext("Rx", MakeBoundCallback(&HopSampleRxCallback, app.flow));
+    }
+    if (g_replay.active) {
+        Ptr<Socket> socket = Socket::CreateSocket(g_nodes.Get(app.src), UdpSocketFactory::GetTypeId());
+        socket->Bind();
+        socket->Connect(InetSocketAddress(g_nodeFirstIp[app.dst], app.port));
+        g_replay.sockets.push_back(socket);
+        if (app.subflowGroup >= 0) sinkApps.Get(0)->TraceConnectWithoutContext("Rx", MakeCallback(&SubFlowRxCallback));
+        return {nullptr, DynamicCast<PacketSink>(sinkApps.Get(0))};
+    }
 
-DijkstraResult Dijkstra(uint32_t src, uint32_t numNodes) {
-    DijkstraResult result;
-    result.dist.assign(numNodes, std::numeric_limits<double>::infinity());
-    result.prev.assign(numNodes, -1);
-    result.dist[src] = 0;
-    std::priority_queue<std::pair<double, uint32_t>, std::vector<std::pair<double, uint32_t>>, std::greater<std::pair<double, uint32_t>>> pq;
-    pq.push({0, src});
-    while (!pq.empty()) {
-        auto [d, u] = pq.top(); pq.pop();
-        if (d > result.dist[u]) continue;
-        for (auto& [v, w] : g_adjList[u]) {
-            if (result.dist[u] + w < result.dist[v]) {
-                result.dist[v] = result.dist[u] + w;
-                result.prev[v] = u;
-                pq.push({result.dist[v], v});
+    std::ostringstream rateStr;
+    rateStr << app.rateMbps << "Mbps";
+    InetSocketAddress remote(g_nodeFirstIp[app.dst], app.port);
+    ApplicationContainer clientApps;
+    if (app.subflowGroup >= 0) {
+        // OnOff 在 socket 发送副本之后才触发 "Tx"，合并需求改用先触发再发送的 SubFlowSender
+        Ptr<SubFlowSender> sender = CreateObject<SubFlowSender>();
+        sender->SetAttribute("Remote", AddressValue(remote));
+        sender->SetAttribute("DataRate", StringValue(rateStr.str()));
+        sender->SetAttribute("PacketSize", UintegerValue(g_apps.packetSize));
+        sender->SetAttribute("OnTime", StringValue(g_apps.onTime));
+        sender->SetAttribute("OffTime", StringValue(g_apps.offTime));
+        g_nodes.Get(app.src)->AddApplication(sender);
+        clientApps.Add(sender);
+    } else {
+        OnOffHelper onoff("ns3::UdpSocketFactory", remote);
+        onoff.SetAttribute("DataRate", StringValue(rateStr.str()));
+        onoff.SetAttribute("PacketSize", UintegerValue(g_apps.packetSize));
+        onoff.SetAttribute("OnTime", StringValue(g_apps.onTime));
+        onoff.SetAttribute("OffTime", StringValue(g_apps.offTime));
+        clientApps = onoff.Install(g_nodes.Get(app.src));
+    }
+    clientApps.Start(Seconds(std::max(app.startSec - now, 0.0)));
+    clientApps.Stop(Seconds(std::max(app.endSec - now, 0.0)));
+    if (app.subflowGroup >= 0) {
+        clientApps.Get(0)->TraceConnectWithoutContext("Tx", MakeBoundCallback(&SubFlowTxCallback,
+                                                                              static_cast<uint32_t>(app.subflowGroup)));
+        sinkApps.Get(0)->TraceConnectWithoutContext("Rx", MakeCallback(&SubFlowRxCallback));
+    }
+    if (g_apps.drainTraces) {
+        clientApps.Get(0)->TraceConnectWithoutContext("Tx", MakeCallback(&AppTxCallback));
+        sinkApps.Get(0)->TraceConnectWithoutContext("Rx", MakeCallback(&SinkRxCallback));
+    }
+    return {clientApps.Get(0), DynamicCast<PacketSink>(sinkApps.Get(0))};
+}
+
+void TraceReplayStep() {
+    uint64_t nowNs = static_cast<uint64_t>(Simulator::Now().GetNanoSeconds()) - g_replay.startNs;
+    while (g_replay.hasNext && g_replay.next.timeNs <= nowNs) {
+        const TraceEvent& ev = g_replay.next;
+        auto it = g_replay.demandToSocket.find(ev.demandId);
+        if (it == g_replay.demandToSocket.end()) {
+            g_replay.unmatched++;
+        } else {
+            // 轨迹记录的是 IP 分组长度，扣除 UDP/IP 头作为载荷
+            Ptr<Packet> packet = Create<Packet>(ev.size > 28 ? ev.size - 28 : 0);
+            if (g_replay.tagSubflows) {
+                uint32_t demand = g_replay.demandToIndex[ev.demandId];
+                SubFlowStats& st = g_subflows.stats[demand];
+                if (st.firstTxSec < 0) st.firstTxSec = Simulator::Now().GetSeconds();
+                st.txPackets++;
+                packet->AddPacketTag(SubFlowTag(demand, Simulator::Now()));
             }
+            g_replay.sockets[it->second]->Send(packet);
+            g_replay.sent++;
+            g_drain.appTx++;
         }
+        g_replay.hasNext = g_replay.reader.Next(g_replay.next);
+    }
+    g_replay.batches++;
+    if (g_replay.hasNext) {
+        uint64_t wait = std::max(g_replay.next.timeNs - nowNs, g_replay.batchNs);
+        Simulator::Schedule(NanoSeconds(wait), &TraceReplayStep);
     }
-    return result;
-}
-
-std::vector<uint32_t> GetPath(uint32_t src, uint32_t dst, const DijkstraResult& dijkstra) {
-    std::vector<uint32_t> path;
-    if (dijkstra.dist[dst] == std::numeric_limits<double>::infinity()) return path;
-    for (int at = dst; at != -1; at = dijkstra.prev[at]) path.push_back(at);
-    std::reverse(path.begin(), path.end());
-    return path;
-}
-
-// ==================== 加载数据 ====================
-
-bool LoadLinks(const std::string& file) {
-    std::ifstream f(file.c_str());
-    if (!f.is_open()) { std::cerr << "Cannot open: " << file << std::endl; return false; }
-    std::string line; std::getline(f, line); 
-    while (std::getline(f, line)) {
-        if (Trim(line).empty()) continue;
-        std::stringstream ss(line); std::string tok; LinkParam p;
-        try {
-            std::getline(ss, tok, ','); p.srcId = std::stoul(Trim(tok));
-            std::getline(ss, tok, ','); p.dstId = std::stoul(Trim(tok));
-            std::getline(ss, tok, ','); p.srcName = Trim(tok);
-            std::getline(ss, tok, ','); p.dstName = Trim(tok);
-            std::getline(ss, tok, ','); p.delayMs = std::stod(Trim(tok));
-            std::getline(ss, tok, ','); p.dataRateBps = std::stoull(Trim(tok));
-            if (std::getline(ss, tok, ',')) p.packetLossRate = std::stod(Trim(tok)); else p.packetLossRate = 0;
-            if (std::getline(ss, tok, ',')) p.distanceKm = std::stod(Trim(tok)); else p.distanceKm = 0;
-            if (p.delayMs <= 0) p.delayMs = 1.0;
-            if (p.dataRateBps < 1000) p.dataRateBps = 1000000;
-            g_links.push_back(p);
-            g_nodeIdToName[p.srcId] = p.srcName; g_nodeIdToName[p.dstId] = p.dstName;
-            uint32_t m = std::max(p.srcId, p.dstId) + 1;
-            if (m > g_numNodes) g_numNodes = m;
-        } catch (...) { continue; }
-    }
-    f.close();
-    g_adjList.resize(g_numNodes);
-    for (const auto& link : g_links) {
-        g_adjList[link.srcId].push_back({link.dstId, link.delayMs});
-        g_adjList[link.dstId].push_back({link.srcId, link.delayMs});
-    }
-    std::cout << "Loaded " << g_links.size() << " links\n";
-    return !g_links.empty();
-}
-
-bool LoadDemands(const std::string& file) {
-    std::ifstream f(file.c_str());
-    if (!f.is_open()) return false;
-    std::string line; std::getline(f, line);
-    while (std::getline(f, line)) {
-        if (Trim(line).empty()) continue;
-        std::stringstream ss(line); std::string tok; TrafficDemand d;
-        try {
-            std::getline(ss, tok, ','); d.demandId = std::stoul(Trim(tok));
-            std::getline(ss, tok, ','); d.srcNode = Trim(tok);
-            std::getline(ss, tok, ','); d.dstNode = Trim(tok);
-            std::getline(ss, tok, ','); d.srcId = std::stoul(Trim(tok));
-            std::getline(ss, tok, ','); d.dstId = std::stoul(Trim(tok));
-            std::getline(ss, tok, ','); d.dataRateMbps = std::stod(Trim(tok));
-            std::getline(ss, tok, ','); d.startTimeSec = std::stod(Trim(tok));
-            std::getline(ss, tok, ','); d.durationSec = std::stod(Trim(tok));
-            g_demands.push_back(d);
-        } catch (...) { continue; }
-    }
-    f.close();
-    std::cout << "Loaded " << g_demands.size() << " traffic demands\n";
-    return !g_demands.empty();
+}
+
+static void TcpFill(uint32_t i, Ptr<Socket> socket, uint32_t available) {
+    TcpFlow& f = g_tcp.flows[i];
+    if (f.closed) return;
+    while (available > 0 && (f.bytes == 0 || f.sent < f.bytes)) {
+        uint32_t chunk = available;
+        if (f.bytes) chunk = static_cast<uint32_t>(std::min<uint64_t>(chunk, f.bytes - f.sent));
+        int n = socket->Send(Create<Packet>(chunk));
+        if (n <= 0) break;
+        f.sent += n;
+        available -= n;
+    }
+    // 数据全部进入发送缓冲区后发 FIN
+    if (f.bytes && f.sent >= f.bytes) {
+        socket->Close();
+        f.closed = true;
+    }
+}
+
+static void TcpFlowDone(TcpFlow& f) {
+    if (f.done) return;
+    f.done = true;
+    g_tcp.open--;
+}
+
+static void TcpConnected(uint32_t i, Ptr<Socket> socket) {
+    TcpFill(i, socket, socket->GetTxAvailable());
+}
+
+// 连接失败：流不会再有进展，记为未完成并释放 socket
+static void TcpConnectFailed(uint32_t i, Ptr<Socket> socket) {
+    TcpFlow& f = g_tcp.flows[i];
+    NS_LOG_WARN("TCP flow " << f.demandIds << " failed to connect");
+    f.failed = true;
+    f.closed = true;
+    TcpFlowDone(f);
+    if (f.listening) f.listening->Close();
+    f.tx = f.rx = f.listening = nullptr;
+}
+
+// 发送端异常关闭 (重传耗尽等)：同样记为未完成
+static void TcpSenderError(uint32_t i, Ptr<Socket> socket) {
+    TcpFlow& f = g_tcp.flows[i];
+    if (f.done) return;
+    NS_LOG_WARN("TCP flow " << f.demandIds << " closed with error");
+    f.failed = true;
+    f.closed = true;
+    TcpFlowDone(f);
+}
+
+// 接收端收到 FIN 时之前的数据已全部按序交付：bulk 流在此结束
+static void TcpPeerClosed(uint32_t i, Ptr<Socket> socket) {
+    TcpFlow& f = g_tcp.flows[i];
+    if (f.done) return;
+    TcpFlowDone(f);
+    socket->Close();
+    if (f.listening) f.listening->Close();
+    f.tx = f.rx = f.listening = nullptr;
+}
+
+static void TcpTx(uint32_t i, Ptr<const Packet> packet, const TcpHeader& header, Ptr<const TcpSocketBase> socket) {
+    if (packet->GetSize() == 0) return;
+    TcpFlow& f = g_tcp.flows[i];
+    SequenceNumber32 end = header.GetSequenceNumber() + packet->GetSize();
+    if (f.anyTx && header.GetSequenceNumber() < f.highestTx) {
+        f.retransmissions++;
+    } else {
+        f.highestTx = end;
+        f.anyTx = true;
+    }
+}
+
+static void TcpRecv(uint32_t i, Ptr<Socket> socket) {
+    TcpFlow& f = g_tcp.flows[i];
+    Ptr<Packet> packet;
+    while ((packet = socket->Recv())) {
+        if (packet->GetSize() == 0) break;
+        f.received += packet->GetSize();
+        if (f.series >= 0) g_flowSeries.Add(f.series, Simulator::Now().GetSeconds(), packet->GetSize());
+    }
+    f.lastRxSec = Simulator::Now().GetSeconds();
+    if (f.bytes && f.received >= f.bytes && f.completeSec < 0) {
+        f.completeSec = f.lastRxSec;
+        TcpFlowDone(f);
+        socket->Close();
+        f.listening->Close();
+        f.tx = f.rx = f.listening = nullptr;
+    }
+}
+
+static void TcpAccept(uint32_t i, Ptr<Socket> socket, const Address& from) {
+    g_tcp.flows[i].rx = socket;
+    socket->SetRecvCallback(MakeBoundCallback(&TcpRecv, i));
+    socket->SetCloseCallbacks(MakeBoundCallback(&TcpPeerClosed, i), MakeBoundCallback(&TcpPeerClosed, i));
+}
+
+void TcpStart(uint32_t i) {
+    TcpFlow& f = g_tcp.flows[i];
+    f.listening = Socket::CreateSocket(g_nodes.Get(f.dst), TcpSocketFactory::GetTypeId());
+    f.listening->Bind(InetSocketAddress(Ipv4Address::GetAny(), f.port));
+    f.listening->Listen();
+    f.listening->SetAcceptCallback(MakeNullCallback<bool, Ptr<Socket>, const Address&>(),
+                                   MakeBoundCallback(&TcpAccept, i));
+
+    f.tx = Socket::CreateSocket(g_nodes.Get(f.src), TcpSocketFactory::GetTypeId());
+    f.tx->TraceConnectWithoutContext("Tx", MakeBoundCallback(&TcpTx, i));
+    f.tx->Bind();
+    f.tx->SetConnectCallback(MakeBoundCallback(&TcpConnected, i), MakeBoundCallback(&TcpConnectFailed, i));
+    f.tx->SetSendCallback(MakeBoundCallback(&TcpFill, i));
+    f.tx->SetCloseCallbacks(MakeNullCallback<void, Ptr<Socket>>(), MakeBoundCallback(&TcpSenderError, i));
+    f.tx->Connect(InetSocketAddress(g_nodeFirstIp[f.dst], f.port));
+}
+
+void TcpStopBulk(uint32_t i) {
+    TcpFlow& f = g_tcp.flows[i];
+    if (f.tx && !f.closed) f.tx->Close();
+    f.closed = true;
+}
+
+// OnOff 在 endSec 已停止并关闭 socket；接收端先关闭监听 socket 再释放
+void ReleaseDemandApps(uint32_t slot) {
+    ActiveApps& apps = g_apps.slots[slot];
+    Ptr<Socket> listening = apps.sink->GetListeningSocket();
+    if (listening) listening->Close();
+    apps.sink->Dispose();
+    apps.sender->Dispose();
+    g_ports.Release(apps.dst, apps.port);
+    apps = ActiveApps();
+    g_apps.freeSlots.push_back(slot);
+    g_apps.active--;
+}
+
+// 创建开始时刻落在 [now, now + window] 内的需求，然后在下一个需求进入窗口时再调度
+void LazyAppStep() {
+    double now = Simulator::Now().GetSeconds();
+    while (g_apps.next < g_apps.pending.size() && g_apps.pending[g_apps.next].startSec <= now + g_apps.window) {
+        DemandApp& app = g_apps.pending[g_apps.next++];
+        app.port = g_ports.Take(app.dst);
+        if (app.port == 0) {
+            std::cerr << "❌ 目的节点 " << GetNodeName(app.dst) << " 上同时存在的需求组超过 "
+                      << (PortAllocator::kLastPort - PortAllocator::kFirstPort + 1) << " 个，端口已用尽" << std::endl;
+            g_apps.portsExhausted = true;
+            Simulator::Stop();
+            return;
+        }
+        g_steady.portToFlow[FlowKey(g_nodeFirstIp[app.dst], app.port)].emplace_back(now, app.flow);
+        uint32_t slot;
+        if (!g_apps.freeSlots.empty()) {
+            slot = g_apps.freeSlots.back();
+            g_apps.freeSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(g_apps.slots.size());
+            g_apps.slots.emplace_back();
+        }
+        g_apps.slots[slot] = InstallDemandApps(app);
+        g_apps.slots[slot].dst = app.dst;
+        g_apps.slots[slot].port = app.port;
+        g_apps.peakActive = std::max(g_apps.peakActive, ++g_apps.active);
+        Simulator::Schedule(Seconds(std::max(app.releaseSec - now, 0.0)), &ReleaseDemandApps, slot);
+    }
+    if (g_apps.next < g_apps.pending.size()) {
+        double at = g_apps.pending[g_apps.next].startSec - g_apps.window;
+        Simulator::Schedule(Seconds(at - now), &LazyAppStep);
+    }
+}
+
+// 在最后一个需求结束后开始调度，之前不产生额外事件
+void CheckDrained(double interval) {
+    double now = Simulator::Now().GetSeconds();
+    if (!AllQueuesEmpty()) {
+        g_drain.emptySince = -1;
+    } else {
+        if (g_drain.emptySince < 0) g_drain.emptySince = now;
+        // TCP 流不计入 appTx，由 g_tcp.open 覆盖 (含 bulk 流，直到接收端收到 FIN)
+        bool balanced = g_drain.sinkRx + g_drain.dropped >= g_drain.appTx && g_tcp.open == 0;
+        // 兜底超时按单程路径时延设置；TCP 流等待 ACK 或 RTO 退避时队列可以空得更久，
+        // 仍有未完成的 TCP 流时不走兜底，运行到收齐或 simTime 为止
+        bool timedOut = g_tcp.open == 0 && now - g_drain.emptySince >= g_drain.drainTimeout;
+        if (balanced || timedOut) {
+            g_drain.cutoffTime = now;
+            Simulator::Stop();
+            return;
+        }
+    }
+    Simulator::Schedule(Seconds(interval), &CheckDrained, interval);
+}
+
+void SteadyStateBatch() {
+    double now = Simulator::Now().GetSeconds();
+    double batchStart = now - g_steady.interval;
+    ConvergenceMonitor& cm = *g_steady.monitor;
+
+    cm.BeginBatch();
+    for (const auto& [id, st] : g_steady.flowMonitor->GetFlowStats()) {
+        auto mapped = g_steady.flowIdToFlow.find(id);
+        if (mapped == g_steady.flowIdToFlow.end()) {
+            Ipv4FlowClassifier::FiveTuple t = g_steady.classifier->FindFlow(id);
+            int64_t flow = LookupFlow(t.destinationAddress, t.destinationPort, st.timeFirstTxPacket.GetSeconds());
+            if (flow < 0) continue;
+            mapped = g_steady.flowIdToFlow.emplace(id, static_cast<uint32_t>(flow)).first;
+            g_steady.flows[flow].seen = true;
+        }
+        uint32_t idx = mapped->second;
+        SteadyStateFlow& f = g_steady.flows[idx];
+        uint64_t dBytes = st.rxBytes - f.lastRxBytes;
+        uint64_t dPackets = st.rxPackets - f.lastRxPackets;
+        double delaySumMs = st.delaySum.GetSeconds() * 1000.0;
+        double dDelayMs = delaySumMs - f.lastDelaySumMs;
+        f.lastRxBytes = st.rxBytes;
+        f.lastRxPackets = st.rxPackets;
+        f.lastDelaySumMs = delaySumMs;
+
+        // 只记录整批都处在发送时段内的批
+        if (f.startSec > batchStart || f.endSec < now) continue;
+        cm.AddThroughput(idx, dBytes * 8.0 / g_steady.interval / 1e6);
+        if (dPackets > 0) cm.AddDelay(idx, dDelayMs / dPackets, dPackets);
+    }
+    // 已在发送但还没有分组到达的需求吞吐量记为 0
+    for (uint32_t i = 0; i < g_steady.flows.size(); ++i) {
+        const SteadyStateFlow& f = g_steady.flows[i];
+        if (!f.seen && f.startSec <= batchStart && f.endSec >= now) cm.AddThroughput(i, 0);
+    }
+    cm.EndBatch();
+    cm.Evaluate();
+
+    bool done = now >= g_steady.lastDemandStart;
+    bool anyActive = false;
+    for (uint32_t i = 0; i < g_steady.flows.size() && done; ++i) {
+        if (g_steady.flows[i].endSec <= now) continue;
+        anyActive = true;
+        if (!cm.GetEstimate(i).converged) done = false;
+    }
+    if (done && anyActive) {
+        g_steady.stopTime = now;
+        Simulator::Stop();
+        return;
+    }
+    Simulator::Schedule(Seconds(g_steady.interval), &SteadyStateBatch);
+}
+
+void SaveSteadyState(const std::string& file) {
+    OutputFile f;
+    f.Open(file, g_results.gzip);
+    f << "DemandId,SrcNode,DstNode,Batches,BatchSize,Throughput_Mbps,Throughput_CI_Mbps,"
+      << "MeanDelay_ms,MeanDelay_CI_ms,Converged\n";
+    for (uint32_t i = 0; i < g_steady.flows.size(); ++i) {
+        const TrafficDemand& d = g_demands[g_steady.flows[i].demandIndex];
+        FlowEstimate e = g_steady.monitor->GetEstimate(i);
+        f << g_steady.flows[i].demandIds << "," << d.srcNode << "," << d.dstNode << ","
+          << e.throughput.batches << "," << e.throughput.batchSize << ","
+          << std::fixed << std::setprecision(6)
+          << e.throughput.mean << "," << (e.throughput.valid ? e.throughput.halfWidth : 0) << ","
+          << e.delay.mean << "," << (e.delay.valid ? e.delay.halfWidth : 0) << ","
+          << (e.converged ? 1 : 0) << "\n";
+    }
+    f.Close();
 }
 
 std::string GetSatelliteName(const Ipv4Address& addr) {
@@ -217,15 +861,26 @@ std::string GetSatelliteName(const Ipv4Address& addr) {
     auto it = g_ipToSatellite.find(oss.str());
     return (it != g_ipToSatellite.end()) ? it->second : "Unknown";
 }
-std::string GetNodeName(uint32_t nodeId) {
-    auto it = g_nodeIdToName.find(nodeId);
-    return (it != g_nodeIdToName.end()) ? it->second : "Node_" + std::to_string(nodeId);
-}
 
-void SaveResults(const std::string& file, Ptr<FlowMonitor> mon, Ptr<Ipv4FlowClassifier> cls) {
-    std::ofstream f(file.c_str());
-    f << "FlowId,SrcAddr,DstAddr,SrcSatellite,DstSatellite,TxPackets,RxPackets,LostPackets,"
-      << "Throughput_Mbps,MeanDelay_ms,MeanJitter_ms,PacketLossRate\n";
+void SaveResults(const std::string& file, Ptr<FlowMonitor> mon, Ptr<Ipv4FlowClassifier> cls, double simEndTime) {
+    OutputFile f;
+    if (g_results.csv) {
+        f.Open(file, g_results.gzipMerged);
+        f << "FlowId,SrcAddr,DstAddr,SrcSatellite,DstSatellite,TxPackets,RxPackets,LostPackets,"
+          << "Throughput_Mbps,MeanDelay_ms,MeanJitter_ms,PacketLossRate,SimEndTime_s,"
+          << "SS_Throughput_Mbps,SS_Throughput_CI_Mbps,SS_MeanDelay_ms,SS_MeanDelay_CI_ms,DemandId\n";
+    }
+    ColumnarWriter col;
+    if (g_results.columnar) {
+        const auto U = ColumnarWriter::UInt64, F = ColumnarWriter::Float64, S = ColumnarWriter::String;
+        col.Open(ColumnarPath(file),
+                 {{"FlowId", U}, {"SrcAddr", S}, {"DstAddr", S}, {"SrcSatellite", S}, {"DstSatellite", S},
+                  {"TxPackets", U}, {"RxPackets", U}, {"LostPackets", U}, {"Throughput_Mbps", F},
+                  {"MeanDelay_ms", F}, {"MeanJitter_ms", F}, {"PacketLossRate", F}, {"SimEndTime_s", F},
+                  {"SS_Throughput_Mbps", F}, {"SS_Throughput_CI_Mbps", F}, {"SS_MeanDelay_ms", F},
+                  {"SS_MeanDelay_CI_ms", F}, {"DemandId", S}},
+                 g_results.zlib);
+    }
     FlowMonitor::FlowStatsContainer stats = mon->GetFlowStats();
     for (auto it = stats.begin(); it != stats.end(); ++it) {
         Ipv4FlowClassifier::FiveTuple t = cls->FindFlow(it->first);
@@ -238,27 +893,149 @@ void SaveResults(const std::string& file, Ptr<FlowMonitor> mon, Ptr<Ipv4FlowClas
             dl = it->second.delaySum.GetMilliSeconds() / it->second.rxPackets;
             jt = it->second.jitterSum.GetMilliSeconds() / it->second.rxPackets;
         }
-        f << it->first << "," << t.sourceAddress << "," << t.destinationAddress << ","
-          << GetSatelliteName(t.sourceAddress) << "," << GetSatelliteName(t.destinationAddress) << ","
-          << it->second.txPackets << "," << it->second.rxPackets << "," << lost << ","
-          << std::fixed << std::setprecision(6) << tp << "," << dl << "," << jt << "," << pl << "\n";
+        // 稳态估计 (--steadyState)：去掉预热期后的批均值及置信区间半宽，未启用时留空 (列式为 NaN)
+        auto ss = g_steady.flowIdToFlow.find(it->first);
+        bool hasSs = g_steady.monitor && ss != g_steady.flowIdToFlow.end();
+        FlowEstimate e;
+        if (hasSs) e = g_steady.monitor->GetEstimate(ss->second);
+        // FlowId 按首包顺序分配，副本之间不一致；按目的地址和端口对应回需求编号
+        int64_t flow = LookupFlow(t.destinationAddress, t.destinationPort, it->second.timeFirstTxPacket.GetSeconds());
+        std::string demandIds = flow >= 0 ? g_steady.flows[flow].demandIds : "";
+        if (g_results.csv) {
+            f << it->first << "," << t.sourceAddress << "," << t.destinationAddress << ","
+              << GetSatelliteName(t.sourceAddress) << "," << GetSatelliteName(t.destinationAddress) << ","
+              << it->second.txPackets << "," << it->second.rxPackets << "," << lost << ","
+              << std::fixed << std::setprecision(6) << tp << "," << dl << "," << jt << "," << pl << ","
+              << simEndTime;
+            if (hasSs) {
+                f << "," << e.throughput.mean << "," << (e.throughput.valid ? e.throughput.halfWidth : 0)
+                  << "," << e.delay.mean << "," << (e.delay.valid ? e.delay.halfWidth : 0);
+            } else {
+                f << ",,,,";
+            }
+            f << "," << demandIds << "\n";
+        }
+        if (col.IsOpen()) {
+            std::ostringstream srcAddr, dstAddr;
+            srcAddr << t.sourceAddress;
+            dstAddr << t.destinationAddress;
+            double nan = std::numeric_limits<double>::quiet_NaN();
+            col.UInt(it->first).Str(srcAddr.str()).Str(dstAddr.str())
+               .Str(GetSatelliteName(t.sourceAddress)).Str(GetSatelliteName(t.destinationAddress))
+               .UInt(it->second.txPackets).UInt(it->second.rxPackets).UInt(lost)
+               .Float(tp).Float(dl).Float(jt).Float(pl).Float(simEndTime)
+               .Float(hasSs ? e.throughput.mean : nan).Float(hasSs ? (e.throughput.valid ? e.throughput.halfWidth : 0) : nan)
+               .Float(hasSs ? e.delay.mean : nan).Float(hasSs ? (e.delay.valid ? e.delay.halfWidth : 0) : nan)
+               .Str(demandIds).EndRow();
+        }
     }
-    f.close();
+    if (g_results.csv) f.Close();
+    col.Close();
 }
 
-void SaveLinkStats(const std::string& file) {
-    std::ofstream f(file.c_str());
-    f << "SrcNode,DstNode,TxPackets,RxPackets,LostPackets,PacketLossRate\n";
-    for (size_t i = 0; i < g_links.size(); ++i) {
-        const auto& lp = g_links[i];
-        const auto& st = g_linkStats[i];
-        uint64_t lost = (st.txPackets >= st.rxPackets) ? (st.txPackets - st.rxPackets) : 0;
-        double plr = (st.txPackets > 0) ? (double)lost / st.txPackets : 0.0;
-        f << lp.srcName << "," << lp.dstName << ","
-          << st.txPackets << "," << st.rxPackets << "," << lost << ","
-          << std::fixed << std::setprecision(6) << plr << "\n";
+// 与 LinkCounters 下标一致的 "src->dst" 标签
+static std::vector<std::string> LinkDirectionLabels() {
+    std::vector<std::string> labels;
+    for (const auto& link : g_links) {
+        labels.push_back(link.srcName + "->" + link.dstName);
+        labels.push_back(link.dstName + "->" + link.srcName);
     }
-    f.close();
+    return labels;
+}
+
+static std::vector<std::string> FlowLabels() {
+    std::vector<std::string> labels;
+    for (const auto& flow : g_steady.flows) labels.push_back(flow.demandIds);
+    return labels;
+}
+
+// 每个方向一行；忙碌时间为实测的 PhyTxBegin -> PhyTxEnd 时长之和，仿真结束时仍在发送的分组
+// 计到 simEndTime
+void SaveLinkStats(const std::string& file, double simEndTime) {
+    OutputFile f;
+    if (g_results.csv) {
+        f.Open(file, g_results.gzip);
+        f << "SrcNode,DstNode,TxPackets,TxBytes,RxPackets,RxBytes,LostPackets,PacketLossRate,"
+          << "QueueDrops,PhyDrops,BusyTime_s,Utilization\n";
+    }
+    ColumnarWriter col;
+    if (g_results.columnar) {
+        const auto U = ColumnarWriter::UInt64, F = ColumnarWriter::Float64, S = ColumnarWriter::String;
+        col.Open(ColumnarPath(file),
+                 {{"SrcNode", S}, {"DstNode", S}, {"TxPackets", U}, {"TxBytes", U}, {"RxPackets", U},
+                  {"RxBytes", U}, {"LostPackets", U}, {"PacketLossRate", F}, {"QueueDrops", U}, {"PhyDrops", U},
+                  {"BusyTime_s", F}, {"Utilization", F}},
+                 g_results.zlib);
+    }
+    const LinkCounters& c = g_linkCounters;
+    for (size_t dir = 0; dir < c.txPackets.size(); ++dir) {
+        const auto& lp = g_links[dir / 2];
+        bool forward = dir % 2 == 0;
+        uint64_t lost = (c.txPackets[dir] >= c.rxPackets[dir]) ? (c.txPackets[dir] - c.rxPackets[dir]) : 0;
+        double plr = (c.txPackets[dir] > 0) ? (double)lost / c.txPackets[dir] : 0.0;
+        double busy = c.busyNs[dir] / 1e9;
+        if (c.txBeginNs[dir] >= 0) busy += std::max(0.0, simEndTime - c.txBeginNs[dir] / 1e9);
+        double utilization = simEndTime > 0 ? busy / simEndTime : 0.0;
+        const std::string& src = forward ? lp.srcName : lp.dstName;
+        const std::string& dst = forward ? lp.dstName : lp.srcName;
+        if (g_results.csv) {
+            f << src << "," << dst << ","
+              << c.txPackets[dir] << "," << c.txBytes[dir] << "," << c.rxPackets[dir] << "," << c.rxBytes[dir] << ","
+              << lost << "," << std::fixed << std::setprecision(6) << plr << ","
+              << c.queueDrops[dir] << "," << c.phyDrops[dir] << "," << busy << "," << utilization << "\n";
+        }
+        if (col.IsOpen()) {
+            col.Str(src).Str(dst).UInt(c.txPackets[dir]).UInt(c.txBytes[dir]).UInt(c.rxPackets[dir])
+               .UInt(c.rxBytes[dir]).UInt(lost).Float(plr).UInt(c.queueDrops[dir]).UInt(c.phyDrops[dir])
+               .Float(busy).Float(utilization).EndRow();
+        }
+    }
+    if (g_results.csv) f.Close();
+    col.Close();
+}
+
+void SaveDemandResults(const std::string& file) {
+    OutputFile f;
+    f.Open(file, g_results.gzip);
+    f << "DemandId,SrcNode,DstNode,GroupSize,TxPackets,RxPackets,LostPackets,"
+      << "Throughput_Mbps,MeanDelay_ms,PacketLossRate\n";
+    for (size_t g = 0; g < g_subflows.members.size(); ++g) {
+        for (uint32_t k : g_subflows.members[g]) {
+            const TrafficDemand& d = g_demands[k];
+            const SubFlowStats& st = g_subflows.stats[k];
+            uint64_t lost = (st.txPackets > st.rxPackets) ? (st.txPackets - st.rxPackets) : 0;
+            double tp = 0, dl = 0, pl = 0;
+            if (st.txPackets > 0) pl = (double)lost / st.txPackets;
+            if (st.rxPackets > 0) {
+                double dur = st.lastRxSec - st.firstTxSec;
+                if (dur > 0) tp = st.rxBytes * 8.0 / dur / 1e6;
+                dl = st.delaySumSec * 1000.0 / st.rxPackets;
+            }
+            f << d.demandId << "," << d.srcNode << "," << d.dstNode << "," << g_subflows.members[g].size() << ","
+              << st.txPackets << "," << st.rxPackets << "," << lost << ","
+              << std::fixed << std::setprecision(6) << tp << "," << dl << "," << pl << "\n";
+        }
+    }
+    f.Close();
+}
+
+// 未完成的流按 simEndTime 计算吞吐，FCT 留空
+void SaveTcpFlows(const std::string& file, double simEndTime) {
+    OutputFile f;
+    f.Open(file, g_results.gzip);
+    f << "DemandId,SrcNode,DstNode,FlowBytes,ReceivedBytes,StartTime_s,CompletionTime_s,FCT_ms,"
+      << "Goodput_Mbps,Retransmissions,Completed\n";
+    for (const TcpFlow& flow : g_tcp.flows) {
+        bool completed = !flow.failed && (flow.bytes ? flow.completeSec >= 0 : flow.received > 0);
+        double end = flow.completeSec >= 0 ? flow.completeSec : std::min(flow.bytes ? simEndTime : flow.endSec, simEndTime);
+        double goodput = end > flow.startSec ? flow.received * 8.0 / (end - flow.startSec) / 1e6 : 0;
+        f << flow.demandIds << "," << GetNodeName(flow.src) << "," << GetNodeName(flow.dst) << ","
+          << flow.bytes << "," << flow.received << "," << std::fixed << std::setprecision(6) << flow.startSec << ",";
+        if (flow.completeSec >= 0) f << flow.completeSec << "," << (flow.completeSec - flow.startSec) * 1000.0;
+        else f << ",";
+        f << "," << goodput << "," << flow.retransmissions << "," << (completed ? 1 : 0) << "\n";
+    }
+    f.Close();
 }
 
 // ==================== 主函数 ====================
@@ -266,34 +1043,532 @@ int main(int argc, char *argv[]) {
     std::string linkFile = "scratch/starlink/data/input/link_params.csv";
     std::string demandFile = "scratch/starlink/data/input/traffic_demands.csv";
     std::string outFile = "scratch/starlink/data/output/flow_results.csv";
+    std::string outDir = "scratch/starlink/data/output";
+    std::string perfFile;
     double simTime = 10.0;
+    bool perfCounters = false;
+    double perfSampleInterval = 0.5;
+    bool eventProfile = false;
+    uint32_t eventProfileTopN = 20;
+    uint32_t eventProfileSample = 64;
+    std::string schedulerType;
+    std::string schedulerTrace;
+    std::string schedulerBench;
+    bool allocPool = false;
+    bool setupArena = false;
+    bool earlyStop = true;
+    double drainCheckInterval = 0.01;
+    bool steadyState = false;
+    double batchInterval = 0.1;
+    double ssPrecision = 0.05;
+    double ssConfidence = 0.95;
+    uint32_t ssMinBatches = 10;
+    uint32_t replications = 1;
+    uint32_t jobs = 0;
+    uint32_t runBase = 1;
+    uint32_t queueSize = 500;
+    uint32_t packetSize = 1024;
+    double onTimeMean = 1.0;
+    double offTimeMean = 0.5;
+    double demandScale = 1.0;
+    std::string routing = "delay";
+    std::string sweep;
+    std::string sweepMode = "grid";
+    uint32_t sweepSamples = 16;
+    uint32_t sweepSeed = 1;
+    bool surrogate = false;
+    bool surrogateOnly = false;
+    std::string surrogateModel = "md1k";
+    std::string validation = "flag";
+    bool aggregateDemands = false;
+    double aggregateTolerance = 0.0;
+    bool lazyApps = false;
+    double timeSeriesBin = 0;
+    uint32_t hopSample = 0;
+    bool flightRecorder = false;
+    std::string resultFormat = "csv";
+    FlightRecorderConfig flightConfig;
+    uint32_t timeSeriesRing = 64;
+    std::string transport = "udp";
+    std::string tcpCongestion = "cubic";
+    bool tcpBulk = false;
+    uint32_t tcpBufferKB = 0;
+    std::string trafficTrace;
+    double traceStart = 1.0;
+    double traceBatch = 1e-4;
+    std::string traceConvert;
+    std::string traceOut;
+    std::string traceFlowMap;
+    double lazyAppWindow = 1.0;
+    double lazyAppLinger = 1.0;
+    std::string traffic;
+    std::string trafficSizeDist = "pareto";
+    TrafficGenParams trafficParams;
+    std::string schedulerBenchTypes = "ns3::MapScheduler,ns3::HeapScheduler,ns3::CalendarScheduler,ns3::LadderScheduler";
     
     CommandLine cmd(__FILE__);
     cmd.AddValue("linkParams", "Link params CSV", linkFile);
     cmd.AddValue("demands", "Traffic demands CSV", demandFile);
     cmd.AddValue("output", "Output CSV", outFile);
+    cmd.AddValue("outputDir", "Directory for monitor/route/stats outputs", outDir);
     cmd.AddValue("simTime", "Sim time (s)", simTime);
+    cmd.AddValue("perfSummary", "Phase timing JSON", perfFile);
+    cmd.AddValue("perfCounters", "Enable perf_event_open hardware counters", perfCounters);
+    cmd.AddValue("perfSampleInterval", "Counter sampling window during Run (s)", perfSampleInterval);
+    cmd.AddValue("eventProfile", "Profile simulator events by callback type", eventProfile);
+    cmd.AddValue("eventProfileTopN", "Rows in the event profile table", eventProfileTopN);
+    cmd.AddValue("eventProfileSample", "Time one in every N events", eventProfileSample);
+    cmd.AddValue("scheduler", "Event scheduler TypeId (e.g. ns3::LadderScheduler)", schedulerType);
+    cmd.AddValue("schedulerTrace", "Record scheduler operations to this binary file", schedulerTrace);
+    cmd.AddValue("schedulerBench", "Replay a scheduler trace against schedulerBenchTypes and exit", schedulerBench);
+    cmd.AddValue("schedulerBenchTypes", "Comma-separated scheduler TypeIds to replay", schedulerBenchTypes);
+    cmd.AddValue("allocPool", "Serve small allocations (<= 4 KB) from thread-local size-class pools", allocPool);
+    cmd.AddValue("setupArena", "Allocate load/route/build containers from a monotonic arena", setupArena);
+    cmd.AddValue("earlyStop", "Stop once all demands have ended and the network has drained", earlyStop);
+    cmd.AddValue("drainCheckInterval", "Drain check period after the last demand ends (s)", drainCheckInterval);
+    cmd.AddValue("steadyState", "Stop once per-flow throughput/delay batch means converge", steadyState);
+    cmd.AddValue("batchInterval", "Batch length for steady-state detection (s)", batchInterval);
+    cmd.AddValue("ssPrecision", "Target relative confidence-interval half-width", ssPrecision);
+    cmd.AddValue("ssConfidence", "Confidence level of the intervals", ssConfidence);
+    cmd.AddValue("ssMinBatches", "Minimum post-warmup batches per flow", ssMinBatches);
+    cmd.AddValue("replications", "Independent replications (distinct RNG runs) sharing one parse/route setup", replications);
+    cmd.AddValue("jobs", "Replications run in parallel (0 = number of CPUs)", jobs);
+    cmd.AddValue("runBase", "RNG run number of the first replication", runBase);
+    cmd.AddValue("queueSize", "DropTail queue size per device (packets)", queueSize);
+    cmd.AddValue("packetSize", "OnOff packet size (bytes)", packetSize);
+    cmd.AddValue("onTimeMean", "Mean OnOff on period (s)", onTimeMean);
+    cmd.AddValue("offTimeMean", "Mean OnOff off period (s)", offTimeMean);
+    cmd.AddValue("demandScale", "Multiplier applied to every demand rate", demandScale);
+    cmd.AddValue("routing", "Shortest-path metric: delay or hop", routing);
+    cmd.AddValue("sweep", "Parameter sweep, e.g. \"queueSize=100,500;routing=delay,hop\" (lhs also takes lo:hi)", sweep);
+    cmd.AddValue("sweepMode", "Sweep design: grid or lhs (Latin hypercube)", sweepMode);
+    cmd.AddValue("sweepSamples", "Latin hypercube sample count", sweepSamples);
+    cmd.AddValue("sweepSeed", "Latin hypercube random seed", sweepSeed);
+    cmd.AddValue("surrogate", "Write queueing-model predictions (surrogate_results.csv) before the run", surrogate);
+    cmd.AddValue("surrogateOnly", "Write queueing-model predictions and skip the packet-level run", surrogateOnly);
+    cmd.AddValue("surrogateModel", "Per-link queue model: md1k or mm1k", surrogateModel);
+    cmd.AddValue("validation", "Post-load topology/demand checks: off, flag or drop", validation);
+    cmd.AddValue("aggregateDemands", "Merge demands with the same endpoints and window into one tagged source", aggregateDemands);
+    cmd.AddValue("aggregateTolerance", "Max start/end difference for merging demands (s)", aggregateTolerance);
+    cmd.AddValue("lazyApps", "Create each demand's sink/OnOff just before it starts and release it after it ends", lazyApps);
+    cmd.AddValue("lazyAppWindow", "How far ahead of their start lazy applications are created (s)", lazyAppWindow);
+    cmd.AddValue("lazyAppLinger", "Extra time a lazy sink stays open after its demand ends, on top of the path delay (s)", lazyAppLinger);
+    cmd.AddValue("timeSeriesBin", "Write per-demand and per-link-direction byte time series with this bin (s, 0 = off)", timeSeriesBin);
+    cmd.AddValue("timeSeriesRing", "Bins kept in memory before the oldest is written out", timeSeriesRing);
+    cmd.AddValue("hopSample", "Decompose the delay of 1 in N packets per hop into queueing/serialization/propagation (0 = off)", hopSample);
+    cmd.AddValue("resultFormat", "Result files: csv, columnar (.slcol, see starlink_columnar.py) or both", resultFormat);
+    cmd.AddValue("compressOutput", "Write CSV outputs as block-gzipped .csv.gz with a time index", g_results.gzip);
+    cmd.AddValue("resultZlib", "Compress .slcol column blocks with zlib when libz is available", g_results.zlib);
+    cmd.AddValue("flightRecorder", "Keep per-direction packet rings and dump them to pcap on loss bursts or delay spikes", flightRecorder);
+    cmd.AddValue("flightRingPackets", "Packets kept per link direction", flightConfig.ringPackets);
+    cmd.AddValue("flightSnapLen", "Bytes kept per packet (from the IP header)", flightConfig.snapLen);
+    cmd.AddValue("flightWindowMs", "History written per capture (ms)", flightConfig.windowMs);
+    cmd.AddValue("flightDropBurst", "Drops within flightBurstWindowMs that trigger a capture", flightConfig.dropBurst);
+    cmd.AddValue("flightBurstWindowMs", "Drop burst window (ms)", flightConfig.burstWindowMs);
+    cmd.AddValue("flightDelayMs", "Queueing delay that triggers a capture (ms, 0 = off)", flightConfig.delayMs);
+    cmd.AddValue("flightCooldownMs", "Minimum spacing of captures triggered by the same direction (ms)", flightConfig.cooldownMs);
+    cmd.AddValue("flightMaxDumps", "Maximum captures per run", flightConfig.maxDumps);
+    cmd.AddValue("transport", "Demand transport: udp (OnOff) or tcp (one connection per demand)", transport);
+    cmd.AddValue("tcpCongestion", "TCP congestion control: cubic, bbr or newreno", tcpCongestion);
+    cmd.AddValue("tcpBulk", "TCP demands send continuously until their end time instead of rate x duration bytes", tcpBulk);
+    cmd.AddValue("tcpBufferKB", "TCP send/receive buffer size (KB, 0 = ns-3 default)", tcpBufferKB);
+    cmd.AddValue("trafficTrace", "Replay packets from a binary trace instead of OnOff sources", trafficTrace);
+    cmd.AddValue("traceStart", "Simulation time of the first trace record (s)", traceStart);
+    cmd.AddValue("traceBatch", "Minimum spacing between trace replay events (s)", traceBatch);
+    cmd.AddValue("traceConvert", "Convert a CSV (timestamp_s,size_bytes,demand_id) or pcap file to --traceOut and exit", traceConvert);
+    cmd.AddValue("traceOut", "Binary trace written by --traceConvert", traceOut);
+    cmd.AddValue("traceFlowMap", "pcap conversion: src_ip,dst_ip,demand_id CSV", traceFlowMap);
+    cmd.AddValue("traffic", "Generate demands in-process instead of reading --demands: uniform, gravity, hotspot or gateway", traffic);
+    cmd.AddValue("trafficDemands", "Number of generated demands (0 = until simTime)", trafficParams.numDemands);
+    cmd.AddValue("trafficArrivalRate", "Poisson demand arrivals per second (0 = all start at trafficStart)", trafficParams.arrivalRate);
+    cmd.AddValue("trafficStart", "Start time of generated demands (s)", trafficParams.startTime);
+    cmd.AddValue("trafficSizeDist", "Flow size distribution: fixed, pareto or lognormal", trafficSizeDist);
+    cmd.AddValue("trafficMeanSizeMB", "Mean flow size (MB)", trafficParams.meanSizeMB);
+    cmd.AddValue("trafficParetoShape", "Pareto shape (> 1)", trafficParams.paretoShape);
+    cmd.AddValue("trafficLognormalSigma", "Lognormal sigma", trafficParams.lognormalSigma);
+    cmd.AddValue("trafficRateMin", "Minimum demand rate (Mbps)", trafficParams.rateMinMbps);
+    cmd.AddValue("trafficRateMax", "Maximum demand rate (Mbps)", trafficParams.rateMaxMbps);
+    cmd.AddValue("trafficSeed", "Demand generator seed", trafficParams.seed);
+    cmd.AddValue("trafficPopulation", "Gravity model population grid CSV (lat,lon,population)", trafficParams.populationFile);
+    cmd.AddValue("trafficPositions", "Gravity model node positions CSV (name,x_km,y_km,z_km)", trafficParams.positionFile);
+    cmd.AddValue("trafficHotspots", "Comma-separated hotspot node names (empty = random)", trafficParams.hotspots);
+    cmd.AddValue("trafficNumHotspots", "Random hotspot count", trafficParams.numHotspots);
+    cmd.AddValue("trafficHotspotFraction", "Share of demands sent to a hotspot", trafficParams.hotspotFraction);
+    cmd.AddValue("trafficGateways", "Comma-separated gateway node names (empty = random)", trafficParams.gateways);
+    cmd.AddValue("trafficNumGateways", "Random gateway count", trafficParams.numGateways);
     cmd.Parse(argc, argv);
     
-    std::cout << "Links:   " << linkFile << "\nOutput:  " << outFile << "\n";
+    if (!schedulerBench.empty()) {
+        std::vector<SchedulerReplayResult> results = ReplaySchedulerTrace(schedulerBench, schedulerBenchTypes);
+        PrintSchedulerReplay(std::cout, results);
+        WriteSchedulerReplayJson(outDir + "/scheduler_bench.json", results);
+        return results.empty() ? 1 : 0;
+    }
 
-    g_monitorFile.open("scratch/starlink/data/output/link_monitor.csv");
-    g_monitorFile << "Time,SrcNode,DstNode,QueuePackets\n";
+    if (!traceConvert.empty()) {
+        if (traceOut.empty()) traceOut = traceConvert + ".trace";
+        bool csv = traceConvert.size() >= 4 && traceConvert.compare(traceConvert.size() - 4, 4, ".csv") == 0;
+        uint64_t records = csv ? ConvertCsvTrace(traceConvert, traceOut)
+                               : ConvertPcapTrace(traceConvert, traceOut, traceFlowMap);
+        return records ? 0 : 1;
+    }
 
-    std::string routePathFile = "scratch/starlink/data/output/route_paths.csv";
-    std::ofstream routeFile(routePathFile.c_str());
-    routeFile << "FlowId,SrcNode,DstNode,HopCount,PathString\n";
+    // 扫描参数对应的运行参数；apply 为 false 时只检查取值
+    auto setRunParam = [&](const std::string& name, const std::string& value, bool apply) {
+        if (name == "routing") {
+            RouteMetric metric;
+            if (!ParseRouteMetric(value, metric)) return false;
+            if (apply) routing = value;
+            return true;
+        }
+        char* end = nullptr;
+        double v = std::strtod(value.c_str(), &end);
+        // offTimeMean 为 0 表示持续发送，其余参数必须为正
+        if (value.empty() || *end != '\0' || v < 0 || (v == 0 && name != "offTimeMean")) return false;
+        uint32_t n = static_cast<uint32_t>(std::lround(v));
+        if (name == "queueSize" && n > 0) { if (apply) queueSize = n; }
+        else if (name == "packetSize" && n > 0) { if (apply) packetSize = n; }
+        else if (name == "onTimeMean") { if (apply) onTimeMean = v; }
+        else if (name == "offTimeMean") { if (apply) offTimeMean = v; }
+        else if (name == "demandScale") { if (apply) demandScale = v; }
+        else if (name == "simTime") { if (apply) simTime = v; }
+        else return false;
+        return true;
+    };
+
+    RouteMetric routeMetric;
+    if (!ParseRouteMetric(routing, routeMetric)) {
+        std::cerr << "Error: unknown routing metric " << routing << " (expected delay or hop)\n";
+        return 1;
+    }
+    ValidationMode validationMode;
+    if (!ParseValidationMode(validation, validationMode)) {
+        std::cerr << "Error: unknown validation mode " << validation << " (expected off, flag or drop)\n";
+        return 1;
+    }
+    QueueModel queueModel;
+    if (!ParseQueueModel(surrogateModel, queueModel)) {
+        std::cerr << "Error: unknown surrogateModel " << surrogateModel << " (expected md1k or mm1k)\n";
+        return 1;
+    }
+    if (!traffic.empty()) {
+        if (!ParseTrafficModel(traffic, trafficParams.model)) {
+            std::cerr << "Error: unknown traffic model " << traffic << " (expected uniform, gravity, hotspot or gateway)\n";
+            return 1;
+        }
+        if (!ParseFlowSizeDist(trafficSizeDist, trafficParams.sizeDist)) {
+            std::cerr << "Error: unknown trafficSizeDist " << trafficSizeDist << " (expected fixed, pareto or lognormal)\n";
+            return 1;
+        }
+        trafficParams.endTime = simTime;
+        trafficParams.dutyCycle = onTimeMean / (onTimeMean + offTimeMean);
+    }
+    bool useTcp = transport == "tcp";
+    if (!useTcp && transport != "udp") {
+        std::cerr << "Error: unknown transport " << transport << " (expected udp or tcp)\n";
+        return 1;
+    }
+    if (useTcp) {
+        std::map<std::string, std::string> congestion = {
+            {"cubic", "ns3::TcpCubic"}, {"bbr", "ns3::TcpBbr"}, {"newreno", "ns3::TcpNewReno"}};
+        auto cc = congestion.find(tcpCongestion);
+        if (cc == congestion.end()) {
+            std::cerr << "Error: unknown tcpCongestion " << tcpCongestion << " (expected cubic, bbr or newreno)\n";
+            return 1;
+        }
+        if (!trafficTrace.empty()) {
+            std::cerr << "Error: --trafficTrace replays UDP packets and cannot be combined with --transport=tcp\n";
+            return 1;
+        }
+        Config::SetDefault("ns3::TcpL4Protocol::SocketType", TypeIdValue(TypeId::LookupByName(cc->second)));
+        if (tcpBufferKB > 0) {
+            Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue(tcpBufferKB * 1024));
+            Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue(tcpBufferKB * 1024));
+        }
+        // TCP 流按连接统计，不做子流合并；socket 在开始时刻才创建，无需 --lazyApps
+        aggregateDemands = false;
+        lazyApps = false;
+    }
+    if (surrogateOnly) {
+        surrogate = true;
+        replications = 1;     // 解析模型没有随机性
+    }
+    if (replications == 0) replications = 1;
+    std::vector<SweepParam> sweepParams;
+    std::vector<SweepPoint> sweepPoints;
+    if (!sweep.empty()) {
+        if (!ParseSweepSpec(sweep, sweepParams)) return 1;
+        // 整数参数在生成扫描点时取整，sweep_results 记录的就是实际运行的值
+        for (auto& p : sweepParams) p.integer = p.name == "queueSize" || p.name == "packetSize";
+        if (sweepMode == "grid") {
+            sweepPoints = GridPoints(sweepParams);
+        } else if (sweepMode == "lhs") {
+            sweepPoints = LatinHypercubePoints(sweepParams, sweepSamples, sweepSeed);
+        } else {
+            std::cerr << "Error: unknown sweepMode " << sweepMode << " (expected grid or lhs)\n";
+            return 1;
+        }
+        if (sweepPoints.empty()) return 1;
+        for (const auto& point : sweepPoints) {
+            for (size_t i = 0; i < sweepParams.size(); ++i) {
+                if (!setRunParam(sweepParams[i].name, point[i], false)) {
+                    std::cerr << "Error: invalid sweep value " << sweepParams[i].name << "=" << point[i] << "\n";
+                    return 1;
+                }
+            }
+        }
+        std::cout << "Sweep:   " << sweepPoints.size() << " points x " << replications << " replications\n";
+    }
+
+    if (resultFormat != "csv" && resultFormat != "columnar" && resultFormat != "both") {
+        std::cerr << "Error: unknown resultFormat " << resultFormat << " (expected csv, columnar or both)\n";
+        return 1;
+    }
+    g_results.csv = resultFormat != "columnar";
+    g_results.columnar = resultFormat != "csv";
+    if (!g_results.csv && (replications > 1 || !sweepPoints.empty())) {
+        // 副本合并与扫描汇总读取各任务的 flow_results.csv
+        std::cout << "Note: --resultFormat=columnar with replications/sweep also writes CSV for merging\n";
+        g_results.csv = true;
+    }
+    if (g_results.columnar && g_results.zlib && !ZlibAvailable()) {
+        std::cout << "Note: libz not found, .slcol blocks are written uncompressed\n";
+    }
+    if (g_results.gzip && !ZlibAvailable()) {
+        std::cout << "Note: libz not found, --compressOutput ignored\n";
+        g_results.gzip = false;
+    }
+    g_results.gzipMerged = g_results.gzip && replications <= 1 && sweepPoints.empty();
+
+    if (perfFile.empty()) perfFile = outDir + "/perf_summary.json";
+    if (perfCounters) g_profiler.EnableCounters();
+    if (allocPool && !EnableAllocPool()) {
+        std::cerr << "Warning: cannot reserve allocation pool, using malloc" << std::endl;
+    }
+    if (setupArena) EnableSetupArena();
+    if (eventProfile) {
+        Config::SetDefault("ns3::ProfilingSimulatorImpl::SampleInterval", UintegerValue(eventProfileSample));
+        GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::ProfilingSimulatorImpl"));
+    }
+    if (!schedulerTrace.empty()) {
+        Config::SetDefault("ns3::TracingScheduler::TraceFile", StringValue(schedulerTrace));
+        schedulerType = "ns3::TracingScheduler";
+    }
+    if (!schedulerType.empty()) {
+        GlobalValue::Bind("SchedulerType", StringValue(schedulerType));
+        std::cout << "Scheduler: " << schedulerType << "\n";
+    }
     
+    std::cout << "Links:   " << linkFile << "\nOutput:  " << outFile << "\n";
+
+    g_profiler.Begin("load_links");
     if (!LoadLinks(linkFile)) return 1;
-    if (!LoadDemands(demandFile)) return 1;
+    if (traffic.empty()) {
+        g_profiler.Begin("load_demands");
+        if (!LoadDemands(demandFile)) return 1;
+    } else {
+        // 生成的需求直接追加到 g_demands，不落盘
+        g_profiler.Begin("generate_demands");
+        uint64_t generated = GenerateDemands(trafficParams, [](const TrafficDemand& d) { g_demands.push_back(d); });
+        if (generated == 0) return 1;
+        std::cout << "Traffic: " << traffic << ", " << generated << " demands generated\n";
+        g_profiler.AddMetric("generated_demands", generated);
+    }
+    g_profiler.End();
+
+    // 创建 ns-3 对象之前检查拓扑，不可达需求在路由阶段按连通分量直接跳过
+    ValidationReport validationReport;
+    if (validationMode != ValidationMode::Off) {
+        g_profiler.Begin("validate");
+        validationReport = ValidateTopology(validationMode);
+        g_profiler.End();
+        PrintValidationReport(std::cout, validationReport);
+        WriteComponentSummary(outDir + "/components.csv", validationReport);
+        g_profiler.AddMetric("components", validationReport.componentSizes.size());
+        g_profiler.AddMetric("largest_component",
+                             validationReport.componentSizes.empty() ? 0 : validationReport.componentSizes.front());
+        g_profiler.AddMetric("self_loops", validationReport.selfLoops);
+        g_profiler.AddMetric("duplicate_links", validationReport.duplicateLinks);
+        g_profiler.AddMetric("unreachable_demands", validationReport.CountDemands(DemandIssue::Unreachable));
+        g_profiler.AddMetric("dropped_demands", validationReport.droppedDemands);
+    }
     
-    g_linkStats.resize(g_links.size());
-    for (size_t i = 0; i < g_links.size(); ++i) {
-        g_linkStats[i].srcName = g_links[i].srcName;
-        g_linkStats[i].dstName = g_links[i].dstName;
+    g_linkCounters.Resize(g_links.size() * 2);
+    if (hopSample) {
+        g_hops.every = hopSample;
+        for (const auto& link : g_links) {
+            g_hops.rateBps.push_back(link.dataRateBps);
+            g_hops.rateBps.push_back(link.dataRateBps);
+            g_hops.delayNs.push_back(std::llround(link.delayMs * 1e6));
+            g_hops.delayNs.push_back(std::llround(link.delayMs * 1e6));
+        }
     }
     
+    // 计算最短路径：每种路由度量只算一次，由所有扫描点和副本共享
+    g_profiler.Begin("routing");
+    std::set<std::string> routingModes;
+    for (size_t i = 0; i < sweepParams.size(); ++i) {
+        if (sweepParams[i].name != "routing") continue;
+        for (const auto& point : sweepPoints) routingModes.insert(point[i]);
+    }
+    if (routingModes.empty()) routingModes.insert(routing);
+    std::map<std::string, DemandPaths> routeCache;
+    for (const auto& mode : routingModes) {
+        ParseRouteMetric(mode, routeMetric);
+        routeCache.emplace(mode, ComputeDemandPaths(routeMetric, setupArena,
+                                                    validationReport.component.empty() ? nullptr
+                                                                                       : &validationReport.component));
+    }
+    g_profiler.End();
+
+    // ==================== 多副本与参数扫描 ====================
+    // 解析与路由结果由子进程写时复制继承，每个子进程只负责一个任务 (扫描点 x 副本) 的构建和运行
+    uint32_t numPoints = sweepPoints.empty() ? 1 : static_cast<uint32_t>(sweepPoints.size());
+    uint32_t tasks = numPoints * replications;
+    auto pointDir = [&](uint32_t point) {
+        return sweepPoints.empty() ? outDir : outDir + "/point_" + std::to_string(point);
+    };
+    auto taskDir = [&](uint32_t point, uint32_t rep) {
+        return replications > 1 ? pointDir(point) + "/rep_" + std::to_string(rep) : pointDir(point);
+    };
+    uint32_t replication = 0;
+    uint32_t sweepPoint = 0;
+    if (tasks > 1 || !sweepPoints.empty()) {
+        if (jobs == 0) jobs = std::max<long>(1, sysconf(_SC_NPROCESSORS_ONLN));
+        std::cout << "Running " << tasks << " tasks (" << jobs << " parallel)...\n";
+        // 先清掉上次运行留下的结果，异常退出的任务不会被误合并
+        std::vector<std::string> pointFiles;
+        for (uint32_t p = 0; p < numPoints; ++p) {
+            pointFiles.push_back(sweepPoints.empty() ? outFile
+                                 : pointDir(p) + (surrogateOnly ? "/surrogate_results.csv" : "/flow_results.csv"));
+            std::remove(pointFiles.back().c_str());
+            for (uint32_t r = 0; r < replications; ++r) {
+                std::remove((taskDir(p, r) + "/flow_results.csv").c_str());
+            }
+        }
+        std::vector<uint32_t> failed;
+        int task = ForkWorkers(tasks, jobs, failed);
+        if (task < 0) {
+            g_profiler.Begin("merge_results");
+            bool merged = true;
+            if (replications > 1) {
+                for (uint32_t p = 0; p < numPoints; ++p) {
+                    std::vector<std::string> files;
+                    for (uint32_t r = 0; r < replications; ++r) {
+                        files.push_back(taskDir(p, r) + "/flow_results.csv");
+                    }
+                    merged = MergeReplicationResults(
+                        files, "DemandId",
+                        {"TxPackets", "RxPackets", "LostPackets", "Throughput_Mbps", "MeanDelay_ms",
+                         "MeanJitter_ms", "PacketLossRate", "SimEndTime_s"},
+                        ssConfidence, pointFiles[p], pointDir(p) + "/flow_results_replications.csv") && merged;
+                }
+            }
+            std::string resultFile = outFile;
+            if (!sweepPoints.empty()) {
+                resultFile = outDir + "/sweep_results.csv";
+                merged = WriteSweepTable(sweepParams, sweepPoints, pointFiles, resultFile) && merged;
+            }
+            g_profiler.End();
+            std::cout << "Merged " << (tasks - failed.size()) << "/" << tasks << " tasks into " << resultFile << "\n";
+
+            g_profiler.AddMetric("num_nodes", g_numNodes);
+            g_profiler.AddMetric("num_links", g_links.size());
+            g_profiler.AddMetric("num_demands", g_demands.size());
+            g_profiler.AddMetric("sweep_points", sweepPoints.size());
+            g_profiler.AddMetric("replications", replications);
+            g_profiler.AddMetric("jobs", jobs);
+            g_profiler.AddMetric("failed_tasks", failed.size());
+            g_profiler.Print();
+            g_profiler.WriteJson(perfFile);
+            return (merged && failed.empty()) ? 0 : 1;
+        }
+
+        sweepPoint = static_cast<uint32_t>(task) / replications;
+        replication = static_cast<uint32_t>(task) % replications;
+        if (!sweepPoints.empty()) {
+            for (size_t i = 0; i < sweepParams.size(); ++i) {
+                setRunParam(sweepParams[i].name, sweepPoints[sweepPoint][i], true);
+            }
+        }
+        outDir = taskDir(sweepPoint, replication);
+        SystemPath::MakeDirectories(outDir);
+        outFile = outDir + "/flow_results.csv";
+        perfFile = outDir + "/perf_summary.json";
+        // 并行任务的控制台输出互相穿插，改写到各自目录
+        if (!freopen((outDir + "/sim.log").c_str(), "w", stdout)) {
+            std::cerr << "Warning: cannot redirect output of task " << task << "\n";
+        }
+        // 扫描点之间使用相同的随机数流 (公共随机数)，只有副本之间不同
+        if (replications > 1) RngSeedManager::SetRun(runBase + replication);
+        if (!schedulerTrace.empty()) {
+            Config::SetDefault("ns3::TracingScheduler::TraceFile",
+                               StringValue(schedulerTrace + "." + std::to_string(task)));
+        }
+        // 父进程打开的计数器只统计父进程
+        if (perfCounters) g_profiler.EnableCounters();
+    }
+    const DemandPaths& demandPaths = routeCache.at(routing);
+
+    // 排队论代理模型：与分组级仿真使用相同的路由和参数
+    if (surrogate) {
+        g_profiler.Begin("surrogate");
+        SurrogateParams sp;
+        sp.model = queueModel;
+        sp.queueSize = queueSize;
+        sp.packetSize = packetSize;
+        sp.onTimeMean = onTimeMean;
+        sp.offTimeMean = offTimeMean;
+        sp.demandScale = demandScale;
+        sp.simTime = simTime;
+        SurrogateResult predicted = PredictQueueing(demandPaths, sp);
+        WriteSurrogateResults(outDir + "/surrogate_results.csv", predicted, g_results.gzipMerged);
+        WriteSurrogateLinks(outDir + "/surrogate_links.csv", predicted, g_results.gzip);
+        g_profiler.End();
+        std::cout << "Surrogate: " << predicted.flows.size() << " flows, " << predicted.links.size()
+                  << " loaded links, " << predicted.segments << " segments (" << surrogateModel << ")\n";
+        g_profiler.AddMetric("surrogate_segments", predicted.segments);
+        if (surrogateOnly) {
+            g_profiler.AddMetric("num_nodes", g_numNodes);
+            g_profiler.AddMetric("num_links", g_links.size());
+            g_profiler.AddMetric("num_demands", g_demands.size());
+            g_profiler.Print();
+            g_profiler.WriteJson(perfFile);
+            return 0;
+        }
+    }
+
+    // 在 fork 之后按任务目录打开，各副本/扫描点的 pcap 与索引互不覆盖
+    if (flightRecorder) {
+        if (!g_flight.recorder.Init(g_links.size() * 2, flightConfig, outDir)) return 1;
+        g_flight.enabled = true;
+        g_flight.queues.resize(g_links.size() * 2);
+        g_flight.dirGroups.resize(g_links.size() * 2);
+    }
+
+    std::string routePathFile = outDir + "/route_paths.csv";
+    OutputFile routeFile;
+    ColumnarWriter routeColumns;
+    if (g_results.csv) {
+        g_monitorFile.Open(outDir + "/link_monitor.csv", g_results.gzip);
+        g_monitorFile << "Time,SrcNode,DstNode,QueuePackets\n";
+        routeFile.Open(routePathFile, g_results.gzip);
+        routeFile << "FlowId,SrcNode,DstNode,HopCount,PathString\n";
+    }
+    if (g_results.columnar) {
+        const auto U = ColumnarWriter::UInt64, F = ColumnarWriter::Float64, S = ColumnarWriter::String;
+        if (!g_results.monitor.Open(outDir + "/link_monitor.slcol",
+                                    {{"Time", F}, {"SrcNode", S}, {"DstNode", S}, {"QueuePackets", U}},
+                                    g_results.zlib) ||
+            !routeColumns.Open(ColumnarPath(routePathFile),
+                               {{"FlowId", U}, {"SrcNode", S}, {"DstNode", S}, {"HopCount", U}, {"PathString", S}},
+                               g_results.zlib)) {
+            return 1;
+        }
+    }
+
     // 创建节点
+    g_profiler.Begin("build_links");
     g_nodes.Create(g_numNodes);
     
     // 安装协议栈
@@ -302,6 +1577,7 @@ int main(int argc, char *argv[]) {
     
     PointToPointHelper p2p;
     Ipv4AddressHelper ipv4;
+    TrafficControlHelper tch;
     Ipv4StaticRoutingHelper staticRoutingHelper;
     
     uint32_t sub = 0;
@@ -314,7 +1590,7 @@ int main(int argc, char *argv[]) {
         
         p2p.SetDeviceAttribute("DataRate", StringValue(r.str()));
         p2p.SetChannelAttribute("Delay", StringValue(d.str()));
-        p2p.SetQueue("ns3::DropTailQueue", "MaxSize", StringValue("500p"));
+        p2p.SetQueue("ns3::DropTailQueue", "MaxSize", StringValue(std::to_string(queueSize) + "p"));
 
         NetDeviceContainer devs = p2p.Install(g_nodes.Get(g_links[i].srcId), g_nodes.Get(g_links[i].dstId));
         
@@ -338,12 +1614,26 @@ int main(int argc, char *argv[]) {
             DynamicCast<PointToPointNetDevice>(devs.Get(1))
         });
 
-        devs.Get(0)->TraceConnectWithoutContext("MacTx", MakeBoundCallback(&LinkTxCallback, static_cast<uint32_t>(i)));
-        devs.Get(1)->TraceConnectWithoutContext("MacRx", MakeBoundCallback(&LinkRxCallback, static_cast<uint32_t>(i)));
+        // 设备 0 在 src 端：发送方向 2i、接收方向 2i+1；设备 1 相反
+        for (uint32_t end = 0; end < 2; ++end) {
+            uint32_t txDir = static_cast<uint32_t>(2 * i + end), rxDir = static_cast<uint32_t>(2 * i + 1 - end);
+            Ptr<PointToPointNetDevice> dev = DynamicCast<PointToPointNetDevice>(devs.Get(end));
+            dev->TraceConnectWithoutContext("MacTx", MakeBoundCallback(&LinkTxCallback, txDir));
+            dev->TraceConnectWithoutContext("MacRx", MakeBoundCallback(&LinkRxCallback, rxDir));
+            dev->TraceConnectWithoutContext("PhyRxDrop", MakeBoundCallback(&LinkPhyDropCallback, rxDir));
+            dev->GetQueue()->TraceConnectWithoutContext("Drop", MakeBoundCallback(&LinkQueueDropCallback, txDir));
+            dev->TraceConnectWithoutContext("PhyTxBegin", MakeBoundCallback(&LinkPhyTxBeginCallback, txDir));
+            dev->TraceConnectWithoutContext("PhyTxEnd", MakeBoundCallback(&LinkPhyTxEndCallback, txDir));
+            if (flightRecorder && flightConfig.delayMs > 0) g_flight.queues[txDir] = dev->GetQueue();
+        }
         
         b << "10." << (sub/256)%256 << "." << sub%256 << ".0";
         ipv4.SetBase(b.str().c_str(), "255.255.255.252");
         Ipv4InterfaceContainer ifaces = ipv4.Assign(devs);
+        // Assign 会装上默认的 FqCoDel 根队列规则，丢包和排队都发生在它里面；卸掉后设备的
+        // DropTail (queueSize) 才是唯一的缓冲区，上面的 Drop / MacTx 钩子与代理模型的
+        // K = queueSize + 1 都以此为前提
+        tch.Uninstall(devs);
         
         // 记录链路接口信息（用于后续设置静态路由）
         uint32_t srcId = g_links[i].srcId;
@@ -370,31 +1660,118 @@ int main(int argc, char *argv[]) {
     }
     
     // 创建流并设置静态路由
-    uint16_t port = 9000;
+    g_profiler.Begin("install_flows");
+    g_ports.Init(g_numNodes);
     std::cout << "Creating flows with static routing...\n";
+
+    // 兜底排空时间按最慢链路上一个满长分组的传输时延估计每跳的传输部分
+    uint64_t minRateBps = 0;
+    for (const auto& link : g_links) {
+        if (minRateBps == 0 || link.dataRateBps < minRateBps) minRateBps = link.dataRateBps;
+    }
+    double hopTxSec = minRateBps ? 1500 * 8.0 / minRateBps : 0;
     
-    for (const auto& demand : g_demands) {
+    if (!trafficTrace.empty()) {
+        if (!g_replay.reader.Open(trafficTrace)) return 1;
+        g_replay.active = true;
+        g_replay.tagSubflows = aggregateDemands;
+        g_replay.startNs = static_cast<uint64_t>(std::llround(traceStart * 1e9));
+        g_replay.batchNs = static_cast<uint64_t>(std::llround(traceBatch * 1e9));
+        std::cout << "Trace:   " << trafficTrace << " (" << g_replay.reader.Count() << " records, "
+                  << g_replay.reader.SpanNs() / 1e9 << "s)\n";
+        lazyApps = false;       // 回放的 socket 与需求一一对应，整个运行期间保持
+    }
+    if (useTcp) Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue(packetSize));
+    g_apps.lazy = lazyApps;
+    g_apps.window = lazyAppWindow;
+    g_apps.simTime = simTime;
+    g_apps.packetSize = packetSize;
+    std::ostringstream onTime, offTime;
+    onTime << "ns3::ExponentialRandomVariable[Mean=" << onTimeMean << "]";
+    offTime << "ns3::ExponentialRandomVariable[Mean=" << offTimeMean << "]";
+    g_apps.onTime = onTime.str();
+    g_apps.offTime = offTime.str();
+
+    // (节点, 下一跳) -> 链路方向，供飞行记录仪查找路径经过的方向
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> linkDirection;
+    if (g_flight.enabled) {
+        for (size_t i = 0; i < g_links.size(); ++i) {
+            linkDirection[{g_links[i].srcId, g_links[i].dstId}] = static_cast<uint32_t>(2 * i);
+            linkDirection[{g_links[i].dstId, g_links[i].srcId}] = static_cast<uint32_t>(2 * i + 1);
+        }
+    }
+
+    std::vector<DemandGroup> groups = AggregateDemands(demandPaths, aggregateDemands, aggregateTolerance);
+    if (aggregateDemands) g_subflows.stats.assign(g_demands.size(), SubFlowStats());
+
+    for (size_t gi = 0; gi < groups.size(); gi++) {
+        const DemandGroup& group = groups[gi];
+        const auto& demand = g_demands[group.members.front()];
         uint32_t src = demand.srcId;
         uint32_t dst = demand.dstId;
-        
-        if (g_nodeFirstIp.find(dst) == g_nodeFirstIp.end()) continue;
-        
-        // 计算最短路径
-        DijkstraResult dijkstra = Dijkstra(src, g_numNodes);
-        std::vector<uint32_t> path = GetPath(src, dst, dijkstra);
+        const auto& path = demandPaths[group.members.front()];
         
         if (path.empty() || path.size() < 2) continue;
 
-        // 记录路径
+        // 记录路径 (合并的需求各记一行)
         std::ostringstream pathSs;
         for (size_t j = 0; j < path.size(); j++) {
             pathSs << GetNodeName(path[j]);
             if (j < path.size() - 1) pathSs << "->";
         }
-        routeFile << (demand.demandId + 1) << "," << demand.srcNode << "," << demand.dstNode << ","
-                  << (path.size() - 1) << "," << pathSs.str() << "\n";
+        for (uint32_t k : group.members) {
+            if (g_results.csv) {
+                routeFile << (g_demands[k].demandId + 1) << "," << demand.srcNode << "," << demand.dstNode << ","
+                          << (path.size() - 1) << "," << pathSs.str() << "\n";
+            }
+            if (routeColumns.IsOpen()) {
+                routeColumns.UInt(g_demands[k].demandId + 1).Str(demand.srcNode).Str(demand.dstNode)
+                            .UInt(path.size() - 1).Str(pathSs.str()).EndRow();
+            }
+        }
         
-        std::cout << "  Flow " << demand.demandId << ": " << pathSs.str() << "\n";
+        std::string demandIds = GroupDemandIds(group);
+        std::cout << "  Flow " << demandIds << ": " << pathSs.str() << "\n";
+
+        double pathDelaySec = 0;
+        for (size_t hop = 0; hop + 1 < path.size(); hop++) {
+            for (const auto& [next, delayMs] : g_adjList[path[hop]]) {
+                if (next == path[hop + 1]) { pathDelaySec += delayMs / 1000.0 + hopTxSec; break; }
+            }
+        }
+        g_drain.drainTimeout = std::max(g_drain.drainTimeout, pathDelaySec);
+        if (g_flight.enabled) {
+            uint32_t groupIndex = static_cast<uint32_t>(g_flight.groupDirs.size());
+            std::vector<uint32_t> dirs;
+            for (size_t hop = 0; hop + 1 < path.size(); hop++) {
+                auto it = linkDirection.find({path[hop], path[hop + 1]});
+                if (it == linkDirection.end()) continue;
+                dirs.push_back(it->second);
+                g_flight.dirGroups[it->second].push_back(groupIndex);
+            }
+            g_flight.groupDirs.push_back(dirs);
+        }
+        g_drain.demandsEndTime = std::max(g_drain.demandsEndTime, group.endSec);
+
+        SteadyStateFlow ssFlow;
+        ssFlow.demandIndex = group.members.front();
+        ssFlow.demandIds = demandIds;
+        ssFlow.startSec = group.startSec;
+        ssFlow.endSec = group.endSec;
+        // --lazyApps 在创建应用时才分配端口，结束后回收
+        uint16_t port = 0;
+        if (!lazyApps) {
+            port = g_ports.Take(dst);
+            if (port == 0) {
+                std::cerr << "❌ 目的节点 " << GetNodeName(dst) << " 上的需求组超过 "
+                          << (PortAllocator::kLastPort - PortAllocator::kFirstPort + 1)
+                          << " 个，端口已用尽 (--lazyApps 会在需求结束后回收端口)" << std::endl;
+                return 1;
+            }
+            g_steady.portToFlow[FlowKey(g_nodeFirstIp[dst], port)].emplace_back(0.0, g_steady.flows.size());
+        }
+        g_steady.flows.push_back(ssFlow);
+        g_steady.lastDemandStart = std::max(g_steady.lastDemandStart, group.startSec);
 
         // 获取目的地址
         Ipv4Address destAddr = g_nodeFirstIp[dst];
@@ -422,48 +1799,247 @@ int main(int argc, char *argv[]) {
             staticRouting->AddHostRouteTo(destAddr, nextHopAddr, ifIndex);
         }
         
-        // 创建应用
-        PacketSinkHelper sink("ns3::UdpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), port));
-        ApplicationContainer sinkApps = sink.Install(g_nodes.Get(dst));
-        sinkApps.Start(Seconds(0.0));
-        sinkApps.Stop(Seconds(simTime));
-        
-        std::ostringstream rateStr;
-        rateStr << demand.dataRateMbps << "Mbps";
-        OnOffHelper onoff("ns3::UdpSocketFactory", InetSocketAddress(destAddr, port));
-        onoff.SetAttribute("DataRate", StringValue(rateStr.str()));
-        onoff.SetAttribute("PacketSize", UintegerValue(1024));
-        onoff.SetAttribute("OnTime", StringValue("ns3::ExponentialRandomVariable[Mean=1.0]"));
-        onoff.SetAttribute("OffTime", StringValue("ns3::ExponentialRandomVariable[Mean=0.5]"));
-        
-        ApplicationContainer clientApps = onoff.Install(g_nodes.Get(src));
-        clientApps.Start(Seconds(demand.startTimeSec));
-        clientApps.Stop(Seconds(demand.startTimeSec + demand.durationSec));
-        port++;
+        // 创建应用 (--lazyApps 时只记录，运行中按开始时刻创建)
+        DemandApp app;
+        app.src = src;
+        app.dst = dst;
+        app.port = port;
+        app.rateMbps = group.rateMbps * demandScale;
+        app.startSec = group.startSec;
+        app.endSec = group.endSec;
+        app.releaseSec = group.endSec + lazyAppLinger + pathDelaySec;
+        app.flow = static_cast<uint32_t>(g_steady.flows.size() - 1);
+        if (timeSeriesBin > 0) app.series = static_cast<int32_t>(app.flow);
+        if (aggregateDemands) {
+            std::vector<double> weights;
+            for (uint32_t k : group.members) weights.push_back(g_demands[k].dataRateMbps);
+            app.subflowGroup = static_cast<int32_t>(g_subflows.members.size());
+            g_subflows.members.push_back(group.members);
+            g_subflows.pickers.emplace_back(weights);
+        }
+        if (useTcp) {
+            TcpFlow flow;
+            flow.src = src;
+            flow.dst = dst;
+            flow.port = port;
+            flow.demandIds = demandIds;
+            flow.series = app.series;
+            flow.startSec = group.startSec;
+            flow.endSec = group.endSec;
+            if (!tcpBulk) {
+                flow.bytes = static_cast<uint64_t>(app.rateMbps * 1e6 * (group.endSec - group.startSec) / 8);
+                flow.bytes = std::max<uint64_t>(flow.bytes, 1);
+            }
+            g_tcp.open++;
+            uint32_t index = static_cast<uint32_t>(g_tcp.flows.size());
+            g_tcp.flows.push_back(flow);
+            Simulator::Schedule(Seconds(group.startSec), &TcpStart, index);
+            if (tcpBulk) Simulator::Schedule(Seconds(group.endSec), &TcpStopBulk, index);
+        } else if (lazyApps) {
+            g_apps.pending.push_back(app);
+        } else {
+            InstallDemandApps(app);
+            if (g_replay.active) {
+                for (uint32_t k : group.members) {
+                    g_replay.demandToSocket[g_demands[k].demandId] = static_cast<uint32_t>(g_replay.sockets.size() - 1);
+                    g_replay.demandToIndex[g_demands[k].demandId] = k;
+                }
+            }
+        }
+    }
+    if (g_hops.every) g_hops.stats.Init(g_links.size() * 2, g_steady.flows.size());
+    if (timeSeriesBin > 0) {
+        std::vector<std::string> flowLabels = FlowLabels(), linkLabels = LinkDirectionLabels();
+        if (!g_flowSeries.Open(outDir + "/flow_timeseries.csv", "DemandId", flowLabels, timeSeriesBin, timeSeriesRing,
+                               g_results.gzip) ||
+            !g_linkSeries.Open(outDir + "/link_timeseries.csv", "Link", linkLabels, timeSeriesBin, timeSeriesRing,
+                               g_results.gzip)) {
+            return 1;
+        }
+    }
+    if (g_replay.active) {
+        g_replay.hasNext = g_replay.reader.Next(g_replay.next);
+        if (g_replay.hasNext) {
+            Simulator::Schedule(NanoSeconds(g_replay.startNs + g_replay.next.timeNs), &TraceReplayStep);
+        }
+        g_drain.demandsEndTime = traceStart + g_replay.reader.SpanNs() / 1e9;
+    }
+    if (lazyApps && !g_apps.pending.empty()) {
+        std::stable_sort(g_apps.pending.begin(), g_apps.pending.end(),
+                         [](const DemandApp& a, const DemandApp& b) { return a.startSec < b.startSec; });
+        Simulator::Schedule(Seconds(0), &LazyAppStep);
     }
 
-    routeFile.flush(); routeFile.close();
+    if (g_results.csv) routeFile.Close();
+    routeColumns.Close();
     
     FlowMonitorHelper fmHelper;
     Ptr<FlowMonitor> monitor = fmHelper.InstallAll();
     
     Simulator::Schedule(Seconds(0.1), &MonitorQueues, 0.1);
+    if (steadyState && !g_steady.flows.empty()) {
+        g_steady.monitor.reset(new ConvergenceMonitor(ssPrecision, ssConfidence, ssMinBatches));
+        g_steady.flowMonitor = monitor;
+        g_steady.classifier = DynamicCast<Ipv4FlowClassifier>(fmHelper.GetClassifier());
+        g_steady.interval = batchInterval;
+        Simulator::Schedule(Seconds(batchInterval), &SteadyStateBatch);
+    }
+    if (g_profiler.HasCounters() && perfSampleInterval > 0) {
+        Simulator::Schedule(Seconds(0), &SamplePerfWindow, perfSampleInterval);
+    }
+
+    if (earlyStop && g_drain.demandsEndTime < simTime) {
+        g_apps.drainTraces = lazyApps;
+        Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::OnOffApplication/Tx", MakeCallback(&AppTxCallback));
+        Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::SubFlowSender/Tx", MakeCallback(&AppTxCallback));
+        Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::PacketSink/Rx", MakeCallback(&SinkRxCallback));
+        Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/MacTxDrop", MakeCallback(&DeviceDropCallback));
+        Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/PhyTxDrop", MakeCallback(&DeviceDropCallback));
+        Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/PhyRxDrop", MakeCallback(&DeviceDropCallback));
+        Config::ConnectWithoutContext("/NodeList/*/$ns3::Ipv4L3Protocol/Drop", MakeCallback(&Ipv4DropCallback));
+        Simulator::Schedule(Seconds(g_drain.demandsEndTime), &CheckDrained, drainCheckInterval);
+    }
 
     std::cout << "Running " << simTime << "s simulation...\n";
     Simulator::Stop(Seconds(simTime));
+    g_profiler.Begin("run");
+    uint64_t eventsBefore = Simulator::GetEventCount();
     Simulator::Run();
+    g_profiler.End().events = Simulator::GetEventCount() - eventsBefore;
+    if (g_apps.portsExhausted) return 1;
+
+    double simEndTime = (g_drain.cutoffTime >= 0) ? g_drain.cutoffTime : simTime;
+    if (g_steady.stopTime >= 0) {
+        simEndTime = g_steady.stopTime;
+        std::cout << "Steady state reached at " << simEndTime << "s\n";
+    }
+    if (g_steady.monitor) {
+        g_steady.monitor->Evaluate(true);
+        std::cout << "Warmup: " << g_steady.monitor->GetWarmupBatches() * batchInterval << "s ("
+                  << g_steady.monitor->GetWarmupBatches() << " of " << g_steady.monitor->GetNumBatches()
+                  << " batches)\n";
+    }
+    if (g_drain.cutoffTime >= 0) {
+        std::cout << "Stopped early at " << simEndTime << "s (demands ended at " << g_drain.demandsEndTime
+                  << "s, " << g_drain.appTx << " sent / " << g_drain.sinkRx << " received / "
+                  << g_drain.dropped << " dropped)\n";
+    }
+    
+    Ptr<ProfilingSimulatorImpl> eventProfiler = DynamicCast<ProfilingSimulatorImpl>(Simulator::GetImplementation());
+    if (eventProfiler) {
+        eventProfiler->PrintTopN(std::cout, eventProfileTopN);
+        eventProfiler->WriteCsv(outDir + "/event_profile.csv", g_results.gzip);
+    }
     
+    g_profiler.Begin("save_results");
     Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(fmHelper.GetClassifier());
-    SaveResults(outFile, monitor, classifier);
+    SaveResults(outFile, monitor, classifier, simEndTime);
+    if (g_steady.monitor) SaveSteadyState(outDir + "/steady_state.csv");
+    if (aggregateDemands) SaveDemandResults(outDir + "/demand_results.csv");
+    if (useTcp) SaveTcpFlows(outDir + "/tcp_flows.csv", simEndTime);
+    if (g_flight.enabled) {
+        g_flight.recorder.Close();
+        std::cout << "Flight recorder: " << g_flight.recorder.Dumps() << " captures written\n";
+        g_profiler.AddMetric("flightrec_dumps", g_flight.recorder.Dumps());
+        g_profiler.AddMetric("flightrec_triggers", g_flight.recorder.Triggers());
+    }
+    if (g_hops.every) {
+        std::vector<std::string> flowLabels = FlowLabels(), linkLabels = LinkDirectionLabels();
+        g_hops.stats.WriteLinks(outDir + "/hop_latency_links.csv", linkLabels, g_results.gzip);
+        g_hops.stats.WriteFlows(outDir + "/hop_latency_flows.csv", flowLabels, g_results.gzip);
+        g_profiler.AddMetric("hop_samples", g_hops.stats.Samples());
+    }
+    if (timeSeriesBin > 0) {
+        g_flowSeries.Close();
+        g_linkSeries.Close();
+        g_profiler.AddMetric("timeseries_rows", g_flowSeries.RowsWritten() + g_linkSeries.RowsWritten());
+    }
     
     g_monitoredLinks.clear();
-    g_monitorFile.flush();
-    g_monitorFile.close();
+    if (g_results.csv) g_monitorFile.Close();
+    g_results.monitor.Close();
     
     Simulator::Destroy();
     
-    std::string linkStatsFile = "scratch/starlink/data/output/link_stats.csv";
-    SaveLinkStats(linkStatsFile);
+    std::string linkStatsFile = outDir + "/link_stats.csv";
+    SaveLinkStats(linkStatsFile, simEndTime);
+    uint64_t queueDrops = 0, phyDrops = 0;
+    for (size_t dir = 0; dir < g_linkCounters.queueDrops.size(); ++dir) {
+        queueDrops += g_linkCounters.queueDrops[dir];
+        phyDrops += g_linkCounters.phyDrops[dir];
+    }
+    g_profiler.End();
+
+    g_profiler.AddMetric("num_nodes", g_numNodes);
+    g_profiler.AddMetric("num_links", g_links.size());
+    g_profiler.AddMetric("num_demands", g_demands.size());
+    g_profiler.AddMetric("queue_drops", queueDrops);
+    g_profiler.AddMetric("phy_drops", phyDrops);
+    g_profiler.AddMetric("sim_time_s", simTime);
+    g_profiler.AddMetric("sim_end_time_s", simEndTime);
+    if (aggregateDemands) {
+        g_profiler.AddMetric("demand_groups", g_subflows.members.size());
+        size_t groupedDemands = 0;
+        for (const auto& group : groups) groupedDemands += group.members.size();
+        g_profiler.AddMetric("applications_saved", groupedDemands - groups.size());
+    }
+    if (useTcp) {
+        std::vector<double> fct;
+        uint64_t retransmissions = 0;
+        for (const TcpFlow& flow : g_tcp.flows) {
+            if (flow.completeSec >= 0) fct.push_back((flow.completeSec - flow.startSec) * 1000.0);
+            retransmissions += flow.retransmissions;
+        }
+        std::sort(fct.begin(), fct.end());
+        g_profiler.AddMetric("tcp_flows", g_tcp.flows.size());
+        g_profiler.AddMetric("tcp_completed", fct.size());
+        g_profiler.AddMetric("tcp_retransmissions", retransmissions);
+        if (!fct.empty()) {
+            g_profiler.AddMetric("tcp_fct_p50_ms", fct[fct.size() / 2]);
+            g_profiler.AddMetric("tcp_fct_p99_ms", fct[std::min(fct.size() - 1, fct.size() * 99 / 100)]);
+        }
+    }
+    if (g_replay.active) {
+        g_profiler.AddMetric("trace_packets_sent", g_replay.sent);
+        g_profiler.AddMetric("trace_unmatched", g_replay.unmatched);
+        g_profiler.AddMetric("trace_batches", g_replay.batches);
+        g_profiler.AddMetric("trace_batch_packets", g_replay.batches ? double(g_replay.sent) / g_replay.batches : 0);
+    }
+    if (lazyApps) {
+        g_profiler.AddMetric("lazy_apps_created", g_apps.next);
+        g_profiler.AddMetric("lazy_peak_active", g_apps.peakActive);
+    }
+    if (replications > 1) {
+        g_profiler.AddMetric("replication", replication);
+        g_profiler.AddMetric("rng_run", runBase + replication);
+    }
+    if (!sweepPoints.empty()) g_profiler.AddMetric("sweep_point", sweepPoint);
+    if (g_steady.monitor) {
+        uint32_t converged = 0;
+        double maxRel = 0;
+        for (uint32_t i = 0; i < g_steady.flows.size(); ++i) {
+            FlowEstimate e = g_steady.monitor->GetEstimate(i);
+            if (e.converged) converged++;
+            if (e.throughput.valid) maxRel = std::max(maxRel, e.throughput.relHalfWidth);
+            if (e.delay.valid) maxRel = std::max(maxRel, e.delay.relHalfWidth);
+        }
+        g_profiler.AddMetric("warmup_end_s", g_steady.monitor->GetWarmupBatches() * batchInterval);
+        g_profiler.AddMetric("ss_converged_flows", converged);
+        g_profiler.AddMetric("ss_max_rel_ci", maxRel);
+    }
+    if (IsSetupArenaEnabled()) {
+        g_profiler.AddMetric("setup_arena_mb", GetSetupArenaBytes() / 1048576.0);
+    }
+    if (IsAllocPoolEnabled()) {
+        PoolStats pool = GetPoolStats();
+        PrintPoolStats(std::cout, pool);
+        g_profiler.AddMetric("pool_allocs", pool.allocs);
+        g_profiler.AddMetric("pool_hit_rate", pool.HitRate());
+        g_profiler.AddMetric("pool_fallbacks", pool.fallbacks);
+        g_profiler.AddMetric("pool_reserved_mb", pool.reservedBytes / 1048576.0);
+    }
+    g_profiler.Print();
+    g_profiler.WriteJson(perfFile);
     
     return 0;
 }
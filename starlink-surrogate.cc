@@ -0,0 +1,297 @@
+#include "starlink-surrogate.h"
+#include "starlink-zstream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+
+// 线路上的附加头部：UDP 8 + IPv4 20 + PPP 2
+static const uint32_t UDP_IP_HEADER = 28;
+static const uint32_t PPP_HEADER = 2;
+
+bool ParseQueueModel(const std::string& name, QueueModel& model) {
+    if (name == "mm1k") model = QueueModel::MM1K;
+    else if (name == "md1k") model = QueueModel::MD1K;
+    else return false;
+    return true;
+}
+
+// ==================== 单队列 ====================
+
+QueueMetrics SolveMM1K(double lambda, double mu, uint32_t K) {
+    QueueMetrics m;
+    if (lambda <= 0 || mu <= 0) {
+        m.sojournSec = mu > 0 ? 1 / mu : 0;
+        return m;
+    }
+    double rho = lambda / mu;
+    if (std::fabs(rho - 1) < 1e-9) {
+        m.blocking = 1.0 / (K + 1);
+        m.meanPackets = K / 2.0;
+    } else if (rho < 1) {
+        double rk = std::pow(rho, K), rk1 = rk * rho;
+        m.blocking = (1 - rho) * rk / (1 - rk1);
+        m.meanPackets = rho / (1 - rho) - (K + 1) * rk1 / (1 - rk1);
+    } else {
+        // 用 1/rho 改写，避免 rho^K 溢出
+        double r = 1 / rho, rk = std::pow(r, K), rk1 = rk * r;
+        m.blocking = (rho - 1) / (rho - rk);
+        m.meanPackets = K - (r / (1 - r) - (K + 1) * rk1 / (1 - rk1));
+    }
+    m.sojournSec = m.meanPackets / (lambda * (1 - m.blocking));
+    return m;
+}
+
+QueueMetrics SolveMD1K(double lambda, double mu, uint32_t K) {
+    QueueMetrics m;
+    if (lambda <= 0 || mu <= 0) {
+        m.sojournSec = mu > 0 ? 1 / mu : 0;
+        return m;
+    }
+    double rho = lambda / mu;
+    if (K < 2 || rho > 30) {
+        // 严重过载：队列几乎始终满，只有 mu 的到达被接纳
+        if (rho > 30) {
+            m.blocking = 1 - 1 / rho;
+            m.meanPackets = K;
+            m.sojournSec = K / mu;
+            return m;
+        }
+        // K = 1 (无等待位)：M/G/1/1 的 Erlang 损失
+        m.blocking = rho / (1 + rho);
+        m.meanPackets = m.blocking;
+        m.sojournSec = 1 / mu;
+        return m;
+    }
+    if (rho < 0.5 && std::pow(rho, K) < 1e-15) {
+        // 缓冲截断可忽略，直接用 M/D/1 的 Pollaczek-Khinchine 公式
+        m.sojournSec = 1 / mu + rho / (2 * mu * (1 - rho));
+        m.meanPackets = lambda * m.sojournSec;
+        return m;
+    }
+
+    // 一个服务时间内的到达数 a_k ~ Poisson(rho)，只保留不可忽略的项
+    std::vector<long double> a;
+    long double ak = std::exp(-static_cast<long double>(rho));
+    for (uint32_t k = 0; k < K; ++k) {
+        a.push_back(ak);
+        ak *= rho / (k + 1);
+        if (k > rho && ak < 1e-30L * a[0]) break;
+    }
+    // 离去时刻留下 j 个分组的概率 (未归一化)：pi_{j+1} = (pi_j - pi_0 a_j - sum_{i=1..j} pi_i a_{j-i+1}) / a_0
+    std::vector<long double> pi(K, 0);
+    pi[0] = 1;
+    for (uint32_t j = 0; j + 1 < K; ++j) {
+        long double v = pi[j] - (j < a.size() ? pi[0] * a[j] : 0);
+        uint32_t first = (j + 1 >= a.size()) ? j + 2 - static_cast<uint32_t>(a.size()) : 1;
+        for (uint32_t i = std::max<uint32_t>(first, 1); i <= j; ++i) v -= pi[i] * a[j - i + 1];
+        pi[j + 1] = std::max<long double>(v / a[0], 0);
+        // 过载时数值按 1/a_0 增长，整体缩放不改变比例
+        if (pi[j + 1] > 1e300L) {
+            for (uint32_t i = 0; i <= j + 1; ++i) pi[i] *= 1e-300L;
+        }
+    }
+    long double sum = 0;
+    for (long double p : pi) sum += p;
+    for (long double& p : pi) p /= sum;
+
+    // 离去时刻分布换算为时间平均：p_j = pi_j / (pi_0 + rho)，p_K = 1 - 1 / (pi_0 + rho)
+    long double norm = pi[0] + rho;
+    long double pK = 1 - 1 / norm;
+    long double mean = K * pK;
+    for (uint32_t j = 1; j < K; ++j) mean += j * pi[j] / norm;
+    m.blocking = static_cast<double>(std::max<long double>(pK, 0));
+    m.meanPackets = static_cast<double>(mean);
+    m.sojournSec = m.meanPackets / (lambda * (1 - m.blocking));
+    return m;
+}
+
+// ==================== 网络代理模型 ====================
+
+namespace {
+
+struct DirectedLink {
+    uint32_t srcId;
+    uint32_t dstId;
+    double mu;          // 分组/秒
+    double delaySec;
+    double lossRate;    // 链路误码丢包 (接收端 RateErrorModel)
+};
+
+struct ActiveFlow {
+    uint32_t demandIndex;
+    double start;
+    double end;
+    double lambda;                  // 分组/秒
+    std::vector<uint32_t> links;    // 有向链路下标
+};
+
+} // namespace
+
+SurrogateResult PredictQueueing(const DemandPaths& paths, const SurrogateParams& params) {
+    SurrogateResult result;
+    double wireBits = (params.packetSize + UDP_IP_HEADER + PPP_HEADER) * 8.0;
+    double duty = params.onTimeMean / (params.onTimeMean + params.offTimeMean);
+    uint32_t K = params.queueSize + 1;
+
+    // 有向链路：与 starlink-sim 一致，同一端点对上重复的链路以最后一条为准
+    std::vector<DirectedLink> links;
+    std::unordered_map<uint64_t, uint32_t> linkIndex;
+    auto addLink = [&](uint32_t u, uint32_t v, const LinkParam& lp) {
+        double plr = (lp.packetLossRate > 0 && lp.packetLossRate < 1) ? lp.packetLossRate : 0;
+        DirectedLink dl{u, v, lp.dataRateBps / wireBits, lp.delayMs / 1000.0, plr};
+        uint64_t key = (static_cast<uint64_t>(u) << 32) | v;
+        auto it = linkIndex.find(key);
+        if (it != linkIndex.end()) {
+            links[it->second] = dl;
+        } else {
+            linkIndex[key] = static_cast<uint32_t>(links.size());
+            links.push_back(dl);
+        }
+    };
+    for (const auto& lp : g_links) {
+        addLink(lp.srcId, lp.dstId, lp);
+        addLink(lp.dstId, lp.srcId, lp);
+    }
+
+    std::vector<ActiveFlow> flows;
+    std::vector<double> bounds = {0, params.simTime};
+    for (size_t k = 0; k < paths.size() && k < g_demands.size(); ++k) {
+        if (paths[k].size() < 2) continue;
+        const TrafficDemand& d = g_demands[k];
+        ActiveFlow f;
+        f.demandIndex = static_cast<uint32_t>(k);
+        f.start = std::min(d.startTimeSec, params.simTime);
+        f.end = std::min(d.startTimeSec + d.durationSec, params.simTime);
+        f.lambda = d.dataRateMbps * 1e6 * params.demandScale * duty / (params.packetSize * 8.0);
+        for (size_t h = 0; h + 1 < paths[k].size(); ++h) {
+            uint64_t key = (static_cast<uint64_t>(paths[k][h]) << 32) | paths[k][h + 1];
+            f.links.push_back(linkIndex.at(key));
+        }
+        bounds.push_back(f.start);
+        bounds.push_back(f.end);
+        flows.push_back(std::move(f));
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+    // 逐段累计
+    std::vector<double> offered(flows.size(), 0), delivered(flows.size(), 0), delaySum(flows.size(), 0);
+    std::vector<double> maxLoad(flows.size(), 0);
+    std::vector<double> loadTime(links.size(), 0), peakLoad(links.size(), 0), peakBlocking(links.size(), 0);
+    std::vector<bool> used(links.size(), false);
+
+    std::vector<double> arrival(links.size()), blocking(links.size()), sojourn(links.size());
+    std::vector<uint32_t> active;
+    for (size_t s = 0; s + 1 < bounds.size(); ++s) {
+        double t0 = bounds[s], t1 = bounds[s + 1], dt = t1 - t0;
+        active.clear();
+        for (uint32_t i = 0; i < flows.size(); ++i) {
+            if (flows[i].start <= t0 && flows[i].end >= t1 && flows[i].lambda > 0) active.push_back(i);
+        }
+        if (active.empty() || dt <= 0) continue;
+        result.segments++;
+
+        // 不动点：下游到达率取决于上游丢包，上游丢包又取决于共享链路上的总到达率
+        std::fill(blocking.begin(), blocking.end(), 0.0);
+        for (int iter = 0; iter < 50; ++iter) {
+            std::fill(arrival.begin(), arrival.end(), 0.0);
+            for (uint32_t i : active) {
+                double rate = flows[i].lambda;
+                for (uint32_t l : flows[i].links) {
+                    arrival[l] += rate;
+                    rate *= (1 - blocking[l]) * (1 - links[l].lossRate);
+                }
+            }
+            double change = 0;
+            for (size_t l = 0; l < links.size(); ++l) {
+                if (arrival[l] <= 0) continue;
+                QueueMetrics q = (params.model == QueueModel::MM1K) ? SolveMM1K(arrival[l], links[l].mu, K)
+                                                                    : SolveMD1K(arrival[l], links[l].mu, K);
+                change = std::max(change, std::fabs(q.blocking - blocking[l]));
+                blocking[l] = q.blocking;
+                sojourn[l] = q.sojournSec;
+            }
+            if (change < 1e-9) break;
+        }
+
+        for (size_t l = 0; l < links.size(); ++l) {
+            if (arrival[l] <= 0) continue;
+            double rho = arrival[l] / links[l].mu;
+            used[l] = true;
+            loadTime[l] += rho * dt;
+            peakLoad[l] = std::max(peakLoad[l], rho);
+            peakBlocking[l] = std::max(peakBlocking[l], blocking[l]);
+        }
+        for (uint32_t i : active) {
+            double survive = 1, delay = 0;
+            for (uint32_t l : flows[i].links) {
+                survive *= (1 - blocking[l]) * (1 - links[l].lossRate);
+                delay += sojourn[l] + links[l].delaySec;
+                maxLoad[i] = std::max(maxLoad[i], arrival[l] / links[l].mu);
+            }
+            double packets = flows[i].lambda * dt;
+            offered[i] += packets;
+            delivered[i] += packets * survive;
+            delaySum[i] += delay * packets * survive;
+        }
+    }
+
+    for (size_t i = 0; i < flows.size(); ++i) {
+        SurrogateFlow f;
+        f.demandIndex = flows[i].demandIndex;
+        f.hops = static_cast<uint32_t>(flows[i].links.size());
+        double duration = flows[i].end - flows[i].start;
+        if (duration > 0) {
+            f.throughputMbps = delivered[i] * (params.packetSize + UDP_IP_HEADER) * 8.0 / duration / 1e6;
+        }
+        if (delivered[i] > 0) f.delayMs = delaySum[i] / delivered[i] * 1000.0;
+        if (offered[i] > 0) f.lossRate = 1 - delivered[i] / offered[i];
+        f.maxLinkLoad = maxLoad[i];
+        result.flows.push_back(f);
+    }
+    for (size_t l = 0; l < links.size(); ++l) {
+        if (!used[l]) continue;
+        SurrogateLink sl;
+        sl.srcId = links[l].srcId;
+        sl.dstId = links[l].dstId;
+        sl.meanLoad = params.simTime > 0 ? loadTime[l] / params.simTime : 0;
+        sl.peakLoad = peakLoad[l];
+        sl.peakBlocking = peakBlocking[l];
+        result.links.push_back(sl);
+    }
+    return result;
+}
+
+bool WriteSurrogateResults(const std::string& file, const SurrogateResult& result, bool compress) {
+    OutputFile f;
+    if (!f.Open(file, compress)) {
+        std::cerr << "❌ 无法创建输出文件: " << file << std::endl;
+        return false;
+    }
+    f << "DemandId,SrcNode,DstNode,HopCount,Throughput_Mbps,MeanDelay_ms,PacketLossRate,MaxLinkLoad\n";
+    f << std::fixed << std::setprecision(6);
+    for (const auto& flow : result.flows) {
+        const TrafficDemand& d = g_demands[flow.demandIndex];
+        f << d.demandId << "," << d.srcNode << "," << d.dstNode << "," << flow.hops << ","
+          << flow.throughputMbps << "," << flow.delayMs << "," << flow.lossRate << "," << flow.maxLinkLoad << "\n";
+    }
+    return f.Close();
+}
+
+bool WriteSurrogateLinks(const std::string& file, const SurrogateResult& result, bool compress) {
+    OutputFile f;
+    if (!f.Open(file, compress)) {
+        std::cerr << "❌ 无法创建输出文件: " << file << std::endl;
+        return false;
+    }
+    f << "SrcNode,DstNode,MeanLoad,PeakLoad,PeakLossRate\n";
+    f << std::fixed << std::setprecision(6);
+    for (const auto& link : result.links) {
+        f << GetNodeName(link.srcId) << "," << GetNodeName(link.dstId) << ","
+          << link.meanLoad << "," << link.peakLoad << "," << link.peakBlocking << "\n";
+    }
+    return f.Close();
+}
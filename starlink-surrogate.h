@@ -0,0 +1,78 @@
+#ifndef STARLINK_SURROGATE_H
+#define STARLINK_SURROGATE_H
+
+// starlink-surrogate.h - 排队论代理模型：在分组级仿真之前快速估计每条流的时延 / 丢包 / 吞吐
+// 每个有向链路 (一个 PointToPointNetDevice) 视为单服务台有限缓冲队列：
+//   容量 K = queueSize + 1 (DropTail 队列 + 正在发送的分组)，
+//   服务率 mu = dataRateBps / 线路上的分组比特数 (应用分组 + UDP/IP/PPP 头)，
+//   到达率为经过该链路的各流平均速率 (OnOff 占空比 on/(on+off)) 按上游丢包逐跳稀释。
+// 需求的起止时刻把仿真时间切成若干段，每段内各链路负载与丢包做不动点迭代，
+// 流的指标按段加权汇总。OnOff 源比泊松过程更突发，负载较高时模型会低估排队时延和丢包，
+// 与 ns-3 结果的对比见 surrogate_report.py。
+
+#include "starlink-topology.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class QueueModel { MM1K, MD1K };
+
+// "mm1k" / "md1k"，无法识别时返回 false
+bool ParseQueueModel(const std::string& name, QueueModel& model);
+
+// ==================== 单队列 ====================
+
+struct QueueMetrics {
+    double blocking = 0;        // 到达被丢弃的概率
+    double sojournSec = 0;      // 被接纳分组的平均逗留时间 (排队 + 发送)
+    double meanPackets = 0;     // 时间平均的系统内分组数
+};
+
+// lambda / mu 为每秒分组数，K 为系统容量 (含服务中的分组)
+QueueMetrics SolveMM1K(double lambda, double mu, uint32_t K);
+// 嵌入马尔可夫链 (离去时刻) 求解，再换算为时间平均分布
+QueueMetrics SolveMD1K(double lambda, double mu, uint32_t K);
+
+// ==================== 网络代理模型 ====================
+
+struct SurrogateParams {
+    QueueModel model = QueueModel::MD1K;
+    uint32_t queueSize = 500;       // 分组
+    uint32_t packetSize = 1024;     // 应用层字节
+    double onTimeMean = 1.0;
+    double offTimeMean = 0.5;
+    double demandScale = 1.0;
+    double simTime = 10.0;
+};
+
+struct SurrogateFlow {
+    uint32_t demandIndex = 0;
+    uint32_t hops = 0;
+    double throughputMbps = 0;      // 与 FlowMonitor 一致，含 UDP/IP 头
+    double delayMs = 0;
+    double lossRate = 0;
+    double maxLinkLoad = 0;         // 路径上各链路负载 (rho) 的最大值
+};
+
+struct SurrogateLink {
+    uint32_t srcId = 0;
+    uint32_t dstId = 0;
+    double meanLoad = 0;            // 按仿真时长平均的 rho
+    double peakLoad = 0;
+    double peakBlocking = 0;
+};
+
+struct SurrogateResult {
+    std::vector<SurrogateFlow> flows;   // 只含有路径的需求
+    std::vector<SurrogateLink> links;   // 只含承载过流量的有向链路
+    uint32_t segments = 0;
+};
+
+SurrogateResult PredictQueueing(const DemandPaths& paths, const SurrogateParams& params);
+
+// compress 时写分块 gzip (starlink-zstream.h)
+bool WriteSurrogateResults(const std::string& file, const SurrogateResult& result, bool compress = false);
+bool WriteSurrogateLinks(const std::string& file, const SurrogateResult& result, bool compress = false);
+
+#endif // STARLINK_SURROGATE_H
@@ -0,0 +1,166 @@
+#include "starlink-sweep.h"
+#include "starlink-replication.h"
+#include "starlink-topology.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+
+// ==================== 扫描描述 ====================
+
+static bool ParseDouble(const std::string& s, double& v) {
+    try {
+        size_t pos = 0;
+        v = std::stod(s, &pos);
+        return pos == s.size();
+    } catch (...) {
+        return false;
+    }
+}
+
+bool ParseSweepSpec(const std::string& spec, std::vector<SweepParam>& params) {
+    params.clear();
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ';')) {
+        item = Trim(item);
+        if (item.empty()) continue;
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) {
+            std::cerr << "❌ 扫描参数缺少 '=': " << item << std::endl;
+            return false;
+        }
+        SweepParam p;
+        p.name = Trim(item.substr(0, eq));
+        std::string values = Trim(item.substr(eq + 1));
+        for (const auto& q : params) {
+            if (q.name == p.name) {
+                std::cerr << "❌ 扫描参数重复: " << p.name << std::endl;
+                return false;
+            }
+        }
+
+        size_t colon = values.find(':');
+        if (colon != std::string::npos) {
+            if (!ParseDouble(Trim(values.substr(0, colon)), p.lo) ||
+                !ParseDouble(Trim(values.substr(colon + 1)), p.hi) || p.hi < p.lo) {
+                std::cerr << "❌ 扫描区间无效: " << item << std::endl;
+                return false;
+            }
+            p.range = true;
+        } else {
+            std::stringstream vs(values);
+            std::string v;
+            while (std::getline(vs, v, ',')) {
+                v = Trim(v);
+                if (!v.empty()) p.values.push_back(v);
+            }
+        }
+        if (p.name.empty() || (!p.range && p.values.empty())) {
+            std::cerr << "❌ 扫描参数无取值: " << item << std::endl;
+            return false;
+        }
+        params.push_back(p);
+    }
+    return !params.empty();
+}
+
+// ==================== 扫描点 ====================
+
+std::vector<SweepPoint> GridPoints(const std::vector<SweepParam>& params) {
+    std::vector<SweepPoint> points;
+    for (const auto& p : params) {
+        if (p.range) {
+            std::cerr << "❌ 网格扫描不支持区间参数: " << p.name << std::endl;
+            return points;
+        }
+    }
+    points.push_back(SweepPoint());
+    for (const auto& p : params) {
+        std::vector<SweepPoint> next;
+        next.reserve(points.size() * p.values.size());
+        for (const auto& point : points) {
+            for (const auto& v : p.values) {
+                next.push_back(point);
+                next.back().push_back(v);
+            }
+        }
+        points.swap(next);
+    }
+    return points;
+}
+
+std::vector<SweepPoint> LatinHypercubePoints(const std::vector<SweepParam>& params,
+                                             uint32_t samples, uint64_t seed) {
+    std::vector<SweepPoint> points(samples);
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (const auto& p : params) {
+        std::vector<uint32_t> strata(samples);
+        for (uint32_t i = 0; i < samples; ++i) strata[i] = i;
+        std::shuffle(strata.begin(), strata.end(), rng);
+        for (uint32_t i = 0; i < samples; ++i) {
+            // 第 strata[i] 层内均匀取一点，u 落在 [0, 1)
+            double u = (strata[i] + uniform(rng)) / samples;
+            if (p.range) {
+                std::ostringstream v;
+                double x = p.lo + u * (p.hi - p.lo);
+                if (p.integer) v << std::llround(x);
+                else v << x;
+                points[i].push_back(v.str());
+            } else {
+                size_t idx = std::min(p.values.size() - 1, static_cast<size_t>(u * p.values.size()));
+                points[i].push_back(p.values[idx]);
+            }
+        }
+    }
+    // 离散参数层数少于样本数时会出现重复点，保留首次出现的顺序
+    std::set<SweepPoint> seen;
+    std::vector<SweepPoint> unique;
+    for (auto& point : points) {
+        if (seen.insert(point).second) unique.push_back(std::move(point));
+    }
+    return unique;
+}
+
+// ==================== 结果汇总 ====================
+
+bool WriteSweepTable(const std::vector<SweepParam>& params, const std::vector<SweepPoint>& points,
+                     const std::vector<std::string>& files, const std::string& outFile) {
+    std::ofstream out(outFile);
+    if (!out.is_open()) {
+        std::cerr << "❌ 无法创建输出文件: " << outFile << std::endl;
+        return false;
+    }
+    std::vector<std::string> header;
+    size_t written = 0;
+    for (size_t i = 0; i < points.size() && i < files.size(); ++i) {
+        CsvTable t;
+        if (!ReadCsv(files[i], t)) {
+            std::cerr << "⚠️ 缺少扫描点结果: " << files[i] << std::endl;
+            continue;
+        }
+        if (header.empty()) {
+            header = t.header;
+            out << "Point";
+            for (const auto& p : params) out << "," << p.name;
+            for (const auto& h : header) out << "," << h;
+            out << "\n";
+        } else if (t.header != header) {
+            std::cerr << "⚠️ 扫描点结果列不一致，已跳过: " << files[i] << std::endl;
+            continue;
+        }
+        for (const auto& row : t.rows) {
+            out << i;
+            for (const auto& v : points[i]) out << "," << v;
+            for (const auto& f : row) out << "," << f;
+            out << "\n";
+        }
+        written++;
+    }
+    return written > 0;
+}
@@ -0,0 +1,40 @@
+#ifndef STARLINK_SWEEP_H
+#define STARLINK_SWEEP_H
+
+// starlink-sweep.h - 参数扫描：扫描点生成与结果汇总
+// 扫描描述形如 "queueSize=100,500,1000;packetSize=512,1024;routing=delay,hop"，
+// 数值参数在拉丁超立方模式下也可以写成区间 "demandScale=0.5:2"。
+// 网格模式取笛卡尔积，拉丁超立方模式在每一维上分层抽样 samples 个点。
+// 扫描点在 starlink-sim 中由 ForkWorkers 分发，拓扑解析和路由计算在父进程中只做一次。
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct SweepParam {
+    std::string name;
+    std::vector<std::string> values;   // 离散取值
+    bool range = false;                // lo:hi 连续区间 (仅拉丁超立方)
+    double lo = 0;
+    double hi = 0;
+    bool integer = false;              // 区间抽样的取值四舍五入为整数 (由调用方设置)
+};
+
+// 每个扫描点的取值与 params 一一对应
+using SweepPoint = std::vector<std::string>;
+
+bool ParseSweepSpec(const std::string& spec, std::vector<SweepParam>& params);
+
+// 笛卡尔积，最后一个参数变化最快；区间参数不能用于网格
+std::vector<SweepPoint> GridPoints(const std::vector<SweepParam>& params);
+
+// 拉丁超立方：每一维分成 samples 层，各层恰好取一次，维间随机配对；去掉重复点
+std::vector<SweepPoint> LatinHypercubePoints(const std::vector<SweepParam>& params,
+                                             uint32_t samples, uint64_t seed);
+
+// 汇总各扫描点的结果 CSV：首列 Point，随后每个参数一列，再接原表的列；
+// 缺失的结果文件跳过并告警
+bool WriteSweepTable(const std::vector<SweepParam>& params, const std::vector<SweepPoint>& points,
+                     const std::vector<std::string>& files, const std::string& outFile);
+
+#endif // STARLINK_SWEEP_H
@@ -0,0 +1,59 @@
+#include "starlink-timeseries.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+RingSeries::~RingSeries() {
+    Close();
+}
+
+bool RingSeries::Open(const std::string& file, const std::string& keyName, const std::vector<std::string>& labels,
+                      double binSec, uint32_t ringBins, bool compress) {
+    Close();
+    if (!m_out.Open(file, compress)) {
+        std::cerr << "❌ 无法创建时间序列文件: " << m_out.Path() << std::endl;
+        return false;
+    }
+    m_out << "Bin,Time_s," << keyName << ",Bytes,Throughput_Mbps\n";
+    m_out << std::fixed << std::setprecision(6);
+    m_labels = labels;
+    m_series = static_cast<uint32_t>(labels.size());
+    m_ringBins = std::max<uint32_t>(ringBins, 1);
+    m_binSec = binSec;
+    m_counts.assign(static_cast<size_t>(m_ringBins) * m_series, 0);
+    m_baseBin = 0;
+    m_lastBin = 0;
+    m_rows = 0;
+    return true;
+}
+
+void RingSeries::FlushBin(uint64_t bin) {
+    uint64_t* row = &m_counts[(bin % m_ringBins) * m_series];
+    double t = bin * m_binSec;
+    m_out.MarkTime(t);
+    for (uint32_t s = 0; s < m_series; ++s) {
+        if (row[s] == 0) continue;
+        m_out << bin << "," << t << "," << m_labels[s] << "," << row[s] << ","
+              << row[s] * 8.0 / m_binSec / 1e6 << "\n";
+        row[s] = 0;
+        m_rows++;
+    }
+}
+
+// 写出 [m_baseBin, bin - m_ringBins] 的时间窗，使 bin 落入环内
+void RingSeries::Advance(uint64_t bin) {
+    uint64_t newBase = bin - m_ringBins + 1;
+    // 跳过的时间窗超过一整圈时只需写出环中现有的行
+    uint64_t flushEnd = std::min(newBase, m_baseBin + m_ringBins);
+    for (uint64_t b = m_baseBin; b < flushEnd; ++b) FlushBin(b);
+    m_baseBin = newBase;
+}
+
+void RingSeries::Close() {
+    if (!m_out.IsOpen()) return;
+    for (uint64_t b = m_baseBin; b <= m_lastBin && b < m_baseBin + m_ringBins; ++b) FlushBin(b);
+    m_out.Close();
+    m_counts.clear();
+    m_counts.shrink_to_fit();
+}
@@ -0,0 +1,54 @@
+#ifndef STARLINK_TIMESERIES_H
+#define STARLINK_TIMESERIES_H
+
+// starlink-timeseries.h - 按时间窗统计的字节数时间序列
+// 每条序列 (需求或链路方向) 在每个 binSec 宽的时间窗内累加字节数。计数保存在
+// ringBins 行的环形数组中 (行 = 时间窗，列 = 序列)，时间推进到环外时把最旧的行
+// 写出并清零，内存固定为 ringBins x 序列数 x 8 字节，与仿真时长无关。
+// 输出为长表 CSV：Bin,Time_s,<键>,Bytes,Throughput_Mbps，只写非零项；compress 时为
+// 按时间分块的 gzip (starlink-zstream.h)。
+
+#include "starlink-zstream.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class RingSeries {
+public:
+    ~RingSeries();
+
+    // labels 为各序列在键列中的取值
+    bool Open(const std::string& file, const std::string& keyName, const std::vector<std::string>& labels,
+              double binSec, uint32_t ringBins, bool compress = false);
+    // 写出所有未写出的时间窗
+    void Close();
+    bool IsOpen() const { return m_out.IsOpen(); }
+
+    // 时间需单调不减 (仿真时钟)，早于已写出时间窗的样本计入最旧的窗
+    void Add(uint32_t series, double timeSec, uint64_t bytes) {
+        uint64_t bin = static_cast<uint64_t>(timeSec / m_binSec + 1e-9);
+        if (bin < m_baseBin) bin = m_baseBin;
+        else if (bin >= m_baseBin + m_ringBins) Advance(bin);
+        m_counts[(bin % m_ringBins) * m_series + series] += bytes;
+        if (bin > m_lastBin) m_lastBin = bin;
+    }
+
+    uint64_t RowsWritten() const { return m_rows; }
+
+private:
+    void Advance(uint64_t bin);
+    void FlushBin(uint64_t bin);
+
+    OutputFile m_out;
+    std::vector<std::string> m_labels;
+    std::vector<uint64_t> m_counts;
+    uint32_t m_series = 0;
+    uint32_t m_ringBins = 1;
+    double m_binSec = 1.0;
+    uint64_t m_baseBin = 0;     // 环中最旧的时间窗
+    uint64_t m_lastBin = 0;
+    uint64_t m_rows = 0;
+};
+
+#endif // STARLINK_TIMESERIES_H
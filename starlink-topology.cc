@@ -0,0 +1,269 @@
+#include "starlink-topology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <sstream>
+
+// ==================== 内存资源 ====================
+
+// 转发资源本身不持有内存；arena 在首次启用时创建，进程结束前不销毁
+class SetupResource : public std::pmr::memory_resource {
+public:
+    std::pmr::monotonic_buffer_resource* arena = nullptr;
+    uint64_t arenaBytes = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t align) override {
+        if (!arena) return std::pmr::new_delete_resource()->allocate(bytes, align);
+        return arena->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+        if (!arena) std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// 统计 arena 向上游申请的字节数
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(uint64_t& counter) : m_counter(counter) {}
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t align) override {
+        m_counter += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+        m_counter -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    uint64_t& m_counter;
+};
+
+static SetupResource& GetSetupResourceImpl() {
+    static SetupResource resource;
+    return resource;
+}
+
+std::pmr::memory_resource* GetSetupResource() {
+    return &GetSetupResourceImpl();
+}
+
+void EnableSetupArena() {
+    SetupResource& r = GetSetupResourceImpl();
+    if (r.arena) return;
+    static CountingResource upstream(r.arenaBytes);
+    static std::pmr::monotonic_buffer_resource arena(1 << 20, &upstream);
+    r.arena = &arena;
+}
+
+void DisableSetupArena() {
+    SetupResource& r = GetSetupResourceImpl();
+    if (!r.arena) return;
+    r.arena->release();
+    r.arena = nullptr;
+}
+
+bool IsSetupArenaEnabled() {
+    return GetSetupResourceImpl().arena != nullptr;
+}
+
+void ReleaseSetupArena() {
+    SetupResource& r = GetSetupResourceImpl();
+    if (r.arena) r.arena->release();
+}
+
+uint64_t GetSetupArenaBytes() {
+    return GetSetupResourceImpl().arenaBytes;
+}
+
+ScratchArena::ScratchArena(std::size_t initialBytes)
+    : m_buffer(initialBytes ? initialBytes : 1),
+      m_resource(m_buffer.data(), m_buffer.size()) {}
+
+// ==================== 全局变量 ====================
+std::pmr::vector<LinkParam> g_links(GetSetupResource());
+std::pmr::vector<TrafficDemand> g_demands(GetSetupResource());
+uint32_t g_numNodes = 0;
+std::pmr::map<uint32_t, std::string> g_nodeIdToName(GetSetupResource());
+std::pmr::vector<std::pmr::vector<std::pair<uint32_t, double>>> g_adjList(GetSetupResource());
+
+// ==================== 工具函数 ====================
+
+std::string Trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(start, end - start + 1);
+}
+
+std::string GetNodeName(uint32_t nodeId) {
+    auto it = g_nodeIdToName.find(nodeId);
+    return (it != g_nodeIdToName.end()) ? it->second : "Node_" + std::to_string(nodeId);
+}
+
+// ==================== 加载数据 ====================
+
+bool LoadLinks(std::istream& f) {
+    std::string line; std::getline(f, line);
+    while (std::getline(f, line)) {
+        if (Trim(line).empty()) continue;
+        std::stringstream ss(line); std::string tok; LinkParam p;
+        try {
+            std::getline(ss, tok, ','); p.srcId = std::stoul(Trim(tok));
+            std::getline(ss, tok, ','); p.dstId = std::stoul(Trim(tok));
+            std::getline(ss, tok, ','); p.srcName = Trim(tok);
+            std::getline(ss, tok, ','); p.dstName = Trim(tok);
+            std::getline(ss, tok, ','); p.delayMs = std::stod(Trim(tok));
+            std::getline(ss, tok, ','); p.dataRateBps = std::stoull(Trim(tok));
+            if (std::getline(ss, tok, ',')) p.packetLossRate = std::stod(Trim(tok)); else p.packetLossRate = 0;
+            if (std::getline(ss, tok, ',')) p.distanceKm = std::stod(Trim(tok)); else p.distanceKm = 0;
+            if (p.delayMs <= 0) p.delayMs = 1.0;
+            if (p.dataRateBps < 1000) p.dataRateBps = 1000000;
+            g_links.push_back(p);
+            g_nodeIdToName[p.srcId] = p.srcName; g_nodeIdToName[p.dstId] = p.dstName;
+            uint32_t m = std::max(p.srcId, p.dstId) + 1;
+            if (m > g_numNodes) g_numNodes = m;
+        } catch (...) { continue; }
+    }
+    BuildAdjacency();
+    return !g_links.empty();
+}
+
+void BuildAdjacency() {
+    decltype(g_adjList)(GetSetupResource()).swap(g_adjList);
+    g_adjList.resize(g_numNodes);
+    for (const auto& link : g_links) {
+        g_adjList[link.srcId].push_back({link.dstId, link.delayMs});
+        g_adjList[link.dstId].push_back({link.srcId, link.delayMs});
+    }
+}
+
+bool LoadLinks(const std::string& file) {
+    std::ifstream f(file.c_str());
+    if (!f.is_open()) { std::cerr << "Cannot open: " << file << std::endl; return false; }
+    bool ok = LoadLinks(f);
+    f.close();
+    std::cout << "Loaded " << g_links.size() << " links\n";
+    return ok;
+}
+
+bool LoadDemands(std::istream& f) {
+    std::string line; std::getline(f, line);
+    while (std::getline(f, line)) {
+        if (Trim(line).empty()) continue;
+        std::stringstream ss(line); std::string tok; TrafficDemand d;
+        try {
+            std::getline(ss, tok, ','); d.demandId = std::stoul(Trim(tok));
+            std::getline(ss, tok, ','); d.srcNode = Trim(tok);
+            std::getline(ss, tok, ','); d.dstNode = Trim(tok);
+            std::getline(ss, tok, ','); d.srcId = std::stoul(Trim(tok));
+            std::getline(ss, tok, ','); d.dstId = std::stoul(Trim(tok));
+            std::getline(ss, tok, ','); d.dataRateMbps = std::stod(Trim(tok));
+            std::getline(ss, tok, ','); d.startTimeSec = std::stod(Trim(tok));
+            std::getline(ss, tok, ','); d.durationSec = std::stod(Trim(tok));
+            g_demands.push_back(d);
+        } catch (...) { continue; }
+    }
+    return !g_demands.empty();
+}
+
+bool LoadDemands(const std::string& file) {
+    std::ifstream f(file.c_str());
+    if (!f.is_open()) return false;
+    bool ok = LoadDemands(f);
+    f.close();
+    std::cout << "Loaded " << g_demands.size() << " traffic demands\n";
+    return ok;
+}
+
+// 与空容器交换以释放容量，之后才能安全地 ReleaseSetupArena()
+void ResetTopology() {
+    decltype(g_links)(GetSetupResource()).swap(g_links);
+    decltype(g_demands)(GetSetupResource()).swap(g_demands);
+    g_numNodes = 0;
+    g_nodeIdToName.clear();
+    decltype(g_adjList)(GetSetupResource()).swap(g_adjList);
+}
+
+// ==================== Dijkstra ====================
+
+bool ParseRouteMetric(const std::string& name, RouteMetric& metric) {
+    if (name == "delay") metric = RouteMetric::Delay;
+    else if (name == "hop") metric = RouteMetric::HopCount;
+    else return false;
+    return true;
+}
+
+DijkstraResult Dijkstra(uint32_t src, uint32_t numNodes, std::pmr::memory_resource* mr, RouteMetric metric) {
+    using Entry = std::pair<double, uint32_t>;
+    DijkstraResult result{std::pmr::vector<double>(mr), std::pmr::vector<int>(mr)};
+    result.dist.assign(numNodes, std::numeric_limits<double>::infinity());
+    result.prev.assign(numNodes, -1);
+    result.dist[src] = 0;
+    std::priority_queue<Entry, std::pmr::vector<Entry>, std::greater<Entry>> pq{std::greater<Entry>(), std::pmr::vector<Entry>(mr)};
+    pq.push({0, src});
+    while (!pq.empty()) {
+        auto [d, u] = pq.top(); pq.pop();
+        if (d > result.dist[u]) continue;
+        for (auto& [v, delayMs] : g_adjList[u]) {
+            double w = (metric == RouteMetric::HopCount) ? 1.0 : delayMs;
+            if (result.dist[u] + w < result.dist[v]) {
+                result.dist[v] = result.dist[u] + w;
+                result.prev[v] = u;
+                pq.push({result.dist[v], v});
+            }
+        }
+    }
+    return result;
+}
+
+std::pmr::vector<uint32_t> GetPath(uint32_t src, uint32_t dst, const DijkstraResult& dijkstra,
+                                   std::pmr::memory_resource* mr) {
+    std::pmr::vector<uint32_t> path(mr);
+    if (dijkstra.dist[dst] == std::numeric_limits<double>::infinity()) return path;
+    for (int at = dst; at != -1; at = dijkstra.prev[at]) path.push_back(at);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+DemandPaths ComputeDemandPaths(RouteMetric metric, bool useScratch, const std::vector<uint32_t>* components) {
+    DemandPaths paths(g_demands.size(), GetSetupResource());
+    // 按源节点分组，每个源只跑一次 Dijkstra；结果和优先队列复用同一块临时缓冲
+    std::vector<uint32_t> order;
+    order.reserve(g_demands.size());
+    for (size_t k = 0; k < g_demands.size(); k++) {
+        const auto& demand = g_demands[k];
+        if (demand.srcId >= g_numNodes || demand.dstId >= g_numNodes) continue;
+        if (g_adjList[demand.srcId].empty() || g_adjList[demand.dstId].empty()) continue;
+        if (components && (*components)[demand.srcId] != (*components)[demand.dstId]) continue;
+        order.push_back(static_cast<uint32_t>(k));
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [](uint32_t a, uint32_t b) { return g_demands[a].srcId < g_demands[b].srcId; });
+
+    ScratchArena scratch(useScratch ? g_numNodes * 128 : 0);
+    std::pmr::memory_resource* mr = useScratch ? scratch.Resource() : std::pmr::get_default_resource();
+    DijkstraResult dijkstra{std::pmr::vector<double>(mr), std::pmr::vector<int>(mr)};
+    uint32_t currentSrc = UINT32_MAX;
+    for (uint32_t k : order) {
+        const auto& demand = g_demands[k];
+        if (demand.srcId != currentSrc) {
+            currentSrc = demand.srcId;
+            // 复位后旧结果不再被读取，移动赋值只对它调用 (空操作的) deallocate
+            if (useScratch) scratch.Reset();
+            dijkstra = Dijkstra(currentSrc, g_numNodes, mr, metric);
+        }
+        paths[k] = GetPath(demand.srcId, demand.dstId, dijkstra, GetSetupResource());
+    }
+    return paths;
+}
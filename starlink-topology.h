@@ -0,0 +1,125 @@
+#ifndef STARLINK_TOPOLOGY_H
+#define STARLINK_TOPOLOGY_H
+
+// starlink-topology.h - 拓扑与流量需求的加载和最短路径计算
+// 不依赖 ns-3，starlink-sim 和 bench/ 下的微基准共用同一份实现。
+// 安装期容器从 GetSetupResource() 分配，启用 setup arena 后整片释放。
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ==================== 内存资源 ====================
+// GetSetupResource() 是一个固定的转发资源，全局容器在构造时绑定它。
+// EnableSetupArena() 之后转发到单调增长的 arena：分配只移动指针，逐个释放为空操作，
+// 由 ReleaseSetupArena() 一次性归还；未启用时转发到 new/delete，行为与普通容器相同。
+// 名称字段长度在 SSO 范围内，LinkParam / TrafficDemand 中的 std::string 不单独分配。
+
+std::pmr::memory_resource* GetSetupResource();
+// 切换前后所有使用 GetSetupResource() 的容器必须为空 (未分配内存)
+void EnableSetupArena();
+void DisableSetupArena();
+bool IsSetupArenaEnabled();
+// 调用前所有使用 GetSetupResource() 的容器必须已经清空并释放容量
+void ReleaseSetupArena();
+// arena 已向上游申请的字节数
+uint64_t GetSetupArenaBytes();
+
+// 单次计算的临时分配区：预留一块缓冲，Reset 后下一次计算复用同一块内存，
+// 超出部分向上游申请并在 Reset 时归还
+class ScratchArena {
+public:
+    explicit ScratchArena(std::size_t initialBytes);
+
+    std::pmr::memory_resource* Resource() { return &m_resource; }
+    void Reset() { m_resource.release(); }
+
+private:
+    std::vector<std::byte> m_buffer;
+    std::pmr::monotonic_buffer_resource m_resource;
+};
+
+// ==================== 数据结构 ====================
+
+struct LinkParam {
+    uint32_t srcId;
+    uint32_t dstId;
+    std::string srcName;
+    std::string dstName;
+    double delayMs;
+    uint64_t dataRateBps;
+    double packetLossRate;
+    double distanceKm;
+};
+
+struct TrafficDemand {
+    uint32_t demandId;
+    std::string srcNode;
+    std::string dstNode;
+    uint32_t srcId;
+    uint32_t dstId;
+    double dataRateMbps;
+    double startTimeSec;
+    double durationSec;
+};
+
+struct DijkstraResult {
+    std::pmr::vector<double> dist;
+    std::pmr::vector<int> prev;
+};
+
+// ==================== 全局变量 ====================
+extern std::pmr::vector<LinkParam> g_links;
+extern std::pmr::vector<TrafficDemand> g_demands;
+extern uint32_t g_numNodes;
+extern std::pmr::map<uint32_t, std::string> g_nodeIdToName;
+extern std::pmr::vector<std::pmr::vector<std::pair<uint32_t, double>>> g_adjList;
+
+// ==================== 工具函数 ====================
+
+std::string Trim(const std::string& s);
+std::string GetNodeName(uint32_t nodeId);
+
+// ==================== 加载数据 ====================
+
+// 流版本供微基准从内存缓冲区加载，文件版本额外打印加载条数
+bool LoadLinks(std::istream& in);
+bool LoadLinks(const std::string& file);
+bool LoadDemands(std::istream& in);
+bool LoadDemands(const std::string& file);
+
+// 由 g_links 重建 g_adjList (LoadLinks 之后修改了 g_links 时调用)
+void BuildAdjacency();
+
+// 清空上述全局拓扑数据并释放容量 (不释放 setup arena)
+void ResetTopology();
+
+// ==================== Dijkstra ====================
+
+// 边权：链路传播时延 (ms) 或跳数
+enum class RouteMetric { Delay, HopCount };
+
+// "delay" / "hop"，无法识别时返回 false
+bool ParseRouteMetric(const std::string& name, RouteMetric& metric);
+
+// 结果和优先队列从 mr 分配；逐条需求计算时传入 ScratchArena 避免反复 malloc
+DijkstraResult Dijkstra(uint32_t src, uint32_t numNodes,
+                        std::pmr::memory_resource* mr = std::pmr::get_default_resource(),
+                        RouteMetric metric = RouteMetric::Delay);
+std::pmr::vector<uint32_t> GetPath(uint32_t src, uint32_t dst, const DijkstraResult& dijkstra,
+                                   std::pmr::memory_resource* mr = std::pmr::get_default_resource());
+
+// 每条需求 (与 g_demands 下标对应) 的路径，不可达或端点不在拓扑中的需求为空
+using DemandPaths = std::pmr::vector<std::pmr::vector<uint32_t>>;
+
+// 逐条需求计算路径，结果从 GetSetupResource() 分配；useScratch 时 Dijkstra 使用 ScratchArena。
+// 给出各节点的连通分量编号时，端点不在同一分量的需求直接跳过
+DemandPaths ComputeDemandPaths(RouteMetric metric, bool useScratch,
+                               const std::vector<uint32_t>* components = nullptr);
+
+#endif // STARLINK_TOPOLOGY_H
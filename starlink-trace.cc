@@ -0,0 +1,330 @@
+#include "starlink-trace.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <vector>
+
+static const char kMagic[8] = {'S', 'L', 'T', 'R', 'A', 'C', 'E', '1'};
+static const uint32_t kVersion = 1;
+static const size_t kHeaderSize = 40;
+static const size_t kRecordSize = 12;
+static const size_t kReleaseChunk = 64u << 20;     // 每读过 64 MB 释放一次
+
+// ==================== 写入 ====================
+
+TraceWriter::~TraceWriter() {
+    if (m_out.is_open()) Close();
+}
+
+bool TraceWriter::Open(const std::string& file) {
+    m_out.open(file.c_str(), std::ios::binary | std::ios::trunc);
+    if (!m_out.is_open()) {
+        std::cerr << "❌ 无法创建轨迹文件: " << file << std::endl;
+        return false;
+    }
+    char header[kHeaderSize] = {};
+    m_out.write(header, kHeaderSize);       // Close 时回填
+    m_count = 0;
+    m_reordered = 0;
+    return true;
+}
+
+void TraceWriter::WriteRecord(uint32_t deltaNs, uint16_t size, uint16_t flags, uint32_t demandId) {
+    char rec[kRecordSize];
+    std::memcpy(rec, &deltaNs, 4);
+    std::memcpy(rec + 4, &size, 2);
+    std::memcpy(rec + 6, &flags, 2);
+    std::memcpy(rec + 8, &demandId, 4);
+    m_out.write(rec, kRecordSize);
+}
+
+void TraceWriter::Add(uint64_t absTimeNs, uint32_t size, uint32_t demandId) {
+    if (m_count == 0) {
+        m_baseNs = m_lastNs = absTimeNs;
+    } else if (absTimeNs < m_lastNs) {
+        absTimeNs = m_lastNs;
+        m_reordered++;
+    }
+    uint64_t delta = absTimeNs - m_lastNs;
+    const uint64_t maxDelta = std::numeric_limits<uint32_t>::max();
+    while (delta > maxDelta) {
+        WriteRecord(static_cast<uint32_t>(maxDelta), 0, TRACE_FLAG_GAP, 0);
+        delta -= maxDelta;
+    }
+    WriteRecord(static_cast<uint32_t>(delta), static_cast<uint16_t>(std::min<uint32_t>(size, 65535)), 0, demandId);
+    m_lastNs = absTimeNs;
+    m_count++;
+}
+
+bool TraceWriter::Close() {
+    if (!m_out.is_open()) return false;
+    uint64_t records = (static_cast<uint64_t>(m_out.tellp()) - kHeaderSize) / kRecordSize;
+    uint64_t span = m_lastNs - m_baseNs;
+    uint32_t recordSize = kRecordSize;
+    char header[kHeaderSize];
+    std::memcpy(header, kMagic, 8);
+    std::memcpy(header + 8, &kVersion, 4);
+    std::memcpy(header + 12, &recordSize, 4);
+    std::memcpy(header + 16, &records, 8);
+    std::memcpy(header + 24, &m_baseNs, 8);
+    std::memcpy(header + 32, &span, 8);
+    m_out.seekp(0);
+    m_out.write(header, kHeaderSize);
+    bool ok = m_out.good();
+    m_out.close();
+    return ok;
+}
+
+// ==================== 读取 ====================
+
+TraceReader::~TraceReader() {
+    Close();
+}
+
+void TraceReader::Close() {
+    if (m_data) munmap(const_cast<unsigned char*>(m_data), m_length);
+    m_data = nullptr;
+    m_length = 0;
+}
+
+bool TraceReader::Open(const std::string& file) {
+    Close();
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "❌ 无法打开轨迹文件: " << file << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kHeaderSize) {
+        std::cerr << "❌ 轨迹文件过短: " << file << std::endl;
+        close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "❌ 无法映射轨迹文件: " << file << std::endl;
+        return false;
+    }
+    m_data = static_cast<const unsigned char*>(p);
+    m_length = st.st_size;
+    madvise(p, m_length, MADV_SEQUENTIAL);
+
+    uint32_t version, recordSize;
+    uint64_t records;
+    std::memcpy(&version, m_data + 8, 4);
+    std::memcpy(&recordSize, m_data + 12, 4);
+    std::memcpy(&records, m_data + 16, 8);
+    std::memcpy(&m_baseNs, m_data + 24, 8);
+    std::memcpy(&m_spanNs, m_data + 32, 8);
+    if (std::memcmp(m_data, kMagic, 8) != 0 || version != kVersion || recordSize != kRecordSize ||
+        kHeaderSize + records * kRecordSize > m_length) {
+        std::cerr << "❌ 轨迹文件格式无效: " << file << std::endl;
+        Close();
+        return false;
+    }
+    m_count = records;
+    m_index = 0;
+    m_timeNs = 0;
+    m_released = 0;
+    return true;
+}
+
+bool TraceReader::Next(TraceEvent& ev) {
+    while (m_index < m_count) {
+        size_t offset = kHeaderSize + m_index * kRecordSize;
+        const unsigned char* rec = m_data + offset;
+        uint32_t delta;
+        uint16_t size, flags;
+        std::memcpy(&delta, rec, 4);
+        std::memcpy(&size, rec + 4, 2);
+        std::memcpy(&flags, rec + 6, 2);
+        m_timeNs += delta;
+        m_index++;
+
+        // 页对齐地丢弃已读部分，常驻内存不随文件大小增长
+        if (offset - m_released >= kReleaseChunk) {
+            size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            size_t upTo = offset / page * page;
+            madvise(const_cast<unsigned char*>(m_data) + m_released, upTo - m_released, MADV_DONTNEED);
+            m_released = upTo;
+        }
+        if (flags & TRACE_FLAG_GAP) continue;
+
+        ev.timeNs = m_timeNs;
+        ev.size = size;
+        std::memcpy(&ev.demandId, rec + 8, 4);
+        return true;
+    }
+    return false;
+}
+
+// ==================== 转换 ====================
+
+uint64_t ConvertCsvTrace(const std::string& csvFile, const std::string& traceFile) {
+    std::ifstream in(csvFile);
+    if (!in.is_open()) {
+        std::cerr << "❌ 无法打开 CSV 轨迹: " << csvFile << std::endl;
+        return 0;
+    }
+    TraceWriter writer;
+    if (!writer.Open(traceFile)) return 0;
+    std::string line, tok;
+    uint64_t skipped = 0;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        std::stringstream ss(line);
+        double ts;
+        unsigned long size, demand;
+        try {
+            std::getline(ss, tok, ','); ts = std::stod(tok);
+            std::getline(ss, tok, ','); size = std::stoul(tok);
+            std::getline(ss, tok, ','); demand = std::stoul(tok);
+        } catch (...) { skipped++; continue; }
+        if (ts < 0) { skipped++; continue; }
+        writer.Add(static_cast<uint64_t>(std::llround(ts * 1e9)), size, static_cast<uint32_t>(demand));
+    }
+    uint64_t reordered = writer.Reordered();
+    uint64_t count = writer.Count();
+    if (!writer.Close()) return 0;
+    std::cout << "📦 CSV -> 轨迹: " << count << " 条记录";
+    if (skipped) std::cout << "，跳过 " << skipped << " 行";
+    if (reordered) std::cout << "，" << reordered << " 条乱序记录按上一条时刻写入";
+    std::cout << std::endl;
+    return count;
+}
+
+static std::string FormatIpv4(uint32_t addr) {
+    std::ostringstream os;
+    os << (addr >> 24) << "." << ((addr >> 16) & 0xff) << "." << ((addr >> 8) & 0xff) << "." << (addr & 0xff);
+    return os.str();
+}
+
+static bool ParseIpv4(const std::string& s, uint32_t& addr) {
+    unsigned a, b, c, d;
+    char tail;
+    if (std::sscanf(s.c_str(), "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4) return false;
+    if (a > 255 || b > 255 || c > 255 || d > 255) return false;
+    addr = (a << 24) | (b << 16) | (c << 8) | d;
+    return true;
+}
+
+static uint32_t ReadU32(const unsigned char* p, bool swap) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return swap ? __builtin_bswap32(v) : v;
+}
+
+uint64_t ConvertPcapTrace(const std::string& pcapFile, const std::string& traceFile,
+                          const std::string& flowMapFile) {
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> flows;
+    uint32_t nextId = 0;
+    if (!flowMapFile.empty()) {
+        std::ifstream map(flowMapFile);
+        if (!map.is_open()) {
+            std::cerr << "❌ 无法打开流映射文件: " << flowMapFile << std::endl;
+            return 0;
+        }
+        std::string line, src, dst, id;
+        std::getline(map, line);
+        while (std::getline(map, line)) {
+            std::stringstream ss(line);
+            std::getline(ss, src, ',');
+            std::getline(ss, dst, ',');
+            std::getline(ss, id, ',');
+            uint32_t s, d;
+            if (!ParseIpv4(src, s) || !ParseIpv4(dst, d)) continue;
+            try {
+                uint32_t demand = static_cast<uint32_t>(std::stoul(id));
+                flows[{s, d}] = demand;
+                nextId = std::max(nextId, demand + 1);
+            } catch (...) { continue; }
+        }
+    }
+
+    std::ifstream in(pcapFile, std::ios::binary);
+    unsigned char global[24];
+    if (!in.is_open() || !in.read(reinterpret_cast<char*>(global), 24)) {
+        std::cerr << "❌ 无法读取 pcap 文件: " << pcapFile << std::endl;
+        return 0;
+    }
+    uint32_t magic;
+    std::memcpy(&magic, global, 4);
+    bool swap, nanos;
+    if (magic == 0xa1b2c3d4) { swap = false; nanos = false; }
+    else if (magic == 0xd4c3b2a1) { swap = true; nanos = false; }
+    else if (magic == 0xa1b23c4d) { swap = false; nanos = true; }
+    else if (magic == 0x4d3cb2a1) { swap = true; nanos = true; }
+    else {
+        std::cerr << "❌ 不是 libpcap 文件 (pcapng 需先用 editcap -F pcap 转换): " << pcapFile << std::endl;
+        return 0;
+    }
+    // 链路层头长度：Ethernet / Linux cooked / 裸 IP
+    uint32_t linkType = ReadU32(global + 20, swap);
+    size_t linkHeader;
+    if (linkType == 1) linkHeader = 14;
+    else if (linkType == 113) linkHeader = 16;
+    else if (linkType == 101 || linkType == 228) linkHeader = 0;
+    else {
+        std::cerr << "❌ 不支持的 pcap 链路类型: " << linkType << std::endl;
+        return 0;
+    }
+
+    TraceWriter writer;
+    if (!writer.Open(traceFile)) return 0;
+    std::vector<unsigned char> buf;
+    unsigned char rh[16];
+    uint64_t nonIpv4 = 0;
+    while (in.read(reinterpret_cast<char*>(rh), 16)) {
+        uint64_t sec = ReadU32(rh, swap), frac = ReadU32(rh + 4, swap);
+        uint32_t inclLen = ReadU32(rh + 8, swap);
+        buf.resize(inclLen);
+        if (!in.read(reinterpret_cast<char*>(buf.data()), inclLen)) break;
+
+        size_t ip = linkHeader;
+        if (linkType == 1) {
+            if (inclLen < 14) { nonIpv4++; continue; }
+            uint16_t etherType = (buf[12] << 8) | buf[13];
+            if (etherType == 0x8100 && inclLen >= 18) {
+                etherType = (buf[16] << 8) | buf[17];
+                ip += 4;
+            }
+            if (etherType != 0x0800) { nonIpv4++; continue; }
+        } else if (linkType == 113) {
+            if (inclLen < 16 || ((buf[14] << 8) | buf[15]) != 0x0800) { nonIpv4++; continue; }
+        }
+        if (inclLen < ip + 20 || (buf[ip] >> 4) != 4) { nonIpv4++; continue; }
+
+        uint32_t size = (buf[ip + 2] << 8) | buf[ip + 3];
+        uint32_t src = (uint32_t(buf[ip + 12]) << 24) | (buf[ip + 13] << 16) | (buf[ip + 14] << 8) | buf[ip + 15];
+        uint32_t dst = (uint32_t(buf[ip + 16]) << 24) | (buf[ip + 17] << 16) | (buf[ip + 18] << 8) | buf[ip + 19];
+        auto it = flows.find({src, dst});
+        if (it == flows.end()) it = flows.emplace(std::make_pair(src, dst), nextId++).first;
+        writer.Add(sec * 1000000000ull + (nanos ? frac : frac * 1000), size, it->second);
+    }
+    uint64_t reordered = writer.Reordered();
+    uint64_t count = writer.Count();
+    if (!writer.Close()) return 0;
+
+    std::ofstream map(traceFile + ".flows.csv");
+    map << "src_ip,dst_ip,demand_id\n";
+    for (const auto& [key, id] : flows) map << FormatIpv4(key.first) << "," << FormatIpv4(key.second) << "," << id << "\n";
+
+    std::cout << "📦 pcap -> 轨迹: " << count << " 条记录，" << flows.size() << " 个地址对";
+    if (nonIpv4) std::cout << "，跳过 " << nonIpv4 << " 个非 IPv4 分组";
+    if (reordered) std::cout << "，" << reordered << " 条乱序记录按上一条时刻写入";
+    std::cout << std::endl;
+    return count;
+}
@@ -0,0 +1,84 @@
+#ifndef STARLINK_TRACE_H
+#define STARLINK_TRACE_H
+
+// starlink-trace.h - 分组到达轨迹的紧凑二进制格式
+// 用于按真实地面站抓包回放流量 (starlink-sim --trafficTrace)，代替 OnOff 指数分布。
+// 文件 = 40 字节文件头 + 定长 12 字节记录，小端：
+//   文件头: "SLTRACE1" | u32 版本 | u32 记录长度 | u64 记录数 (含填充) | u64 首记录绝对时刻 (ns)
+//           | u64 首末记录时间跨度 (ns)
+//   记录:   u32 与上一条的时间差 (ns) | u16 IP 分组长度 | u16 标志 | u32 demandId
+// 时间差超过 u32 范围时插入带 TRACE_FLAG_GAP 标志的空记录。读取端 mmap 整个文件顺序
+// 扫描，已读过的部分定期 MADV_DONTNEED，十亿级记录也只占用常数内存。
+// 转换器流式地从 CSV (timestamp_s,size_bytes,demand_id) 或 libpcap 文件生成轨迹。
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+static const uint32_t TRACE_FLAG_GAP = 1;
+
+struct TraceEvent {
+    uint64_t timeNs = 0;        // 相对首记录的时刻
+    uint32_t size = 0;          // IP 分组长度 (字节)
+    uint32_t demandId = 0;
+};
+
+class TraceWriter {
+public:
+    ~TraceWriter();
+
+    bool Open(const std::string& file);
+    // 时刻为绝对时间 (ns)；早于上一条的记录按上一条的时刻写入并计入 Reordered
+    void Add(uint64_t absTimeNs, uint32_t size, uint32_t demandId);
+    // 回填文件头中的记录数和时间跨度
+    bool Close();
+
+    uint64_t Count() const { return m_count; }
+    uint64_t Reordered() const { return m_reordered; }
+
+private:
+    void WriteRecord(uint32_t deltaNs, uint16_t size, uint16_t flags, uint32_t demandId);
+
+    std::ofstream m_out;
+    uint64_t m_count = 0;
+    uint64_t m_reordered = 0;
+    uint64_t m_baseNs = 0;
+    uint64_t m_lastNs = 0;
+};
+
+class TraceReader {
+public:
+    TraceReader() = default;
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+    ~TraceReader();
+
+    bool Open(const std::string& file);
+    void Close();
+
+    // 取下一条分组记录 (跳过时间差填充记录)，读完返回 false
+    bool Next(TraceEvent& ev);
+
+    uint64_t Count() const { return m_count; }
+    uint64_t BaseTimeNs() const { return m_baseNs; }
+    uint64_t SpanNs() const { return m_spanNs; }
+
+private:
+    const unsigned char* m_data = nullptr;
+    size_t m_length = 0;
+    uint64_t m_count = 0;
+    uint64_t m_baseNs = 0;
+    uint64_t m_spanNs = 0;
+    uint64_t m_index = 0;
+    uint64_t m_timeNs = 0;
+    size_t m_released = 0;      // 已 MADV_DONTNEED 的字节数
+};
+
+// 返回写入的分组记录数，出错时为 0
+uint64_t ConvertCsvTrace(const std::string& csvFile, const std::string& traceFile);
+// 按 (源 IP, 目的 IP) 分配 demandId：flowMapFile (src_ip,dst_ip,demand_id) 中没有的地址对
+// 按首次出现顺序从映射文件的最大 id + 1 开始编号，并把完整映射写入 traceFile + ".flows.csv"
+uint64_t ConvertPcapTrace(const std::string& pcapFile, const std::string& traceFile,
+                          const std::string& flowMapFile);
+
+#endif // STARLINK_TRACE_H
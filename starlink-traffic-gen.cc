@@ -0,0 +1,301 @@
+#include "starlink-traffic-gen.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+
+bool ParseTrafficModel(const std::string& name, TrafficModel& model) {
+    if (name == "uniform") model = TrafficModel::Uniform;
+    else if (name == "gravity") model = TrafficModel::Gravity;
+    else if (name == "hotspot") model = TrafficModel::Hotspot;
+    else if (name == "gateway") model = TrafficModel::Gateway;
+    else return false;
+    return true;
+}
+
+bool ParseFlowSizeDist(const std::string& name, FlowSizeDist& dist) {
+    if (name == "fixed") dist = FlowSizeDist::Fixed;
+    else if (name == "pareto") dist = FlowSizeDist::Pareto;
+    else if (name == "lognormal") dist = FlowSizeDist::Lognormal;
+    else return false;
+    return true;
+}
+
+// ==================== 别名表 ====================
+
+AliasTable::AliasTable(const std::vector<double>& weights) {
+    size_t n = weights.size();
+    double total = 0;
+    for (double w : weights) total += std::max(w, 0.0);
+    if (n == 0 || total <= 0) return;
+
+    m_prob.resize(n);
+    m_alias.resize(n);
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small, large;
+    for (size_t i = 0; i < n; ++i) {
+        scaled[i] = std::max(weights[i], 0.0) * n / total;
+        (scaled[i] < 1 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back(), l = large.back();
+        small.pop_back();
+        m_prob[s] = scaled[s];
+        m_alias[s] = l;
+        scaled[l] -= 1 - scaled[s];
+        if (scaled[l] < 1) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // 剩余项的概率在浮点误差内为 1
+    for (uint32_t i : large) { m_prob[i] = 1; m_alias[i] = i; }
+    for (uint32_t i : small) { m_prob[i] = 1; m_alias[i] = i; }
+}
+
+uint32_t AliasTable::Sample(std::mt19937_64& rng) const {
+    std::uniform_int_distribution<uint32_t> column(0, static_cast<uint32_t>(m_prob.size() - 1));
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    uint32_t i = column(rng);
+    return coin(rng) < m_prob[i] ? i : m_alias[i];
+}
+
+// ==================== 节点选择 ====================
+
+static bool ResolveNodeNames(const std::string& names, std::vector<uint32_t>& ids) {
+    std::unordered_map<std::string, uint32_t> byName;
+    for (const auto& [id, name] : g_nodeIdToName) byName[name] = id;
+    std::stringstream ss(names);
+    std::string name;
+    while (std::getline(ss, name, ',')) {
+        name = Trim(name);
+        if (name.empty()) continue;
+        auto it = byName.find(name);
+        if (it == byName.end()) {
+            std::cerr << "❌ 未知节点: " << name << std::endl;
+            return false;
+        }
+        ids.push_back(it->second);
+    }
+    return true;
+}
+
+// 指定了名称时解析名称，否则从有链路的节点中随机选 count 个
+static bool PickNodes(const std::string& names, uint32_t count, const std::vector<uint32_t>& nodes,
+                      std::mt19937_64& rng, std::vector<uint32_t>& picked) {
+    picked.clear();
+    if (!names.empty()) return ResolveNodeNames(names, picked) && !picked.empty();
+    picked = nodes;
+    std::shuffle(picked.begin(), picked.end(), rng);
+    picked.resize(std::min<size_t>(std::max<uint32_t>(count, 1), picked.size()));
+    return true;
+}
+
+bool LoadPopulationWeights(const std::string& populationFile, const std::string& positionFile,
+                           std::vector<double>& weights) {
+    std::unordered_map<std::string, uint32_t> byName;
+    for (const auto& [id, name] : g_nodeIdToName) byName[name] = id;
+
+    std::ifstream pos(positionFile);
+    if (!pos.is_open()) {
+        std::cerr << "❌ 无法打开节点位置文件: " << positionFile << std::endl;
+        return false;
+    }
+    std::vector<uint32_t> ids;
+    std::vector<double> ux, uy, uz;
+    std::string line;
+    std::getline(pos, line);
+    while (std::getline(pos, line)) {
+        std::stringstream ss(line);
+        std::string name, tok;
+        double v[3];
+        std::getline(ss, name, ',');
+        auto it = byName.find(Trim(name));
+        if (it == byName.end()) continue;
+        try {
+            for (double& c : v) { std::getline(ss, tok, ','); c = std::stod(Trim(tok)); }
+        } catch (...) { continue; }
+        double r = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        if (r <= 0) continue;
+        ids.push_back(it->second);
+        ux.push_back(v[0] / r);
+        uy.push_back(v[1] / r);
+        uz.push_back(v[2] / r);
+    }
+    if (ids.empty()) {
+        std::cerr << "❌ 位置文件中没有拓扑内的节点: " << positionFile << std::endl;
+        return false;
+    }
+
+    std::ifstream grid(populationFile);
+    if (!grid.is_open()) {
+        std::cerr << "❌ 无法打开人口栅格文件: " << populationFile << std::endl;
+        return false;
+    }
+    weights.assign(g_numNodes, 0);
+    const double deg = M_PI / 180.0;
+    uint64_t cells = 0;
+    std::getline(grid, line);
+    while (std::getline(grid, line)) {
+        std::stringstream ss(line);
+        std::string tok;
+        double lat, lon, population;
+        try {
+            std::getline(ss, tok, ','); lat = std::stod(Trim(tok)) * deg;
+            std::getline(ss, tok, ','); lon = std::stod(Trim(tok)) * deg;
+            std::getline(ss, tok, ','); population = std::stod(Trim(tok));
+        } catch (...) { continue; }
+        if (population <= 0) continue;
+        double cx = std::cos(lat) * std::cos(lon), cy = std::cos(lat) * std::sin(lon), cz = std::sin(lat);
+        // 星下点方向与栅格方向夹角最小的节点
+        size_t best = 0;
+        double bestDot = -2;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            double dot = ux[i] * cx + uy[i] * cy + uz[i] * cz;
+            if (dot > bestDot) { bestDot = dot; best = i; }
+        }
+        weights[ids[best]] += population;
+        cells++;
+    }
+    std::cout << "👥 人口栅格: " << cells << " 个单元分配到 " << ids.size() << " 个节点\n";
+    return cells > 0;
+}
+
+// ==================== 需求生成 ====================
+
+uint64_t GenerateDemands(const TrafficGenParams& params, const std::function<void(const TrafficDemand&)>& sink) {
+    if (params.numDemands == 0 && params.arrivalRate <= 0) {
+        std::cerr << "❌ 需要指定需求数或到达率" << std::endl;
+        return 0;
+    }
+    if (params.sizeDist == FlowSizeDist::Pareto && params.paretoShape <= 1) {
+        std::cerr << "❌ Pareto 形状参数必须大于 1" << std::endl;
+        return 0;
+    }
+    if (params.rateMinMbps <= 0 || params.rateMaxMbps < params.rateMinMbps || params.meanSizeMB <= 0 ||
+        params.dutyCycle <= 0) {
+        std::cerr << "❌ 速率 / 流大小 / 占空比参数无效" << std::endl;
+        return 0;
+    }
+
+    std::vector<uint32_t> nodes;
+    for (uint32_t n = 0; n < g_numNodes; ++n) {
+        if (!g_adjList[n].empty()) nodes.push_back(n);
+    }
+    if (nodes.size() < 2) {
+        std::cerr << "❌ 有链路的节点不足 2 个" << std::endl;
+        return 0;
+    }
+    std::mt19937_64 rng(params.seed);
+    std::uniform_int_distribution<size_t> anyNode(0, nodes.size() - 1);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    // 模型相关的准备
+    std::vector<uint32_t> massNodes;
+    std::vector<double> masses;
+    std::vector<uint32_t> special;          // 热点或网关
+    std::vector<uint32_t> gatewayOf;        // 每个节点跳数最近的网关
+    std::vector<uint32_t> gatewaySources;
+    const uint32_t none = std::numeric_limits<uint32_t>::max();
+    if (params.model == TrafficModel::Gravity) {
+        std::vector<double> weights;
+        if (!LoadPopulationWeights(params.populationFile, params.positionFile, weights)) return 0;
+        for (uint32_t n : nodes) {
+            if (weights[n] > 0) { massNodes.push_back(n); masses.push_back(weights[n]); }
+        }
+        if (massNodes.size() < 2) {
+            std::cerr << "❌ 人口质量大于 0 的节点不足 2 个" << std::endl;
+            return 0;
+        }
+    } else if (params.model == TrafficModel::Hotspot) {
+        if (!PickNodes(params.hotspots, params.numHotspots, nodes, rng, special)) return 0;
+    } else if (params.model == TrafficModel::Gateway) {
+        if (!PickNodes(params.gateways, params.numGateways, nodes, rng, special)) return 0;
+        // 多源 BFS
+        gatewayOf.assign(g_numNodes, none);
+        std::deque<uint32_t> queue;
+        for (uint32_t g : special) { gatewayOf[g] = g; queue.push_back(g); }
+        while (!queue.empty()) {
+            uint32_t u = queue.front();
+            queue.pop_front();
+            for (const auto& [v, w] : g_adjList[u]) {
+                if (gatewayOf[v] == none) { gatewayOf[v] = gatewayOf[u]; queue.push_back(v); }
+            }
+        }
+        for (uint32_t n : nodes) {
+            if (gatewayOf[n] != none && gatewayOf[n] != n) gatewaySources.push_back(n);
+        }
+        if (gatewaySources.empty()) {
+            std::cerr << "❌ 没有能到达网关的源节点" << std::endl;
+            return 0;
+        }
+    }
+    AliasTable gravity(masses);
+
+    auto pickPair = [&](uint32_t& src, uint32_t& dst) {
+        switch (params.model) {
+        case TrafficModel::Gravity:
+            src = massNodes[gravity.Sample(rng)];
+            do { dst = massNodes[gravity.Sample(rng)]; } while (dst == src);
+            return;
+        case TrafficModel::Hotspot:
+            if (uniform(rng) < params.hotspotFraction) {
+                dst = special[std::uniform_int_distribution<size_t>(0, special.size() - 1)(rng)];
+                do { src = nodes[anyNode(rng)]; } while (src == dst);
+                return;
+            }
+            break;
+        case TrafficModel::Gateway:
+            src = gatewaySources[std::uniform_int_distribution<size_t>(0, gatewaySources.size() - 1)(rng)];
+            dst = gatewayOf[src];
+            return;
+        case TrafficModel::Uniform:
+            break;
+        }
+        src = nodes[anyNode(rng)];
+        do { dst = nodes[anyNode(rng)]; } while (dst == src);
+    };
+
+    double meanBytes = params.meanSizeMB * 1e6;
+    double paretoScale = meanBytes * (params.paretoShape - 1) / params.paretoShape;
+    std::lognormal_distribution<double> lognormal(
+        std::log(meanBytes) - params.lognormalSigma * params.lognormalSigma / 2, params.lognormalSigma);
+    auto sampleSize = [&]() {
+        switch (params.sizeDist) {
+        case FlowSizeDist::Pareto:
+            return paretoScale / std::pow(1.0 - uniform(rng), 1.0 / params.paretoShape);
+        case FlowSizeDist::Lognormal:
+            return lognormal(rng);
+        case FlowSizeDist::Fixed:
+            break;
+        }
+        return meanBytes;
+    };
+    std::uniform_real_distribution<double> rate(params.rateMinMbps, params.rateMaxMbps);
+    std::exponential_distribution<double> interArrival(params.arrivalRate > 0 ? params.arrivalRate : 1.0);
+
+    uint64_t count = 0;
+    double t = params.startTime;
+    while (params.numDemands == 0 || count < params.numDemands) {
+        if (params.arrivalRate > 0) t += interArrival(rng);
+        if (t >= params.endTime) break;
+
+        TrafficDemand d;
+        pickPair(d.srcId, d.dstId);
+        d.demandId = static_cast<uint32_t>(count);
+        d.srcNode = GetNodeName(d.srcId);
+        d.dstNode = GetNodeName(d.dstId);
+        d.dataRateMbps = rate(rng);
+        d.startTimeSec = t;
+        double seconds = sampleSize() * 8.0 / (d.dataRateMbps * 1e6 * params.dutyCycle);
+        d.durationSec = std::min(seconds, params.endTime - t);
+        sink(d);
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,75 @@
+#ifndef STARLINK_TRAFFIC_GEN_H
+#define STARLINK_TRAFFIC_GEN_H
+
+// starlink-traffic-gen.h - 大规模流量需求生成
+// 在 starlink-sim 内部按模型直接生成需求并逐条交给回调 (通常追加到 g_demands)，
+// 不经过 traffic_demands.csv，可生成百万级需求：
+//   uniform - 源、目的在有链路的节点中均匀选取
+//   gravity - 源、目的分别按节点"质量"抽样 (T_ij ∝ m_i m_j)，质量来自地面人口栅格：
+//             每个栅格单元的人口计入星下点方向最近的节点
+//   hotspot - 以 hotspotFraction 的概率目的为热点节点之一，其余同 uniform
+//   gateway - 目的为距源跳数最近的网关
+// 流大小服从 Pareto / 对数正态 / 固定分布，到达为泊松过程 (arrivalRate 为 0 时全部在
+// start 时刻开始)。持续时间 = 流大小 / (速率 x OnOff 占空比)，使期望发送量等于流大小。
+
+#include "starlink-topology.h"
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+enum class TrafficModel { Uniform, Gravity, Hotspot, Gateway };
+enum class FlowSizeDist { Fixed, Pareto, Lognormal };
+
+// "uniform" / "gravity" / "hotspot" / "gateway"
+bool ParseTrafficModel(const std::string& name, TrafficModel& model);
+// "fixed" / "pareto" / "lognormal"
+bool ParseFlowSizeDist(const std::string& name, FlowSizeDist& dist);
+
+struct TrafficGenParams {
+    TrafficModel model = TrafficModel::Uniform;
+    uint64_t numDemands = 0;            // 0 表示按到达过程生成到 endTime 为止
+    double arrivalRate = 0;             // 每秒新到达的流数，0 表示全部在 startTime 开始
+    double startTime = 1.0;
+    double endTime = 10.0;              // 仿真结束时刻，流的持续时间截断到此
+    FlowSizeDist sizeDist = FlowSizeDist::Pareto;
+    double meanSizeMB = 10.0;
+    double paretoShape = 1.2;           // 必须 > 1 (均值有限)
+    double lognormalSigma = 1.5;
+    double rateMinMbps = 20.0;
+    double rateMaxMbps = 50.0;
+    double dutyCycle = 1.0;             // OnOff 的 on / (on + off)
+    uint64_t seed = 1;
+
+    std::string populationFile;         // gravity：lat,lon,population
+    std::string positionFile;           // gravity：name,x_km,y_km,z_km (地固系)
+    std::string hotspots;               // 逗号分隔的节点名，空则随机选 numHotspots 个
+    uint32_t numHotspots = 4;
+    double hotspotFraction = 0.8;
+    std::string gateways;               // 逗号分隔的节点名，空则随机选 numGateways 个
+    uint32_t numGateways = 4;
+};
+
+// Walker / Vose 别名表：O(n) 构造，O(1) 按权重抽样
+class AliasTable {
+public:
+    explicit AliasTable(const std::vector<double>& weights);
+
+    uint32_t Sample(std::mt19937_64& rng) const;
+    bool Empty() const { return m_prob.empty(); }
+
+private:
+    std::vector<double> m_prob;
+    std::vector<uint32_t> m_alias;
+};
+
+// 把人口栅格分配到最近的节点，返回按节点编号的质量 (没有位置的节点为 0)
+bool LoadPopulationWeights(const std::string& populationFile, const std::string& positionFile,
+                           std::vector<double>& weights);
+
+// 需要先 LoadLinks；按开始时刻递增的顺序调用 sink，返回生成的需求数 (出错时为 0)
+uint64_t GenerateDemands(const TrafficGenParams& params, const std::function<void(const TrafficDemand&)>& sink);
+
+#endif // STARLINK_TRAFFIC_GEN_H
@@ -0,0 +1,193 @@
+#include "starlink-validate.h"
+#include "starlink-topology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <unordered_map>
+
+bool ParseValidationMode(const std::string& name, ValidationMode& mode) {
+    if (name == "off") mode = ValidationMode::Off;
+    else if (name == "flag") mode = ValidationMode::Flag;
+    else if (name == "drop") mode = ValidationMode::Drop;
+    else return false;
+    return true;
+}
+
+// ==================== 并查集 ====================
+
+UnionFind::UnionFind(uint32_t n) : m_parent(n), m_size(n, 1) {
+    std::iota(m_parent.begin(), m_parent.end(), 0);
+}
+
+uint32_t UnionFind::Find(uint32_t x) {
+    // 路径减半
+    while (m_parent[x] != x) {
+        m_parent[x] = m_parent[m_parent[x]];
+        x = m_parent[x];
+    }
+    return x;
+}
+
+bool UnionFind::Union(uint32_t a, uint32_t b) {
+    a = Find(a);
+    b = Find(b);
+    if (a == b) return false;
+    if (m_size[a] < m_size[b]) std::swap(a, b);
+    m_parent[b] = a;
+    m_size[a] += m_size[b];
+    return true;
+}
+
+// ==================== 检查 ====================
+
+uint32_t ValidationReport::CountDemands(DemandIssue issue) const {
+    return static_cast<uint32_t>(std::count(demandIssues.begin(), demandIssues.end(), issue));
+}
+
+ValidationReport ValidateTopology(ValidationMode mode) {
+    ValidationReport report;
+    const uint32_t none = std::numeric_limits<uint32_t>::max();
+
+    // 链路：自环、重复 (无向端点对)、编号与名称的对应关系
+    std::set<std::pair<uint32_t, uint32_t>> seenPairs;
+    std::vector<bool> keep(g_links.size(), true);
+    std::unordered_map<uint32_t, std::string> idName;
+    std::unordered_map<std::string, uint32_t> nameId;
+    std::set<uint32_t> conflictIds;
+    std::set<std::string> conflictNames;
+    auto checkName = [&](uint32_t id, const std::string& name) {
+        auto it = idName.emplace(id, name).first;
+        if (it->second != name) conflictIds.insert(id);
+        auto jt = nameId.emplace(name, id).first;
+        if (jt->second != id) conflictNames.insert(name);
+    };
+    for (size_t i = 0; i < g_links.size(); ++i) {
+        const LinkParam& lp = g_links[i];
+        checkName(lp.srcId, lp.srcName);
+        checkName(lp.dstId, lp.dstName);
+        if (lp.srcId == lp.dstId) {
+            report.selfLoops++;
+            keep[i] = false;
+            continue;
+        }
+        if (!seenPairs.insert(std::minmax(lp.srcId, lp.dstId)).second) {
+            report.duplicateLinks++;
+            keep[i] = false;
+        }
+    }
+    report.idNameConflicts = static_cast<uint32_t>(conflictIds.size() + conflictNames.size());
+
+    if (mode == ValidationMode::Drop && (report.selfLoops || report.duplicateLinks)) {
+        decltype(g_links) kept(GetSetupResource());
+        kept.reserve(g_links.size());
+        for (size_t i = 0; i < g_links.size(); ++i) {
+            if (keep[i]) kept.push_back(g_links[i]);
+        }
+        report.droppedLinks = static_cast<uint32_t>(g_links.size() - kept.size());
+        g_links.swap(kept);
+        BuildAdjacency();
+    }
+
+    // 连通分量 (自环不影响连通性，重复链路不影响分量)
+    UnionFind uf(g_numNodes);
+    std::vector<bool> linked(g_numNodes, false);
+    for (const auto& lp : g_links) {
+        linked[lp.srcId] = linked[lp.dstId] = true;
+        uf.Union(lp.srcId, lp.dstId);
+    }
+    std::unordered_map<uint32_t, uint32_t> rootSize;
+    for (uint32_t n = 0; n < g_numNodes; ++n) {
+        if (!linked[n]) {
+            report.unusedIds++;
+            continue;
+        }
+        report.linkedNodes++;
+        rootSize[uf.Find(n)]++;
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> roots(rootSize.begin(), rootSize.end());
+    std::sort(roots.begin(), roots.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    std::unordered_map<uint32_t, uint32_t> rootToComponent;
+    for (uint32_t c = 0; c < roots.size(); ++c) {
+        rootToComponent[roots[c].first] = c;
+        report.componentSizes.push_back(roots[c].second);
+    }
+    report.component.assign(g_numNodes, none);
+    for (uint32_t n = 0; n < g_numNodes; ++n) {
+        if (linked[n]) report.component[n] = rootToComponent[uf.Find(n)];
+    }
+
+    // 需求
+    report.demandIssues.assign(g_demands.size(), DemandIssue::None);
+    for (size_t k = 0; k < g_demands.size(); ++k) {
+        const TrafficDemand& d = g_demands[k];
+        DemandIssue& issue = report.demandIssues[k];
+        if (d.srcId >= g_numNodes || d.dstId >= g_numNodes || !linked[d.srcId] || !linked[d.dstId]) {
+            issue = DemandIssue::UnknownNode;
+        } else if (d.srcId == d.dstId) {
+            issue = DemandIssue::SameNode;
+        } else if (report.component[d.srcId] != report.component[d.dstId]) {
+            issue = DemandIssue::Unreachable;
+        } else if (idName[d.srcId] != d.srcNode || idName[d.dstId] != d.dstNode) {
+            issue = DemandIssue::NameMismatch;
+        }
+    }
+
+    if (mode == ValidationMode::Drop) {
+        decltype(g_demands) kept(GetSetupResource());
+        kept.reserve(g_demands.size());
+        for (size_t k = 0; k < g_demands.size(); ++k) {
+            DemandIssue issue = report.demandIssues[k];
+            if (issue == DemandIssue::None || issue == DemandIssue::NameMismatch) kept.push_back(g_demands[k]);
+        }
+        report.droppedDemands = static_cast<uint32_t>(g_demands.size() - kept.size());
+        g_demands.swap(kept);
+    }
+    return report;
+}
+
+// ==================== 输出 ====================
+
+void PrintValidationReport(std::ostream& os, const ValidationReport& report) {
+    os << "🔍 拓扑检查: " << report.linkedNodes << " 个节点, " << report.componentSizes.size() << " 个连通分量";
+    if (!report.componentSizes.empty()) {
+        os << " (最大 " << report.componentSizes.front();
+        if (report.componentSizes.size() > 1) os << ", 最小 " << report.componentSizes.back();
+        os << ")";
+    }
+    os << "\n";
+    if (report.unusedIds) os << "   未使用的节点编号: " << report.unusedIds << "\n";
+    if (report.selfLoops) os << "⚠️ 自环链路: " << report.selfLoops << "\n";
+    if (report.duplicateLinks) os << "⚠️ 重复链路: " << report.duplicateLinks << "\n";
+    if (report.idNameConflicts) os << "⚠️ 编号与名称不一致: " << report.idNameConflicts << "\n";
+    if (uint32_t n = report.CountDemands(DemandIssue::UnknownNode)) os << "⚠️ 端点不在拓扑中的需求: " << n << "\n";
+    if (uint32_t n = report.CountDemands(DemandIssue::SameNode)) os << "⚠️ 源与目的相同的需求: " << n << "\n";
+    if (uint32_t n = report.CountDemands(DemandIssue::Unreachable)) os << "⚠️ 不可达需求: " << n << "\n";
+    if (uint32_t n = report.CountDemands(DemandIssue::NameMismatch)) os << "⚠️ 端点名称不一致的需求: " << n << "\n";
+    if (report.droppedLinks || report.droppedDemands) {
+        os << "   已删除 " << report.droppedLinks << " 条链路, " << report.droppedDemands << " 条需求\n";
+    }
+}
+
+bool WriteComponentSummary(const std::string& file, const ValidationReport& report) {
+    std::ofstream f(file);
+    if (!f.is_open()) {
+        std::cerr << "❌ 无法创建输出文件: " << file << std::endl;
+        return false;
+    }
+    std::vector<uint32_t> example(report.componentSizes.size(), std::numeric_limits<uint32_t>::max());
+    for (uint32_t n = 0; n < report.component.size(); ++n) {
+        uint32_t c = report.component[n];
+        if (c < example.size() && example[c] == std::numeric_limits<uint32_t>::max()) example[c] = n;
+    }
+    f << "ComponentId,Size,ExampleNode\n";
+    for (size_t c = 0; c < report.componentSizes.size(); ++c) {
+        f << c << "," << report.componentSizes[c] << "," << GetNodeName(example[c]) << "\n";
+    }
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef STARLINK_VALIDATE_H
+#define STARLINK_VALIDATE_H
+
+// starlink-validate.h - 加载后的拓扑与需求检查
+// 在路由和创建任何 ns-3 对象之前运行：并查集求连通分量，检查自环、重复链路、
+// 节点编号与名称是否一一对应，以及每条需求的端点是否存在、是否可达。
+// flag 模式只报告 (路由阶段据分量编号跳过不可达需求)；drop 模式同时删除
+// 自环、重复链路 (保留第一条) 和无效 / 不可达的需求。
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class ValidationMode { Off, Flag, Drop };
+
+// "off" / "flag" / "drop"，无法识别时返回 false
+bool ParseValidationMode(const std::string& name, ValidationMode& mode);
+
+// ==================== 并查集 ====================
+
+class UnionFind {
+public:
+    explicit UnionFind(uint32_t n);
+
+    uint32_t Find(uint32_t x);
+    // 已在同一集合时返回 false
+    bool Union(uint32_t a, uint32_t b);
+    uint32_t Size(uint32_t x) { return m_size[Find(x)]; }
+
+private:
+    std::vector<uint32_t> m_parent;
+    std::vector<uint32_t> m_size;
+};
+
+// ==================== 检查结果 ====================
+
+enum class DemandIssue : uint8_t {
+    None,
+    UnknownNode,    // 端点编号不在拓扑中
+    SameNode,       // 源与目的相同
+    Unreachable,    // 端点在不同连通分量
+    NameMismatch    // 名称与链路表中该编号的名称不一致 (只告警，不删除)
+};
+
+struct ValidationReport {
+    uint32_t selfLoops = 0;
+    uint32_t duplicateLinks = 0;
+    uint32_t idNameConflicts = 0;   // 同一编号对应多个名称，或同一名称对应多个编号
+    uint32_t linkedNodes = 0;       // 至少出现在一条链路中的节点
+    uint32_t unusedIds = 0;         // 0..g_numNodes-1 中没有链路的编号
+    uint32_t droppedLinks = 0;
+    uint32_t droppedDemands = 0;
+
+    // 各节点所在分量的编号 (按分量大小降序编号，没有链路的节点为 UINT32_MAX)
+    std::vector<uint32_t> component;
+    std::vector<uint32_t> componentSizes;   // 降序
+    // 与检查时的 g_demands 一一对应 (drop 模式删除需求之前)
+    std::vector<DemandIssue> demandIssues;
+
+    uint32_t CountDemands(DemandIssue issue) const;
+};
+
+// 检查 g_links / g_demands；drop 模式下就地删除并重建邻接表
+ValidationReport ValidateTopology(ValidationMode mode);
+
+void PrintValidationReport(std::ostream& os, const ValidationReport& report);
+// 每个连通分量一行：ComponentId,Size,ExampleNode
+bool WriteComponentSummary(const std::string& file, const ValidationReport& report);
+
+#endif // STARLINK_VALIDATE_H
@@ -0,0 +1,297 @@
+#include "starlink-zstream.h"
+
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+// ==================== zlib (运行时加载) ====================
+// 不把 libz 加进构建依赖：首次使用时 dlopen，找不到时调用方退回未压缩输出
+
+namespace {
+
+typedef unsigned long (*CompressBoundFn)(unsigned long);
+typedef int (*Compress2Fn)(unsigned char*, unsigned long*, const unsigned char*, unsigned long, int);
+typedef unsigned long (*Crc32Fn)(unsigned long, const unsigned char*, unsigned int);
+
+struct Zlib {
+    CompressBoundFn compressBound = nullptr;
+    Compress2Fn compress2 = nullptr;
+    Crc32Fn crc32 = nullptr;
+
+    Zlib() {
+        void* lib = dlopen("libz.so.1", RTLD_NOW);
+        if (!lib) lib = dlopen("libz.so", RTLD_NOW);
+        if (!lib) return;
+        compressBound = reinterpret_cast<CompressBoundFn>(dlsym(lib, "compressBound"));
+        compress2 = reinterpret_cast<Compress2Fn>(dlsym(lib, "compress2"));
+        crc32 = reinterpret_cast<Crc32Fn>(dlsym(lib, "crc32"));
+        if (!compressBound || !compress2 || !crc32) compress2 = nullptr;
+    }
+};
+
+const Zlib& GetZlib() {
+    static Zlib zlib;
+    return zlib;
+}
+
+void PutLe32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+} // namespace
+
+bool ZlibAvailable() {
+    return GetZlib().compress2 != nullptr;
+}
+
+bool ZlibCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out, int level) {
+    const Zlib& zlib = GetZlib();
+    if (!zlib.compress2) return false;
+    unsigned long bound = zlib.compressBound(size);
+    out.resize(bound);
+    if (zlib.compress2(out.data(), &bound, data, size, level) != 0) return false;
+    out.resize(bound);
+    return true;
+}
+
+// zlib 格式 = 2 字节头 + deflate 数据 + 4 字节 adler32；换成 gzip 头和 crc32/长度尾即为 gzip 成员
+bool GzipCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out, int level) {
+    std::vector<uint8_t> z;
+    if (!ZlibCompress(data, size, z, level) || z.size() < 6) return false;
+    static const uint8_t kHeader[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3};
+    out.assign(kHeader, kHeader + 10);
+    out.insert(out.end(), z.begin() + 2, z.end() - 4);
+    uint32_t crc = 0;
+    for (size_t done = 0; done < size;) {
+        unsigned int chunk = static_cast<unsigned int>(std::min<size_t>(size - done, 1u << 30));
+        crc = static_cast<uint32_t>(GetZlib().crc32(crc, data + done, chunk));
+        done += chunk;
+    }
+    PutLe32(out, crc);
+    PutLe32(out, static_cast<uint32_t>(size));
+    return true;
+}
+
+// ==================== 后台写线程 ====================
+
+namespace {
+
+class BlockWriter {
+public:
+    // 进程退出时可能仍有全局输出流未关闭，写线程不随静态析构结束
+    static BlockWriter& Get() {
+        static BlockWriter* writer = new BlockWriter();
+        return *writer;
+    }
+
+    void Submit(uint32_t& pending, std::function<void()>&& job, size_t bytes) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_queuedBytes < kMaxQueuedBytes; });
+        m_queuedBytes += bytes;
+        pending++;
+        m_jobs.push_back({&pending, std::move(job), bytes});
+        m_work.notify_one();
+    }
+
+    void Wait(const uint32_t& pending) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [&pending] { return pending == 0; });
+    }
+
+private:
+    struct Job {
+        uint32_t* pending;
+        std::function<void()> run;
+        size_t bytes;
+    };
+
+    static const size_t kMaxQueuedBytes = 64u << 20;
+
+    BlockWriter() : m_thread(&BlockWriter::Run, this) {}
+
+    void Run() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_work.wait(lock, [this] { return !m_jobs.empty(); });
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+            job.run();
+            job.run = nullptr;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queuedBytes -= job.bytes;
+            (*job.pending)--;
+            m_done.notify_all();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_work;
+    std::condition_variable m_done;
+    std::deque<Job> m_jobs;
+    size_t m_queuedBytes = 0;
+    std::thread m_thread;       // 最后初始化，线程启动时其余成员已就绪
+};
+
+} // namespace
+
+WriteQueue::~WriteQueue() {
+    Wait();
+}
+
+void WriteQueue::Submit(std::function<void()> job, size_t bytes) {
+    m_used = true;
+    BlockWriter::Get().Submit(m_pending, std::move(job), bytes);
+}
+
+void WriteQueue::Wait() {
+    if (m_used) BlockWriter::Get().Wait(m_pending);
+}
+
+struct GzipSink {
+    std::ofstream out;
+    std::ofstream index;
+    uint64_t rawOffset = 0;     // 仿真线程维护
+    uint64_t gzOffset = 0;      // 以下由后台线程维护
+    uint32_t blocks = 0;
+    bool ok = true;
+    std::vector<uint8_t> packed;
+    WriteQueue queue;           // 最后声明、最先析构：析构时先等完所有块
+
+    void WriteBlock(const std::string& data, double timeSec, uint64_t offset) {
+        const uint8_t* raw = reinterpret_cast<const uint8_t*>(data.data());
+        if (!GzipCompress(raw, data.size(), packed)) {
+            ok = false;
+            return;
+        }
+        out.write(reinterpret_cast<const char*>(packed.data()), packed.size());
+        index << blocks << "," << timeSec << "," << offset << "," << data.size() << "," << gzOffset << ","
+              << packed.size() << "\n";
+        gzOffset += packed.size();
+        blocks++;
+    }
+};
+
+// ==================== gzip 缓冲区 ====================
+
+GzipBuf::~GzipBuf() {
+    Close();
+}
+
+bool GzipBuf::Open(const std::string& file, uint32_t blockBytes) {
+    Close();
+    std::unique_ptr<GzipSink> sink(new GzipSink());
+    sink->out.open(file.c_str(), std::ios::binary | std::ios::trunc);
+    sink->index.open((file + ".idx").c_str());
+    if (!sink->out.is_open() || !sink->index.is_open()) {
+        std::cerr << "❌ 无法创建压缩输出: " << file << std::endl;
+        return false;
+    }
+    sink->index << "Block,Time_s,RawOffset,RawBytes,GzOffset,GzBytes\n" << std::setprecision(9);
+    m_sink = std::move(sink);
+    m_buf.resize(std::max<uint32_t>(blockBytes, 4096));
+    setp(m_buf.data(), m_buf.data() + m_buf.size());
+    m_mark = m_blockTime = 0;
+    return true;
+}
+
+void GzipBuf::MarkTime(double timeSec) {
+    m_mark = timeSec;
+    if (pptr() == pbase()) m_blockTime = timeSec;
+}
+
+// 在最后一个换行处切块 (all 时整个缓冲区)，余下的半行移到缓冲区开头，保证每块都从
+// 行首开始；缓冲区里一个换行都没有时 (单行超过缓冲区) 扩大缓冲区而不拆行
+void GzipBuf::Cut(bool all) {
+    size_t used = pptr() - pbase();
+    size_t cut = used;
+    if (!all) {
+        const char* nl = static_cast<const char*>(memrchr(pbase(), '\n', used));
+        if (!nl) {
+            m_buf.resize(m_buf.size() * 2);
+            setp(m_buf.data(), m_buf.data() + m_buf.size());
+            pbump(static_cast<int>(used));
+            return;
+        }
+        cut = nl - pbase() + 1;
+    }
+    if (cut > 0) {
+        GzipSink* sink = m_sink.get();
+        std::string data(pbase(), cut);
+        double timeSec = m_blockTime;
+        uint64_t offset = sink->rawOffset;
+        sink->queue.Submit([sink, data = std::move(data), timeSec, offset] { sink->WriteBlock(data, timeSec, offset); },
+                           cut);
+        sink->rawOffset += cut;
+    }
+    std::memmove(m_buf.data(), m_buf.data() + cut, used - cut);
+    setp(m_buf.data(), m_buf.data() + m_buf.size());
+    pbump(static_cast<int>(used - cut));
+    m_blockTime = m_mark;
+}
+
+GzipBuf::int_type GzipBuf::overflow(int_type c) {
+    if (!m_sink) return traits_type::eof();
+    Cut(false);
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+bool GzipBuf::Close() {
+    if (!m_sink) return false;
+    Cut(true);
+    m_sink->queue.Wait();
+    bool ok = m_sink->ok && m_sink->out.good();
+    m_sink->out.close();
+    m_sink->index.close();
+    m_sink.reset();
+    m_buf.clear();
+    m_buf.shrink_to_fit();
+    setp(nullptr, nullptr);
+    return ok;
+}
+
+// ==================== 输出文件 ====================
+
+OutputFile::OutputFile() : std::ostream(nullptr) {}
+
+OutputFile::~OutputFile() {
+    Close();
+}
+
+bool OutputFile::Open(const std::string& file, bool compress, uint32_t blockBytes) {
+    Close();
+    clear();
+    m_compress = compress;
+    m_path = compress ? file + ".gz" : file;
+    if (compress) {
+        m_open = m_gzip.Open(m_path, blockBytes);
+        rdbuf(&m_gzip);
+    } else {
+        m_open = m_file.open(m_path.c_str(), std::ios::out | std::ios::trunc) != nullptr;
+        rdbuf(&m_file);
+    }
+    if (!m_open) setstate(std::ios::failbit);
+    return m_open;
+}
+
+bool OutputFile::Close() {
+    if (!m_open) return false;
+    m_open = false;
+    flush();
+    bool ok = m_compress ? m_gzip.Close() : m_file.close() != nullptr;
+    return ok && !bad();
+}
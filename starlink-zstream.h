@@ -0,0 +1,103 @@
+#ifndef STARLINK_ZSTREAM_H
+#define STARLINK_ZSTREAM_H
+
+// starlink-zstream.h - 分块 gzip 输出流
+// OutputFile 是 std::ostream，原有 << 写法不变。不压缩时就是普通文件；压缩时写入先进入
+// blockBytes 大小的缓冲区，满后在最后一个换行处切成一块 (单行超过缓冲区时缓冲区加倍，
+// 行不会跨块)，交给后台线程压缩成一个独立的 gzip 成员追加到 <file>.gz (多成员 gzip，
+// zcat / pandas 可直接读)。每块在 <file>.gz.idx 中登记一行：
+// Block,Time_s,RawOffset,RawBytes,GzOffset,GzBytes，Time_s 为块内第一行之前最近一次
+// MarkTime 的时刻，读取方可按时间定位块后从 GzOffset 开始解压 (starlink_stream.py)。
+// 仿真线程只做内存拷贝；压缩和写盘在一个共享的后台线程中完成，排队数据超过上限时
+// 才等待。后台线程在第一次打开压缩文件时创建，需在 fork 之后使用。
+// libz 在运行时加载，不是构建依赖。
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// ==================== zlib ====================
+
+bool ZlibAvailable();
+// zlib 格式 (compress2)；libz 不可用或压缩失败返回 false
+bool ZlibCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out, int level = 6);
+// 一个完整的 gzip 成员
+bool GzipCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out, int level = 6);
+
+// ==================== 后台写线程 ====================
+
+// 一个输出文件交给共享后台线程的写任务。所有文件的任务在同一个线程上按提交顺序执行，
+// 同一文件的块因此保持顺序；全部排队数据超过上限时 Submit 等待。
+// 线程在第一次 Submit 时创建，需在 fork 之后使用。
+class WriteQueue {
+public:
+    WriteQueue() = default;
+    WriteQueue(const WriteQueue&) = delete;
+    WriteQueue& operator=(const WriteQueue&) = delete;
+    ~WriteQueue();
+
+    // bytes 计入排队上限
+    void Submit(std::function<void()> job, size_t bytes);
+    // 等待本队列已提交的任务全部完成
+    void Wait();
+
+private:
+    uint32_t m_pending = 0;     // 受后台线程互斥量保护
+    bool m_used = false;        // 未提交过任务时不创建后台线程
+};
+
+// ==================== 输出流 ====================
+
+struct GzipSink;
+
+class GzipBuf : public std::streambuf {
+public:
+    ~GzipBuf() override;
+
+    bool Open(const std::string& file, uint32_t blockBytes);
+    bool Close();
+    void MarkTime(double timeSec);
+
+protected:
+    int_type overflow(int_type c) override;
+    int sync() override { return 0; }   // 只在块满或关闭时切块
+
+private:
+    void Cut(bool all);
+
+    std::unique_ptr<GzipSink> m_sink;
+    std::vector<char> m_buf;
+    double m_mark = 0;          // 最近一次 MarkTime
+    double m_blockTime = 0;     // 当前块的起始时刻
+};
+
+class OutputFile : public std::ostream {
+public:
+    OutputFile();
+    ~OutputFile() override;
+
+    // compress 时实际写 file + ".gz"
+    bool Open(const std::string& file, bool compress, uint32_t blockBytes = 1 << 20);
+    // 等待后台线程写完本文件的所有块
+    bool Close();
+    bool IsOpen() const { return m_open; }
+    const std::string& Path() const { return m_path; }
+
+    // 之后写入的行属于 timeSec (只用于块索引)
+    void MarkTime(double timeSec) {
+        if (m_compress) m_gzip.MarkTime(timeSec);
+    }
+
+private:
+    std::filebuf m_file;
+    GzipBuf m_gzip;
+    std::string m_path;
+    bool m_open = false;
+    bool m_compress = false;
+};
+
+#endif // STARLINK_ZSTREAM_H
@@ -0,0 +1,109 @@
+"""
+@Function :
+            列式二进制结果读取 (.slcol)
+            - 读取 starlink-sim --resultFormat columnar/both 写出的 flow_results / link_monitor /
+              link_stats / route_paths 的 .slcol 文件，格式见 starlink-columnar.h
+            - 数值列直接由字节构造 NumPy 数组，字符串列为字典编号数组 + 字典，不解析文本
+            - 压缩段用标准库 zlib 解压；可选转换为 pandas DataFrame
+"""
+
+import sys
+import zlib
+import struct
+
+import numpy as np
+
+MAGIC = b"SLCOL001"
+END_MAGIC = b"SLCOLEND"
+
+# 列类型编号 -> NumPy 类型 (字符串列存 uint32 字典编号)
+DTYPES = {0: np.dtype("<i8"), 1: np.dtype("<u8"), 2: np.dtype("<f8"), 3: np.dtype("<u4")}
+STRING = 3
+
+
+class ColumnarTable:
+    """一个 .slcol 文件：columns 为列名 -> 数组，strings 为字符串列的解码结果"""
+
+    def __init__(self, names: list, types: list, arrays: list, dictionary: np.ndarray):
+        self.names = names
+        self.types = dict(zip(names, types))
+        self.columns = dict(zip(names, arrays))
+        self.dictionary = dictionary
+
+    def __len__(self) -> int:
+        return len(next(iter(self.columns.values()))) if self.columns else 0
+
+    def __getitem__(self, name: str) -> np.ndarray:
+        """数值列返回原数组，字符串列返回解码后的对象数组"""
+        col = self.columns[name]
+        if self.types[name] == STRING:
+            return self.dictionary[col]
+        return col
+
+    def codes(self, name: str) -> np.ndarray:
+        """字符串列的字典编号 (同一文件内各列共用一个字典)"""
+        return self.columns[name]
+
+    def to_dataframe(self):
+        import pandas as pd
+        return pd.DataFrame({name: self[name] for name in self.names})
+
+
+def read_columnar(path: str) -> ColumnarTable:
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != MAGIC or data[-8:] != END_MAGIC:
+        raise ValueError(f"不是 .slcol 文件: {path}")
+
+    pos = 8
+    (ncols,) = struct.unpack_from("<I", data, pos)
+    pos += 4
+    names, types = [], []
+    for _ in range(ncols):
+        ctype, nlen = struct.unpack_from("<BH", data, pos)
+        pos += 3
+        names.append(data[pos:pos + nlen].decode("utf-8"))
+        types.append(ctype)
+        pos += nlen
+
+    nblocks, footer = struct.unpack_from("<IQ", data, len(data) - 20)
+    parts = [[] for _ in range(ncols)]
+    for _ in range(nblocks):
+        pos += 4    # 块行数，与各段长度一致
+        for c in range(ncols):
+            codec, raw_len, stored = struct.unpack_from("<BII", data, pos)
+            pos += 9
+            seg = data[pos:pos + stored]
+            pos += stored
+            if codec == 1:
+                seg = zlib.decompress(seg)
+            elif codec != 0:
+                raise ValueError(f"未知的段编码 {codec}: {path}")
+            if len(seg) != raw_len:
+                raise ValueError(f"段长度不符: {path}")
+            parts[c].append(np.frombuffer(seg, dtype=DTYPES[types[c]]))
+
+    pos = footer
+    (nstrings,) = struct.unpack_from("<I", data, pos)
+    pos += 4
+    strings = []
+    for _ in range(nstrings):
+        (slen,) = struct.unpack_from("<H", data, pos)
+        pos += 2
+        strings.append(data[pos:pos + slen].decode("utf-8"))
+        pos += slen
+    dictionary = np.array(strings, dtype=object)
+
+    arrays = [np.concatenate(p) if p else np.empty(0, dtype=DTYPES[t]) for p, t in zip(parts, types)]
+    return ColumnarTable(names, types, arrays, dictionary)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print("用法: python starlink_columnar.py <file.slcol>")
+        sys.exit(1)
+    table = read_columnar(sys.argv[1])
+    print(f"📊 {sys.argv[1]}: {len(table)} 行, {len(table.names)} 列, 字典 {len(table.dictionary)} 项")
+    for name in table.names:
+        col = table[name]
+        print(f"   {name:<24} {str(table.columns[name].dtype):<8} {col[:3]}")
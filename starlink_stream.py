@@ -0,0 +1,59 @@
+"""
+@Function :
+            分块 gzip 输出读取 (--compressOutput)
+            - starlink-sim 压缩输出为多成员 gzip (<file>.gz)，每个成员一块，块索引在 <file>.gz.idx
+            - 整个文件可直接 pd.read_csv / zcat；按时间读取时用索引跳到起始块，只解压其后的块
+"""
+
+import sys
+import zlib
+import bisect
+
+import pandas as pd
+
+
+def load_index(path: str) -> pd.DataFrame:
+    """块索引: Block,Time_s,RawOffset,RawBytes,GzOffset,GzBytes"""
+    return pd.read_csv(path + ".idx")
+
+
+def iter_lines_from(path: str, time_s: float, header: bool = True):
+    """从包含 time_s 之前最后一行的块开始逐行返回 (含表头行时先返回表头)，调用方按时间列过滤"""
+    index = load_index(path)
+    with open(path, "rb") as f:
+        if header and len(index) > 0:
+            first = zlib.decompressobj(16 + zlib.MAX_WBITS).decompress(f.read(int(index["GzBytes"].iloc[0])))
+            yield first.split(b"\n", 1)[0].decode("utf-8")
+        # Time_s 为块内第一行的时刻，同一时刻的行可能跨块，所以取严格小于 time_s 的最后一块
+        start = max(bisect.bisect_left(index["Time_s"].tolist(), time_s) - 1, 0)
+        skip_header = start == 0 and header
+        pending = b""
+        for _, row in index.iloc[start:].iterrows():
+            f.seek(int(row["GzOffset"]))
+            data = zlib.decompressobj(16 + zlib.MAX_WBITS).decompress(f.read(int(row["GzBytes"])))
+            lines = (pending + data).split(b"\n")
+            pending = lines.pop()
+            for line in lines:
+                if skip_header:
+                    skip_header = False
+                    continue
+                yield line.decode("utf-8")
+        if pending:
+            yield pending.decode("utf-8")
+
+
+def read_csv_from(path: str, time_s: float, time_column: str = "Time") -> pd.DataFrame:
+    """读取时间列不早于 time_s 的行"""
+    import io
+    text = "\n".join(iter_lines_from(path, time_s))
+    df = pd.read_csv(io.StringIO(text))
+    return df[df[time_column] >= time_s].reset_index(drop=True)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        print("用法: python starlink_stream.py <file.csv.gz> <time_s> [time_column]")
+        sys.exit(1)
+    df = read_csv_from(sys.argv[1], float(sys.argv[2]), sys.argv[3] if len(sys.argv) > 3 else "Time")
+    print(f"📊 {sys.argv[1]}: {len(df)} 行 (Time >= {sys.argv[2]})")
+    print(df.head())
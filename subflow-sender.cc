@@ -0,0 +1,86 @@
+#include "subflow-sender.h"
+
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(SubFlowSender);
+
+TypeId SubFlowSender::GetTypeId() {
+    static TypeId tid =
+        TypeId("ns3::SubFlowSender")
+            .SetParent<Application>()
+            .SetGroupName("Applications")
+            .AddConstructor<SubFlowSender>()
+            .AddAttribute("Remote", "The address of the destination", AddressValue(),
+                          MakeAddressAccessor(&SubFlowSender::m_peer), MakeAddressChecker())
+            .AddAttribute("DataRate", "The data rate in on state", DataRateValue(DataRate("500kb/s")),
+                          MakeDataRateAccessor(&SubFlowSender::m_rate), MakeDataRateChecker())
+            .AddAttribute("PacketSize", "The size of packets sent in on state", UintegerValue(512),
+                          MakeUintegerAccessor(&SubFlowSender::m_pktSize), MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("OnTime", "A RandomVariableStream used to pick the duration of the on state",
+                          StringValue("ns3::ConstantRandomVariable[Constant=1.0]"),
+                          MakePointerAccessor(&SubFlowSender::m_onTime), MakePointerChecker<RandomVariableStream>())
+            .AddAttribute("OffTime", "A RandomVariableStream used to pick the duration of the off state",
+                          StringValue("ns3::ConstantRandomVariable[Constant=0.0]"),
+                          MakePointerAccessor(&SubFlowSender::m_offTime), MakePointerChecker<RandomVariableStream>())
+            .AddTraceSource("Tx", "A packet is about to be handed to the socket",
+                            MakeTraceSourceAccessor(&SubFlowSender::m_txTrace), "ns3::Packet::TracedCallback");
+    return tid;
+}
+
+SubFlowSender::SubFlowSender() : m_pktSize(512) {}
+
+SubFlowSender::~SubFlowSender() = default;
+
+void SubFlowSender::DoDispose() {
+    Simulator::Cancel(m_sendEvent);
+    Simulator::Cancel(m_toggleEvent);
+    m_socket = nullptr;
+    Application::DoDispose();
+}
+
+void SubFlowSender::StartApplication() {
+    if (!m_socket) {
+        m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+        m_socket->Bind();
+        m_socket->Connect(m_peer);
+        m_socket->ShutdownRecv();
+    }
+    // 与 OnOff 一样先经过一个关闭期
+    StartOff();
+}
+
+void SubFlowSender::StopApplication() {
+    Simulator::Cancel(m_sendEvent);
+    Simulator::Cancel(m_toggleEvent);
+    if (m_socket) m_socket->Close();
+}
+
+void SubFlowSender::StartOn() {
+    m_toggleEvent = Simulator::Schedule(Seconds(m_onTime->GetValue()), &SubFlowSender::StartOff, this);
+    ScheduleNextTx();
+}
+
+void SubFlowSender::StartOff() {
+    Simulator::Cancel(m_sendEvent);
+    m_toggleEvent = Simulator::Schedule(Seconds(m_offTime->GetValue()), &SubFlowSender::StartOn, this);
+}
+
+void SubFlowSender::ScheduleNextTx() {
+    Time gap = Seconds(m_pktSize * 8.0 / static_cast<double>(m_rate.GetBitRate()));
+    m_sendEvent = Simulator::Schedule(gap, &SubFlowSender::SendPacket, this);
+}
+
+void SubFlowSender::SendPacket() {
+    Ptr<Packet> packet = Create<Packet>(m_pktSize);
+    m_txTrace(packet);
+    m_socket->Send(packet);
+    ScheduleNextTx();
+}
+
+} // namespace ns3
@@ -0,0 +1,55 @@
+#ifndef SUBFLOW_SENDER_H
+#define SUBFLOW_SENDER_H
+
+// subflow-sender.h - 合并需求的 UDP 开关源
+// 与 OnOffApplication 相同的开/关周期和恒定速率发送，区别在于 "Tx" 在交给 socket
+// 之前触发。UdpSocketImpl 发送的是分组副本，OnOff 在 Send 之后才触发 "Tx"，在那里
+// 添加的 SubFlowTag 到不了接收端；这里先触发再发送，标记随副本一起到达 (见 subflow-tag.h)。
+
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/socket.h"
+#include "ns3/traced-callback.h"
+
+#include <cstdint>
+
+namespace ns3 {
+
+class SubFlowSender : public Application {
+public:
+    static TypeId GetTypeId();
+
+    SubFlowSender();
+    ~SubFlowSender() override;
+
+protected:
+    void DoDispose() override;
+
+private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    void StartOn();
+    void StartOff();
+    void ScheduleNextTx();
+    void SendPacket();
+
+    Address m_peer;
+    DataRate m_rate;
+    uint32_t m_pktSize;
+    Ptr<RandomVariableStream> m_onTime;
+    Ptr<RandomVariableStream> m_offTime;
+    Ptr<Socket> m_socket;
+    EventId m_sendEvent;
+    EventId m_toggleEvent;
+    TracedCallback<Ptr<const Packet>> m_txTrace;
+};
+
+} // namespace ns3
+
+#endif // SUBFLOW_SENDER_H
@@ -0,0 +1,41 @@
+#include "subflow-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(SubFlowTag);
+
+TypeId SubFlowTag::GetTypeId() {
+    static TypeId tid = TypeId("ns3::SubFlowTag")
+        .SetParent<Tag>()
+        .SetGroupName("Network")
+        .AddConstructor<SubFlowTag>();
+    return tid;
+}
+
+TypeId SubFlowTag::GetInstanceTypeId() const {
+    return GetTypeId();
+}
+
+SubFlowTag::SubFlowTag() : m_demandIndex(0), m_txTime() {}
+
+SubFlowTag::SubFlowTag(uint32_t demandIndex, Time txTime) : m_demandIndex(demandIndex), m_txTime(txTime) {}
+
+uint32_t SubFlowTag::GetSerializedSize() const {
+    return 4 + 8;
+}
+
+void SubFlowTag::Serialize(TagBuffer buf) const {
+    buf.WriteU32(m_demandIndex);
+    buf.WriteU64(static_cast<uint64_t>(m_txTime.GetTimeStep()));
+}
+
+void SubFlowTag::Deserialize(TagBuffer buf) {
+    m_demandIndex = buf.ReadU32();
+    m_txTime = TimeStep(buf.ReadU64());
+}
+
+void SubFlowTag::Print(std::ostream& os) const {
+    os << "demand=" << m_demandIndex << " tx=" << m_txTime;
+}
+
+} // namespace ns3
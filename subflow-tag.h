@@ -0,0 +1,38 @@
+#ifndef SUBFLOW_TAG_H
+#define SUBFLOW_TAG_H
+
+// subflow-tag.h - 合并需求中的子流标记
+// 合并后的源 (subflow-sender.h) 在交给 socket 之前给每个分组打上所属原始需求的下标和发送时刻，
+// 接收端据此按原始需求统计收包数、字节数和时延 (见 starlink-aggregate.h)。
+
+#include "ns3/nstime.h"
+#include "ns3/tag.h"
+
+#include <cstdint>
+
+namespace ns3 {
+
+class SubFlowTag : public Tag {
+public:
+    static TypeId GetTypeId();
+    TypeId GetInstanceTypeId() const override;
+
+    SubFlowTag();
+    SubFlowTag(uint32_t demandIndex, Time txTime);
+
+    uint32_t GetSerializedSize() const override;
+    void Serialize(TagBuffer buf) const override;
+    void Deserialize(TagBuffer buf) override;
+    void Print(std::ostream& os) const override;
+
+    uint32_t GetDemandIndex() const { return m_demandIndex; }
+    Time GetTxTime() const { return m_txTime; }
+
+private:
+    uint32_t m_demandIndex;
+    Time m_txTime;
+};
+
+} // namespace ns3
+
+#endif // SUBFLOW_TAG_H
@@ -0,0 +1,122 @@
+"""
+@Function :
+            排队论代理模型与 ns-3 分组级结果对比
+            - 读取 starlink-sim --surrogate 输出的 surrogate_results.csv 和同一次运行的 flow_results.csv
+            - 按 DemandId 对齐，计算每条流时延 / 吞吐的相对误差和丢包率的绝对误差
+            - 需求合并 (--aggregateDemands) 时 flow_results 的 DemandId 为 "3;7;9"，
+              合并组的成员改用 demand_results.csv 中的逐需求结果
+            - 按路径最大链路负载 (MaxLinkLoad) 分档统计，误差都在容差内的档位可以只用代理模型
+
+用法:
+    python3 surrogate_report.py <输出目录>
+    python3 surrogate_report.py <输出目录> --tol 0.2 --loss-tol 0.02
+"""
+
+import os
+import sys
+import argparse
+
+import pandas as pd
+
+LOAD_BINS = [0.0, 0.3, 0.5, 0.7, 0.8, 0.9, 0.95, 1.0, float("inf")]
+
+
+def result_path(result_dir: str, name: str) -> str:
+    """name.csv 或 --compressOutput 写出的 name.csv.gz"""
+    path = os.path.join(result_dir, name + ".csv")
+    if not os.path.exists(path) and os.path.exists(path + ".gz"):
+        path += ".gz"
+    return path
+
+
+def read_result(result_dir: str, name: str) -> pd.DataFrame:
+    return pd.read_csv(result_path(result_dir, name))
+
+
+def per_demand_results(result_dir: str) -> pd.DataFrame:
+    """flow_results 中合并组的 "3;7;9" 拆成每个 DemandId 一行，成员优先取 demand_results 的逐需求结果"""
+    sim = read_result(result_dir, "flow_results").dropna(subset=["DemandId"])
+    sim["DemandId"] = sim["DemandId"].map(lambda v: [int(float(x)) for x in str(v).split(";")])
+    sim = sim.explode("DemandId")
+    sim["DemandId"] = sim["DemandId"].astype(int)
+    if os.path.exists(result_path(result_dir, "demand_results")):
+        members = read_result(result_dir, "demand_results")
+        sim = pd.concat([sim[~sim["DemandId"].isin(members["DemandId"])], members], ignore_index=True)
+    return sim
+
+
+def load_comparison(result_dir: str) -> pd.DataFrame:
+    """按 DemandId 合并代理模型和 ns-3 结果"""
+    sur = read_result(result_dir, "surrogate_results")
+    sim = per_demand_results(result_dir)
+    df = sur.merge(sim[["DemandId", "Throughput_Mbps", "MeanDelay_ms", "PacketLossRate"]],
+                   on="DemandId", suffixes=("_sur", "_sim"))
+
+    def rel_err(a, b):
+        return (a - b).abs() / b.abs().where(b.abs() > 1e-9)
+
+    df["DelayRelErr"] = rel_err(df["MeanDelay_ms_sur"], df["MeanDelay_ms_sim"])
+    df["ThroughputRelErr"] = rel_err(df["Throughput_Mbps_sur"], df["Throughput_Mbps_sim"])
+    df["LossAbsErr"] = (df["PacketLossRate_sur"] - df["PacketLossRate_sim"]).abs()
+    df["LoadBand"] = pd.cut(df["MaxLinkLoad"], LOAD_BINS, right=False)
+    return df
+
+
+def summarize_by_load(df: pd.DataFrame, tol: float, loss_tol: float) -> pd.DataFrame:
+    """每个负载档位的误差中位数 / 90 分位，以及是否可以跳过仿真"""
+    g = df.groupby("LoadBand", observed=True)
+    summary = pd.DataFrame({
+        "Flows": g.size(),
+        "DelayErr_p50": g["DelayRelErr"].median(),
+        "DelayErr_p90": g["DelayRelErr"].quantile(0.9),
+        "ThroughputErr_p50": g["ThroughputRelErr"].median(),
+        "ThroughputErr_p90": g["ThroughputRelErr"].quantile(0.9),
+        "LossErr_p90": g["LossAbsErr"].quantile(0.9),
+    })
+    summary["SkipSimulation"] = ((summary["DelayErr_p90"] <= tol)
+                                 & (summary["ThroughputErr_p90"] <= tol)
+                                 & (summary["LossErr_p90"] <= loss_tol))
+    return summary
+
+
+def print_surrogate_report(df: pd.DataFrame, summary: pd.DataFrame, tol: float, loss_tol: float):
+    print("\n" + "=" * 96)
+    print(f"📐 代理模型 vs ns-3 ({len(df)} 条流, 相对误差容差 {tol:.0%}, 丢包绝对误差容差 {loss_tol:.3f})")
+    print("=" * 96)
+    print(f"{'负载档位':<16}{'流数':>6}{'时延p50':>10}{'时延p90':>10}{'吞吐p50':>10}{'吞吐p90':>10}"
+          f"{'丢包p90':>10}{'可跳过':>10}")
+    for band, row in summary.iterrows():
+        print(f"{str(band):<16}{int(row['Flows']):>6}{row['DelayErr_p50']:>10.1%}{row['DelayErr_p90']:>10.1%}"
+              f"{row['ThroughputErr_p50']:>10.1%}{row['ThroughputErr_p90']:>10.1%}{row['LossErr_p90']:>10.4f}"
+              f"{'✅' if row['SkipSimulation'] else '❌':>10}")
+    print("-" * 96)
+    skip = summary[summary["SkipSimulation"]]
+    if skip.empty:
+        print("⚠️ 没有满足容差的负载档位，需要分组级仿真")
+    else:
+        covered = int(skip["Flows"].sum())
+        print(f"路径最大负载落在 ✅ 档位的流可只用代理模型: {covered}/{len(df)} 条")
+    print("=" * 96)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="排队论代理模型精度报告")
+    parser.add_argument("result_dir", nargs="?", default="ns3_results")
+    parser.add_argument("--tol", type=float, default=0.1, help="时延 / 吞吐相对误差容差")
+    parser.add_argument("--loss-tol", type=float, default=0.01, help="丢包率绝对误差容差")
+    args = parser.parse_args()
+
+    try:
+        df = load_comparison(args.result_dir)
+    except (OSError, KeyError) as e:
+        print(f"❌ 读取失败: {e}")
+        sys.exit(1)
+    if df.empty:
+        print("❌ 代理模型与 ns-3 结果没有共同的 DemandId")
+        sys.exit(1)
+
+    summary = summarize_by_load(df, args.tol, args.loss_tol)
+    out_file = os.path.join(args.result_dir, "surrogate_comparison.csv")
+    df.drop(columns=["LoadBand"]).to_csv(out_file, index=False)
+    print_surrogate_report(df, summary, args.tol, args.loss_tol)
+    print(f"💾 已保存: {out_file}")